@@ -0,0 +1,80 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Total number of allocations, atomic as any thread can allocate
+static std::atomic<unsigned long long> s_allocationCount(0);
+
+// Returns the number of allocations made since the application started
+unsigned long long AllocationCounter::GetCount()
+{
+	return s_allocationCount.load(std::memory_order_relaxed);
+}
+
+// Counts the allocation and takes memory from malloc, shared by every replacement below
+static void* CountedAllocate(std::size_t size)
+{
+	s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+	// malloc can return null for a zero sized request
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+// Replacement global allocation functions
+
+void* operator new(std::size_t size)
+{
+	void* memory = CountedAllocate(size);
+	if (!memory)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+	void* memory = CountedAllocate(size);
+	if (!memory)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+	std::free(memory);
+}
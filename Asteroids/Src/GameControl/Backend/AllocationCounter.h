@@ -0,0 +1,13 @@
+#pragma once
+
+/* namespace AllocationCounter
+ * Brief:
+ *	Counts every call to the global operator new. The replacement operators are
+ *	defined in AllocationCounter.cpp, reading the count before and after a block
+ *	of code shows how many heap allocations it made.
+*/
+namespace AllocationCounter
+{
+	// Returns the number of allocations made since the application started
+	unsigned long long GetCount();
+}
@@ -0,0 +1,113 @@
+#include "BroadPhaseSelector.h"
+#include <cmath>
+
+/* Constructor
+ * Params:
+ *	<unsigned int> nCandidates	-	number of candidates, at most MAX_CANDIDATES
+ */
+BroadPhaseSelector::BroadPhaseSelector(unsigned int nCandidates)
+	:
+_nCandidates(nCandidates < MAX_CANDIDATES ? nCandidates : MAX_CANDIDATES)
+{
+	for (unsigned int i = 0; i < MAX_CANDIDATES; i++)
+	{
+		this->_cost[i] = INFINITY;
+		this->_excluded[i] = false;
+	}
+}
+
+/* void Reset
+* Brief:
+*	Forgets every sampled cost and starts sampling from the first candidate
+* Params:
+*	<unsigned int> current	-	candidate running now, kept unless another is cheaper
+*/
+void BroadPhaseSelector::Reset(unsigned int current)
+{
+	for (unsigned int i = 0; i < MAX_CANDIDATES; i++)
+		this->_cost[i] = INFINITY;
+
+	this->_settled = current;
+	this->_isSampling = true;
+	this->_current = 0;
+	this->_frame = 0;
+	this->_sampleTotal = 0.0f;
+
+	// start on the first candidate that can be sampled
+	if (this->_excluded[this->_current])
+		this->NextSample();
+}
+
+/* unsigned int Update
+* Brief:
+*	Records the cost of the frame just run on the current candidate and
+*	returns the candidate to run next frame
+* Params:
+*	<float> frameCost	-	seconds the broad and narrow phase took this frame
+* Returns:
+*	<unsigned int>	-	candidate for the next frame
+*/
+unsigned int BroadPhaseSelector::Update(float frameCost)
+{
+	this->_frame++;
+
+	if (this->_isSampling)
+	{
+		// the first frames after a switch pay for rebuilding the structure, don't count them
+		if (this->_frame > WARMUP_FRAMES)
+			this->_sampleTotal += frameCost;
+
+		if (this->_frame >= WARMUP_FRAMES + SAMPLE_FRAMES)
+		{
+			this->_cost[this->_current] = this->_sampleTotal / SAMPLE_FRAMES;
+			this->NextSample();
+		}
+
+		return this->_current;
+	}
+
+	// settled, keep a running average to spot the scene changing
+	this->_settledCost += (frameCost - this->_settledCost) * AVERAGE_WEIGHT;
+
+	if (this->_frame >= RESAMPLE_INTERVAL || this->_settledCost > this->_cost[this->_settled] * DRIFT_LIMIT)
+		this->Reset(this->_settled);
+
+	return this->_current;
+}
+
+// Moves sampling on to the next candidate that isn't excluded, or settles once they're all done
+void BroadPhaseSelector::NextSample()
+{
+	this->_frame = 0;
+	this->_sampleTotal = 0.0f;
+
+	do
+	{
+		this->_current++;
+	} while (this->_current < this->_nCandidates && this->_excluded[this->_current]);
+
+	if (this->_current >= this->_nCandidates)
+		this->Settle();
+}
+
+// Picks the settled candidate from the sampled costs
+void BroadPhaseSelector::Settle()
+{
+	unsigned int cheapest = this->_settled;
+	for (unsigned int i = 0; i < this->_nCandidates; i++)
+	{
+		if (this->_cost[i] < this->_cost[cheapest])
+			cheapest = i;
+	}
+
+	// only move away from the settled candidate if the saving is worth it,
+	// a settled candidate that wasn't sampled (excluded) always loses
+	if (!(this->_cost[cheapest] < this->_cost[this->_settled] * (1.0f - HYSTERESIS)))
+		cheapest = this->_settled;
+
+	this->_settled = cheapest;
+	this->_current = cheapest;
+	this->_settledCost = this->_cost[cheapest];
+	this->_isSampling = false;
+	this->_frame = 0;
+}
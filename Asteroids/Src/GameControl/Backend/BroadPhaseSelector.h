@@ -0,0 +1,89 @@
+#pragma once
+
+/* class BroadPhaseSelector
+ *	Picks the cheapest of a small set of broad phase candidates from measured
+ *	frame costs. Every candidate is run for a few frames in turn (sampling),
+ *	the cheapest is then kept (settled) until the resample interval is up or
+ *	its cost has drifted well away from what was sampled. A new candidate is
+ *	only taken over the settled one if it's cheaper by the hysteresis margin,
+ *	so two candidates with similar costs don't swap back and forth.
+ *	Candidates are plain indices, the owner maps them to broad phase modes.
+*/
+class BroadPhaseSelector
+{
+	// Public interface
+public:
+	/* Constructor
+	 * Params:
+	 *	<unsigned int> nCandidates	-	number of candidates, at most MAX_CANDIDATES
+	 */
+	BroadPhaseSelector(unsigned int nCandidates);
+
+	/* void Reset
+	* Brief:
+	*	Forgets every sampled cost and starts sampling from the first candidate
+	* Params:
+	*	<unsigned int> current	-	candidate running now, kept unless another is cheaper
+	*/
+	void Reset(unsigned int current);
+
+	/* unsigned int Update
+	* Brief:
+	*	Records the cost of the frame just run on the current candidate and
+	*	returns the candidate to run next frame
+	* Params:
+	*	<float> frameCost	-	seconds the broad and narrow phase took this frame
+	* Returns:
+	*	<unsigned int>	-	candidate for the next frame
+	*/
+	unsigned int Update(float frameCost);
+
+	/* void SetExcluded
+	* Brief:
+	*	Excluded candidates are skipped while sampling. Used for candidates that
+	*	are known to be far too slow to be worth a few frames of stutter.
+	* Params:
+	*	<unsigned int>	candidate	-	candidate to change
+	*	<bool>			excluded	-	should it be skipped
+	*/
+	void SetExcluded(unsigned int candidate, bool excluded) { this->_excluded[candidate] = excluded; }
+
+	// Returns the candidate currently being run
+	unsigned int GetCurrent() const { return this->_current; }
+
+	// Returns true while the candidates are being sampled
+	bool IsSampling() const { return this->_isSampling; }
+
+	// Private methods
+private:
+	// Moves sampling on to the next candidate that isn't excluded, or settles once they're all done
+	void NextSample();
+
+	// Picks the settled candidate from the sampled costs
+	void Settle();
+
+	// Public constants
+public:
+	static constexpr unsigned int MAX_CANDIDATES = 4;
+
+	// Members
+private:
+	unsigned int _nCandidates;					// number of candidates to choose between
+	unsigned int _current = 0;					// candidate currently running
+	unsigned int _settled = 0;					// candidate kept once sampling has finished
+	bool _isSampling = false;					// true while each candidate is being tried in turn
+	unsigned int _frame = 0;					// frames run in the current sample / since settling
+
+	float _sampleTotal = 0.0f;					// cost summed over the measured frames of the current sample
+	float _cost[MAX_CANDIDATES];				// average frame cost of each candidate when last sampled
+	bool _excluded[MAX_CANDIDATES];				// candidates to skip when sampling
+	float _settledCost = 0.0f;					// running average cost of the settled candidate
+
+	// constants
+	static constexpr unsigned int WARMUP_FRAMES = 1;		// frames ignored after switching while the structure is rebuilt
+	static constexpr unsigned int SAMPLE_FRAMES = 5;		// frames measured for each candidate
+	static constexpr unsigned int RESAMPLE_INTERVAL = 300;	// frames between samples once settled
+	static constexpr float HYSTERESIS = 0.15f;				// fraction cheaper a candidate must be to replace the settled one
+	static constexpr float DRIFT_LIMIT = 1.5f;				// resample early if the settled cost grows by this factor
+	static constexpr float AVERAGE_WEIGHT = 0.1f;			// weight of each new frame in the running average
+};
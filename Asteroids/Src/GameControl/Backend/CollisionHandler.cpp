@@ -5,30 +5,83 @@
 #include "../../GameObjects/Other/Bullet.h"
 #include "SpatialPartitioning/QuadTree.h"
 #include "SpatialPartitioning/UniformGrid.h"
+#include "SpatialPartitioning/SweepAndPrune.h"
+#include "SpatialPartitioning/DynamicAABBTree.h"
+#include "SpatialPartitioning/LinearQuadTree.h"
+#include "SpatialPartitioning/RayCast.h"
+#include "SpatialPartitioning/SpatialHashGrid.h"
+#include "SpatialPartitioning/HierarchicalGrid.h"
+#include "AllocationCounter.h"
+#include "SimdSAT.h"
+#include "SatTest.h"
+#include "WorkerPool.h"
+#include "GJK.h"
+#include "WrapGhosts.h"
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <algorithm>
 #include "../../Global/ApplicationDefines.h"
 
-CollisionHandler::CollisionHandler(UniformGrid& grid, std::vector<Asteroid*>& asteroidContainer, std::vector<Bullet*>& bulletContainer, Player& player, QuadTree* quadtree)
+CollisionHandler::CollisionHandler(UniformGrid& grid, std::vector<Asteroid*>& asteroidContainer, std::vector<Bullet*>& bulletContainer, Player& player, QuadTree* quadtree,
+	SweepAndPrune& sweepAndPrune, DynamicAABBTree& aabbTree, LinearQuadTree& linearQuadTree, SpatialHashGrid& spatialHashGrid,
+	HierarchicalGrid& hierarchicalGrid)
 	:	// Assign references to game objects
 	_grid(grid),
 	_asteroids(asteroidContainer),
 	_bullets(bulletContainer),
 	_player(player),
-	_quadTree(quadtree){}
+	_quadTree(quadtree),
+	_sweepAndPrune(sweepAndPrune),
+	_aabbTree(aabbTree),
+	_linearQuadTree(linearQuadTree),
+	_spatialHashGrid(spatialHashGrid),
+	_hierarchicalGrid(hierarchicalGrid)
+{
+	// build the response table, pairs are ordered so the lower category is first
+	const int playerCategory = static_cast<int>(CollisionCategory::PLAYER);
+	const int asteroidCategory = static_cast<int>(CollisionCategory::ASTEROID);
+	const int bulletCategory = static_cast<int>(CollisionCategory::BULLET);
+
+	this->_responses[playerCategory][asteroidCategory] = &CollisionHandler::RespondPlayerAsteroid;
+	this->_responses[asteroidCategory][asteroidCategory] = &CollisionHandler::RespondAsteroidAsteroid;
+	this->_responses[asteroidCategory][bulletCategory] = &CollisionHandler::RespondAsteroidBullet;
+}
 
-CollisionHandler::~CollisionHandler(){}
+// Broad phases the selector picks between, brute force must stay first as it's the one that can be excluded
+const BroadCollisionMode CollisionHandler::AUTO_CANDIDATES[CollisionHandler::AUTO_CANDIDATE_COUNT] =
+{
+	BroadCollisionMode::BRUTE_FORCE,
+	BroadCollisionMode::UNIFORM_GRID,
+	BroadCollisionMode::QUADTREE
+};
+
+CollisionHandler::~CollisionHandler()
+{
+	delete this->_workerPool;
+}
 
 CollisionPhaseData CollisionHandler::HandleCollision()
 {
 	// output data
 	CollisionPhaseData output = CollisionPhaseData();
-	this->_nCollisionsThisFrame = 0;
+	sf::Clock collisionClock;
 	this->_nCollisionTestsThisFrame = 0;
+	this->_nCacheSkipsThisFrame = 0;
+
+	// last frame's separated pairs become the ones read from the cache
+	this->_pairCache.BeginFrame();
+
+	// Clear the scratch containers, they keep their memory from previous frames
+	this->_scratch.Reset();
+
+	// Count allocations made during the collision pass, should stay at zero once the containers have grown
+	unsigned long long allocationsAtStart = AllocationCounter::GetCount();
 
 	// Setup output variable to handle player collision stuff
 	bool isPlayerColliding = false;
 
 	// Decide what narrow phase detection to use
-	std::function<bool(WireframeSprite&, WireframeSprite&)> narrowCollisionMode;
+	NarrowPhaseTest narrowCollisionMode = nullptr;
 
 	switch (this->_narrowCollisionMode)
 	{
@@ -38,6 +91,15 @@ CollisionPhaseData CollisionHandler::HandleCollision()
 	case NarrowCollisionMode::SEPERATED_AXIS_THEOREM:
 		narrowCollisionMode = TestSATCollision;
 		break;
+	case NarrowCollisionMode::SEPERATED_AXIS_THEOREM_SIMD:
+		narrowCollisionMode = SimdSAT::TestCollision;
+		break;
+	case NarrowCollisionMode::SEPERATED_AXIS_THEOREM_SPECIALISED:
+		narrowCollisionMode = TestSATCollisionSpecialised;
+		break;
+	case NarrowCollisionMode::GJK:
+		narrowCollisionMode = GJK::TestCollision;
+		break;
 
 	default:
 		throw std::exception("unknown narrow phase collision detected!");
@@ -49,72 +111,231 @@ CollisionPhaseData CollisionHandler::HandleCollision()
 	{
 	case BroadCollisionMode::BRUTE_FORCE:
 	
-		this->HandleBroadPhaseBruteForce(narrowCollisionMode, isPlayerColliding);
+		this->HandleBroadPhaseBruteForce(narrowCollisionMode);
 		break;
 	case BroadCollisionMode::UNIFORM_GRID:
-		this->HandleBroadPhaseUniformGrid(narrowCollisionMode, isPlayerColliding);
+		this->HandleBroadPhaseUniformGrid(narrowCollisionMode);
 		break;
 
 	case BroadCollisionMode::QUADTREE:
-		this->HandleBroadPhaseQuadtree(narrowCollisionMode, isPlayerColliding);
+		this->HandleBroadPhaseQuadtree(narrowCollisionMode);
+		break;
+
+	case BroadCollisionMode::SWEEP_AND_PRUNE:
+		this->HandleBroadPhaseSweepAndPrune(narrowCollisionMode);
+		break;
+
+	case BroadCollisionMode::AABB_TREE:
+		this->HandleBroadPhaseAABBTree(narrowCollisionMode);
+		break;
+
+	case BroadCollisionMode::LINEAR_QUADTREE:
+		this->HandleBroadPhaseLinearQuadTree(narrowCollisionMode);
+		break;
+
+	case BroadCollisionMode::SPATIAL_HASH:
+		this->HandleBroadPhaseSpatialHashGrid(narrowCollisionMode);
+		break;
+
+	case BroadCollisionMode::UNIFORM_GRID_CSR:
+		this->HandleBroadPhaseUniformGridCSR(narrowCollisionMode);
+		break;
+
+	case BroadCollisionMode::UNIFORM_GRID_PARALLEL:
+		this->HandleBroadPhaseUniformGridParallel(narrowCollisionMode);
+		break;
+
+	case BroadCollisionMode::HIERARCHICAL_GRID:
+		this->HandleBroadPhaseHierarchicalGrid(narrowCollisionMode);
 		break;
 	default:
 		throw std::exception("unknown broad phase collision detected!");
 	}
 
+	// detection is done, the responses run here on the calling thread
+	this->RespondToEvents(isPlayerColliding);
+
+	// pass the events on to anyone listening
+	for (unsigned int i = 0; i < this->_listeners.size(); i++)
+		this->_listeners[i].first(this->_listeners[i].second, this->_scratch.events.data(), static_cast<unsigned int>(this->_scratch.events.size()));
+
 	output.isPlayerColliding = isPlayerColliding;
-	output.nCollisions = _nCollisionsThisFrame;
+	output.nCollisions = static_cast<unsigned int>(this->_scratch.events.size());
 	output.nCollisionTests = _nCollisionTestsThisFrame;
+	output.nCacheSkips = _nCacheSkipsThisFrame;
+	output.nAllocations = static_cast<unsigned int>(AllocationCounter::GetCount() - allocationsAtStart);
+	output.collisionTime = collisionClock.getElapsedTime().asSeconds();
+	output.contacts = &this->_scratch.contacts;
+	output.events = &this->_scratch.events;
 
 	return output;
 }
 
-void CollisionHandler::HandleBroadPhaseBruteForce(std::function<bool(WireframeSprite&, WireframeSprite&)> collisionAlgorithm, bool& isPlayerColliding)
+/* void SetBroadCollisionMode
+ * Brief:
+ *	Sets the broad phase to run. AUTO hands the choice to the broad phase
+ *	selector, which samples brute force, the uniform grid and the quadtree
+ *	and keeps the cheapest. GetBroadCollisionMode always returns the mode
+ *	actually running so the game knows which structure to maintain.
+ * Params:
+ *	<BroadCollisionMode> mode	-	mode to run
+ */
+void CollisionHandler::SetBroadCollisionMode(BroadCollisionMode mode)
+{
+	this->_autoBroadPhase = mode == BroadCollisionMode::AUTO;
+	if (!this->_autoBroadPhase)
+	{
+		this->_broardCollisionMode = mode;
+		return;
+	}
+
+	// the running mode is kept unless sampling finds a cheaper one
+	unsigned int current = 0;
+	for (unsigned int i = 0; i < AUTO_CANDIDATE_COUNT; i++)
+	{
+		if (AUTO_CANDIDATES[i] == this->_broardCollisionMode)
+			current = i;
+	}
+
+	this->_broadPhaseSelector.Reset(current);
+	this->_broardCollisionMode = AUTO_CANDIDATES[this->_broadPhaseSelector.GetCurrent()];
+}
+
+/* void UpdateAutoBroadPhase
+ * Brief:
+ *	Feeds the cost of this frame to the broad phase selector when AUTO is set,
+ *	which may change the broad phase for the next frame. Brute force is skipped
+ *	while sampling if it would run far more tests than the current mode.
+ * Params:
+ *	<float>						maintenanceTime	-	seconds spent updating the active structure this frame
+ *	<const CollisionPhaseData&>	data			-	results of this frame's collision pass
+ */
+void CollisionHandler::UpdateAutoBroadPhase(float maintenanceTime, const CollisionPhaseData& data)
 {
+	if (!this->_autoBroadPhase)
+		return;
+
+	// brute force tests every asteroid against the player, the bullets and every other asteroid
+	unsigned long long nAsteroids = this->_asteroids.size();
+	unsigned long long bruteForceTests = nAsteroids * (1 + this->_bullets.size()) + nAsteroids * (nAsteroids - (nAsteroids > 0 ? 1 : 0)) / 2;
+	unsigned long long currentTests = std::max(data.nCollisionTests, 1u);
+	this->_broadPhaseSelector.SetExcluded(0, bruteForceTests > currentTests * BRUTE_FORCE_SAMPLE_LIMIT);
+
+	unsigned int next = this->_broadPhaseSelector.Update(data.collisionTime + maintenanceTime);
+	this->_broardCollisionMode = AUTO_CANDIDATES[next];
+}
+
+// Returns a display name for the active broad phase mode (used by the collision info)
+std::string CollisionHandler::GetBroadCollisionModeName() const
+{
+	if (this->_autoBroadPhase)
+		return "Auto (" + GetBroadCollisionModeName(this->_broardCollisionMode) + ")";
+
+	return GetBroadCollisionModeName(this->_broardCollisionMode);
+}
+
+// Returns a display name for a broad phase mode
+std::string CollisionHandler::GetBroadCollisionModeName(BroadCollisionMode mode)
+{
+	switch (mode)
+	{
+	case BroadCollisionMode::BRUTE_FORCE:
+		return "Brute Force";
+	case BroadCollisionMode::UNIFORM_GRID:
+		return "Uniform Grid";
+	case BroadCollisionMode::QUADTREE:
+		return "Quadtree";
+	case BroadCollisionMode::SWEEP_AND_PRUNE:
+		return "Sweep and Prune";
+	case BroadCollisionMode::AABB_TREE:
+		return "Dynamic AABB Tree";
+	case BroadCollisionMode::LINEAR_QUADTREE:
+		return "Linear Quadtree";
+	case BroadCollisionMode::SPATIAL_HASH:
+		return "Spatial Hash Grid";
+	case BroadCollisionMode::UNIFORM_GRID_CSR:
+		return "Uniform Grid (CSR)";
+	case BroadCollisionMode::UNIFORM_GRID_PARALLEL:
+		return "Uniform Grid (Parallel)";
+	case BroadCollisionMode::HIERARCHICAL_GRID:
+		return "Hierarchical Grid";
+	case BroadCollisionMode::AUTO:
+		return "Auto";
+	}
+
+	return "Unknown";
+}
+
+// Returns a display name for the active narrow phase mode (used by the collision info)
+std::string CollisionHandler::GetNarrowCollisionModeName() const
+{
+	switch (this->_narrowCollisionMode)
+	{
+	case NarrowCollisionMode::AABB:
+		return "AABB";
+	case NarrowCollisionMode::SEPERATED_AXIS_THEOREM:
+		return "SAT";
+	case NarrowCollisionMode::SEPERATED_AXIS_THEOREM_SIMD:
+		return std::string("SAT (") + SimdSAT::GetInstructionSetName() + ")";
+	case NarrowCollisionMode::SEPERATED_AXIS_THEOREM_SPECIALISED:
+		return "SAT (Specialised)";
+	case NarrowCollisionMode::GJK:
+		return this->_useEPA ? "GJK + EPA" : "GJK";
+	}
+
+	return "Unknown";
+}
+
+void CollisionHandler::HandleBroadPhaseBruteForce(NarrowPhaseTest collisionAlgorithm)
+{
+	// every pair goes through CheckCollisionPair, which applies the masks, counts the test and uses the pair cache
 	for (auto itAsteroid = this->_asteroids.begin(); itAsteroid != this->_asteroids.end(); itAsteroid++)
 	{
-		_nCollisionTestsThisFrame++;// test for player
 		// Player collision
 		if (this->_collidePlayer)
-			if (collisionAlgorithm(this->_player, **itAsteroid))
-			{
-				this->_nCollisionsThisFrame++;
-				isPlayerColliding = true;
-			}
+			this->CheckCollisionPair(collisionAlgorithm, &this->_player, *itAsteroid);
 		// Bullet Collision
 		if (this->_collideBullets)
 			for (auto itBullet = this->_bullets.begin(); itBullet != this->_bullets.end(); itBullet++)
-			{
-				_nCollisionTestsThisFrame++; // collision tests for bullets
-				// if asteroid colliding with bullet, add the index to the list of asteroids to be split after collision testing
-				if (collisionAlgorithm(**itBullet, **itAsteroid))
-				{
-					this->_nCollisionsThisFrame++;
-					// mark that bullet for cleanup  and asteroid for splitting now that it's hit something
-					(*itBullet)->Disable();
-					(*itAsteroid)->MarkForSplitting();
-				}
-			}
+				this->CheckCollisionPair(collisionAlgorithm, *itAsteroid, *itBullet);
 
 		//AsteroidOnAsteroid Collision
 		if (this->_collideAsteroids)
 			for (auto itAsteroidTwo = itAsteroid + 1; itAsteroidTwo != this->_asteroids.end(); itAsteroidTwo++)
-			{
-				_nCollisionTestsThisFrame++; // collision tests for asteroids
-				// Check for collision of pair
-				if (collisionAlgorithm((WireframeSprite&)**itAsteroid, (WireframeSprite&)**itAsteroidTwo))
-				{
-					(*itAsteroid)->_shape.setOutlineColor(ASTEROID_COLLISION_COLOR);
-					(*itAsteroidTwo)->_shape.setOutlineColor(ASTEROID_COLLISION_COLOR);
-					this->_nCollisionsThisFrame++;
-				}
-			}
+				this->CheckCollisionPair(collisionAlgorithm, *itAsteroid, *itAsteroidTwo);
+	}
+
+	if (!this->_wrapGhosts)
+		return;
+
+	// the screen wraps, so the sprites are also tested against the ghosts of those over an edge
+	for (unsigned int i = 0; i < this->_wrapGhosts->GetCount(); i++)
+	{
+		WireframeSprite* ghost = this->_wrapGhosts->GetGhost(i);
+		bool isPlayerGhost = ghost->GetGhostOwner() == &this->_player;
+
+		for (auto itAsteroid = this->_asteroids.begin(); itAsteroid != this->_asteroids.end(); itAsteroid++)
+		{
+			if (*itAsteroid != ghost->GetGhostOwner() && (isPlayerGhost ? this->_collidePlayer : this->_collideAsteroids))
+				this->CheckCollisionPair(collisionAlgorithm, *itAsteroid, ghost);
+		}
+
+		if (isPlayerGhost)
+			continue;
+
+		if (this->_collidePlayer)
+			this->CheckCollisionPair(collisionAlgorithm, &this->_player, ghost);
+
+		if (this->_collideBullets)
+			for (auto itBullet = this->_bullets.begin(); itBullet != this->_bullets.end(); itBullet++)
+				this->CheckCollisionPair(collisionAlgorithm, ghost, *itBullet);
 	}
 }
 
-void CollisionHandler::HandleBroadPhaseUniformGrid(std::function<bool(WireframeSprite&, WireframeSprite&)> collisionAlgorithm, bool& isPlayerColliding)
+void CollisionHandler::HandleBroadPhaseUniformGrid(NarrowPhaseTest collisionAlgorithm)
 {
-	auto cells = this->_grid._cells;
+	// reference the cells, copying them would copy every cell's container each frame
+	std::vector<Cell>& cells = this->_grid._cells;
 
 	// loop through all cells
 	for (unsigned int i = 0; i < cells.size(); i++)
@@ -131,146 +352,583 @@ void CollisionHandler::HandleBroadPhaseUniformGrid(std::function<bool(WireframeS
 			WireframeSprite* sprite = cell->_objects[j];	// local pointer to current ball in current cell
 
 			// update collisions with starting cell
-			CheckCollision(collisionAlgorithm, sprite, cell->_objects, j + 1, isPlayerColliding);
+			CheckCollision(collisionAlgorithm, sprite, cell->_objects, j + 1);
 
 			// update collision with neighbor cells
 			if (x > 0)	// checks to the left
 			{
 				// check left
-				CheckCollision(collisionAlgorithm, sprite, _grid.GetCell(x - 1, y)._objects, 0, isPlayerColliding);
+				CheckCollision(collisionAlgorithm, sprite, _grid.GetCell(x - 1, y)._objects, 0);
 				if (y > 0)
 				{
 					// check top left cell x-1 y-1
-					CheckCollision(collisionAlgorithm, sprite, _grid.GetCell(x - 1, y - 1)._objects, 0, isPlayerColliding);
+					CheckCollision(collisionAlgorithm, sprite, _grid.GetCell(x - 1, y - 1)._objects, 0);
 				}
 				// Check bottom left
-				if (y < _grid._numYCells - 1)
+				if (y < _grid.GetNumYCells() - 1)
 				{
-					CheckCollision(collisionAlgorithm, sprite, _grid.GetCell(x - 1, y + 1)._objects, 0, isPlayerColliding);
+					CheckCollision(collisionAlgorithm, sprite, _grid.GetCell(x - 1, y + 1)._objects, 0);
 				}
 			}
 			// Check top
 			if (y > 0)
 			{
-				CheckCollision(collisionAlgorithm, sprite, _grid.GetCell(x, y - 1)._objects, 0, isPlayerColliding);
+				CheckCollision(collisionAlgorithm, sprite, _grid.GetCell(x, y - 1)._objects, 0);
 			}
 		}
 	}
+
+	// bullets are swept through the grid rather than stored in it
+	this->HandleBulletSweeps(false);
 }
 
-void CollisionHandler::HandleBroadPhaseQuadtree(std::function<bool(WireframeSprite&, WireframeSprite&)> collisionAlgorithm, bool& isPlayerColliding)
+/* void HandleBroadPhaseUniformGridParallel
+ * Brief:
+ *	Splits the grid cells, in row major order, into stripes claimed by the
+ *	workers of the pool. Each stripe records its collision events in its own
+ *	buffer, the buffers are then merged on the calling thread in stripe order.
+ */
+void CollisionHandler::HandleBroadPhaseUniformGridParallel(NarrowPhaseTest collisionAlgorithm)
 {
-	std::vector<WireframeSprite*> others;
+	if (!this->_workerPool)
+		this->_workerPool = new WorkerPool(std::max(1u, std::thread::hardware_concurrency()));
+
+	std::vector<Cell>& cells = this->_grid._cells;
+
+	// SFML works out a shape's transform lazily the first time it's read, and so
+	// do the sprites' points, so build them here to leave the workers with nothing to write
+	if (collisionAlgorithm == AABBCollision)
+		for (unsigned int i = 0; i < cells.size(); i++)
+			for (unsigned int j = 0; j < cells[i]._objects.size(); j++)
+				cells[i]._objects[j]->GetBoundingRectangle();
+	else
+		for (unsigned int i = 0; i < cells.size(); i++)
+			for (unsigned int j = 0; j < cells[i]._objects.size(); j++)
+				cells[i]._objects[j]->EnsurePoints();
+
+	// Each pair is owned by the cell of the sprite checking its half neighbourhood, so a
+	// stripe can read the cells either side of its seams without finding a pair twice
+	this->_nStripes = std::min(static_cast<unsigned int>(cells.size()), this->_workerPool->GetWorkerCount() * STRIPES_PER_WORKER);
+	if (this->_stripeResults.size() < this->_nStripes)
+		this->_stripeResults.resize(this->_nStripes);
+
+	for (unsigned int s = 0; s < this->_nStripes; s++)
+	{
+		this->_stripeResults[s].events.clear();
+		this->_stripeResults[s].nCollisionTests = 0;
+	}
 
-	// player collision
-	this->_quadTree->Query(this->_player.GetBoundingRectangle(), others);
-	// if the collision mode is AABB, quadtree already uses aabb to narrow down search so can just ignore the detailed test
-	this->CheckCollision((this->_narrowCollisionMode == NarrowCollisionMode::AABB? BypassNarrowTest:collisionAlgorithm),
-		&this->_player, others, 0, isPlayerColliding);
-	others.clear();
+	// the pair cache isn't thread safe so the workers always use the plain test
+	this->_stripeNarrowTest = collisionAlgorithm;
+	this->_nextStripe.store(0);
+	this->_workerPool->Run(UniformGridStripeJob, this);
 
-	// Asteroid collision
-	for (unsigned int i = 0; i < this->_asteroids.size(); i++)
+	// merge on this thread in stripe order
+	for (unsigned int s = 0; s < this->_nStripes; s++)
 	{
-		// find any possible collisions with the asteroid
-		this->_quadTree->Query(this->_asteroids[i]->GetBoundingRectangle(), others);
-		// if the collision mode is AABB, quadtree already uses aabb to narrow down search so can just ignore the detailed test
-		this->CheckCollision((this->_narrowCollisionMode == NarrowCollisionMode::AABB ? BypassNarrowTest : collisionAlgorithm),
-			this->_asteroids[i], others, 0, isPlayerColliding);
-		others.clear();
+		const StripeResult& result = this->_stripeResults[s];
+		this->_nCollisionTestsThisFrame += result.nCollisionTests;
+		this->_scratch.events.insert(this->_scratch.events.end(), result.events.begin(), result.events.end());
 	}
 
-	// Bullet collision
+	// bullets are swept through the grid rather than stored in it
+	this->HandleBulletSweeps(false);
+}
+
+/* void HandleBulletSweeps
+ * Brief:
+ *	Bullets aren't stored in the uniform grid. Each bullet is treated as the
+ *	segment it travels along this frame and walked through the grid cells
+ *	with a DDA, testing the asteroids around each cell. The walk ends at the
+ *	first asteroid hit, so fast bullets can't pass through small asteroids.
+ *	The cells are walked by the grid's segment query, the CSR copy by a
+ *	visitor of its own as the query only reads the cells.
+ * Params:
+ *	<bool>	useCSR	-	read the CSR copy of the grid rather than the cells
+ */
+void CollisionHandler::HandleBulletSweeps(bool useCSR)
+{
 	for (unsigned int i = 0; i < this->_bullets.size(); i++)
 	{
-		// find any possible collisions with the asteroid
-		this->_quadTree->Query(this->_bullets[i]->GetBoundingRectangle(), others);
-		// if the collision mode is AABB, quadtree already uses aabb to narrow down search so can just ignore the detailed test
-		this->CheckCollision((this->_narrowCollisionMode == NarrowCollisionMode::AABB ? BypassNarrowTest : collisionAlgorithm),
-			this->_bullets[i], others, 0, isPlayerColliding);
-		others.clear();
+		Bullet* bullet = this->_bullets[i];
+
+		// the asteroid points are next frame's, so sweep up to the bullet's next position
+		BulletSweep sweep;
+		sweep.handler = this;
+		sweep.bullet = bullet;
+		sweep.start = bullet->GetPosition();
+		sweep.end = bullet->GetPosition() + bullet->GetVelocity();
+
+		if (useCSR)
+			this->_grid.TraverseSegment(sweep.start, sweep.end, BulletSweepVisitor, &sweep);
+		else
+			this->_grid.SegmentQuery(sweep.start, sweep.end, BulletSweepHit, &sweep);
+
+		if (sweep.hit)
+			this->RaiseEvent(sweep.hit, bullet);
+	}
+}
+
+// Segment query callback for a bullet sweep, stops at the first asteroid the bullet can hit
+bool CollisionHandler::BulletSweepHit(void* context, WireframeSprite* sprite, float /*distance*/)
+{
+	BulletSweep& sweep = *static_cast<BulletSweep*>(context);
+
+	// hits come nearest first, so the first one the bullet can collide with is the one
+	sweep.handler->_nCollisionTestsThisFrame++;
+	if (!sweep.bullet->CanCollideWith(*sprite))
+		return true;
+
+	sweep.hit = sprite;
+	return false;
+}
+
+// Grid visitor for a bullet sweep over the CSR copy, tests the asteroids around the cell
+bool CollisionHandler::BulletSweepVisitor(void* context, int x, int y, float /*tEnter*/, float tExit)
+{
+	BulletSweep& sweep = *static_cast<BulletSweep*>(context);
+	CollisionHandler* handler = sweep.handler;
+	UniformGrid& grid = handler->_grid;
+
+	// sprites are binned by their centre, so anything overlapping this cell is
+	// in it or a neighbour as long as it's no bigger than a cell
+	for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, grid.GetNumYCells() - 1); ny++)
+	{
+		for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, grid.GetNumXCells() - 1); nx++)
+		{
+			unsigned int count;
+			WireframeSprite* const* objects = grid.GetCSRCell(nx, ny, count);
+
+			for (unsigned int i = 0; i < count; i++)
+			{
+				WireframeSprite* sprite = objects[i];
+				if (!sprite || !sweep.bullet->CanCollideWith(*sprite))
+					continue;
+
+				handler->_nCollisionTestsThisFrame++;
+
+				float t;
+				if (RayCast::IntersectPolygon(sweep.start, sweep.end, sprite->GetPoints(), t) && t < sweep.hitT)
+				{
+					sweep.hit = sprite;
+					sweep.hitT = t;
+				}
+			}
+		}
 	}
 
+	// every hit before this cell's exit has been found, keep walking otherwise
+	return !(sweep.hit && sweep.hitT <= tExit);
 }
 
-void CollisionHandler::CheckCollision(std::function<bool(WireframeSprite&, WireframeSprite&)> collisionAlgorithm,
-	WireframeSprite* spriteA, std::vector<WireframeSprite*>& spritesToCheck, unsigned int startingIndex, bool& isPlayerColliding)
+// Worker job for the parallel grid, claims stripes until none are left
+void CollisionHandler::UniformGridStripeJob(void* context, unsigned int /*workerIndex*/)
 {
-	if (!spriteA)
-		return;
+	CollisionHandler* handler = static_cast<CollisionHandler*>(context);
+
+	for (unsigned int stripe = handler->_nextStripe++; stripe < handler->_nStripes; stripe = handler->_nextStripe++)
+		handler->ProcessUniformGridStripe(stripe);
+}
 
+// Runs the broad and narrow phase over every cell of a stripe, recording the colliding pairs
+void CollisionHandler::ProcessUniformGridStripe(unsigned int stripe)
+{
+	std::vector<Cell>& cells = this->_grid._cells;
+	StripeResult& result = this->_stripeResults[stripe];
+
+	unsigned int firstCell = static_cast<unsigned int>(cells.size()) * stripe / this->_nStripes;
+	unsigned int lastCell = static_cast<unsigned int>(cells.size()) * (stripe + 1) / this->_nStripes;
+
+	// same half neighbourhood as the serial grid
+	for (unsigned int i = firstCell; i < lastCell; i++)
+	{
+		const Cell& cell = cells[i];
+		int x = i % this->_grid._numXCells;
+		int y = i / this->_grid._numXCells;
+
+		for (unsigned int j = 0; j < cell._objects.size(); j++)
+		{
+			WireframeSprite* sprite = cell._objects[j];
+
+			// starting cell
+			this->CheckCollisionStripe(sprite, cell._objects, j + 1, result);
+
+			if (x > 0)
+			{
+				// left, top left and bottom left
+				this->CheckCollisionStripe(sprite, this->_grid.GetCell(x - 1, y)._objects, 0, result);
+				if (y > 0)
+					this->CheckCollisionStripe(sprite, this->_grid.GetCell(x - 1, y - 1)._objects, 0, result);
+				if (y < this->_grid.GetNumYCells() - 1)
+					this->CheckCollisionStripe(sprite, this->_grid.GetCell(x - 1, y + 1)._objects, 0, result);
+			}
+
+			// top
+			if (y > 0)
+				this->CheckCollisionStripe(sprite, this->_grid.GetCell(x, y - 1)._objects, 0, result);
+		}
+	}
+}
+
+// Thread safe version of CheckCollision, records events in the stripe's buffer
+void CollisionHandler::CheckCollisionStripe(WireframeSprite* spriteA, const std::vector<WireframeSprite*>& spritesToCheck,
+	unsigned int startingIndex, StripeResult& result)
+{
 	for (unsigned int i = startingIndex; i < spritesToCheck.size(); i++)
 	{
-		if (!spritesToCheck[i])
+		WireframeSprite* spriteB = spritesToCheck[i];
+
+		if (!spriteB)
 			return;
 
-		// no point checking collision against yourself
-		if (spritesToCheck[i] == spriteA)
+		// no point checking collision against yourself, or pairs the masks forbid
+		if (spriteB == spriteA || !spriteA->CanCollideWith(*spriteB))
 			continue;
 
-		// test being performed, increase number for data collection
-		this->_nCollisionTestsThisFrame++;
-		if (collisionAlgorithm(*spriteA, *spritesToCheck[i]))
-		{
-			// Collision happened, increase number for data collection
-			this->_nCollisionsThisFrame++;
+		result.nCollisionTests++;
+		if (this->_stripeNarrowTest(*spriteA, *spriteB))
+			result.events.push_back(MakeEvent(spriteA, spriteB));
+	}
+}
+
+void CollisionHandler::HandleBroadPhaseQuadtree(NarrowPhaseTest collisionAlgorithm)
+{
+	// if the collision mode is AABB, the tree only reports pairs with overlapping bounds so can just ignore the detailed test
+	NarrowPhaseTest pairAlgorithm =
+		(this->_narrowCollisionMode == NarrowCollisionMode::AABB ? BypassNarrowTest : collisionAlgorithm);
+
+	// one walk of the tree finds every pair once, rather than a query per sprite finding each pair twice
+	this->_scratch.broadPairs.clear();
+	this->_quadTree->FindPairs(this->_scratch.broadPairs);
+
+	for (unsigned int i = 0; i < this->_scratch.broadPairs.size(); i++)
+	{
+		this->CheckCollisionPair(pairAlgorithm, this->_scratch.broadPairs[i].first, this->_scratch.broadPairs[i].second);
+	}
+}
+
+void CollisionHandler::HandleBroadPhaseSweepAndPrune(NarrowPhaseTest collisionAlgorithm)
+{
+	// if the collision mode is AABB, the sweep already confirmed the bounding boxes overlap so can just ignore the detailed test
+	NarrowPhaseTest pairAlgorithm =
+		(this->_narrowCollisionMode == NarrowCollisionMode::AABB ? BypassNarrowTest : collisionAlgorithm);
+
+	// find all pairs overlapping on both axes
+	this->_scratch.broadPairs.clear();
+	this->_sweepAndPrune.FindPairs(this->_scratch.broadPairs);
+
+	// test each possible pair once
+	for (unsigned int i = 0; i < this->_scratch.broadPairs.size(); i++)
+	{
+		this->CheckCollisionPair(pairAlgorithm, this->_scratch.broadPairs[i].first, this->_scratch.broadPairs[i].second);
+	}
+}
+
+void CollisionHandler::HandleBroadPhaseAABBTree(NarrowPhaseTest collisionAlgorithm)
+{
+	// if the collision mode is AABB, the tree only reports pairs with overlapping bounds so can just ignore the detailed test
+	NarrowPhaseTest pairAlgorithm =
+		(this->_narrowCollisionMode == NarrowCollisionMode::AABB ? BypassNarrowTest : collisionAlgorithm);
 
-			WireframeSprite* pSpriteA = spriteA;
-			WireframeSprite* pSpriteB = spritesToCheck[i];
+	// self overlap query, every pair is only found once
+	this->_scratch.broadPairs.clear();
+	this->_aabbTree.FindPairs(this->_scratch.broadPairs);
 
-			// loop through to check in both directions
-			for (int l = 0; l < 2; l++)
+	for (unsigned int i = 0; i < this->_scratch.broadPairs.size(); i++)
+	{
+		this->CheckCollisionPair(pairAlgorithm, this->_scratch.broadPairs[i].first, this->_scratch.broadPairs[i].second);
+	}
+}
+
+void CollisionHandler::HandleBroadPhaseLinearQuadTree(NarrowPhaseTest collisionAlgorithm)
+{
+	// if the collision mode is AABB, the tree only reports pairs with overlapping bounds so can just ignore the detailed test
+	NarrowPhaseTest pairAlgorithm =
+		(this->_narrowCollisionMode == NarrowCollisionMode::AABB ? BypassNarrowTest : collisionAlgorithm);
+
+	// pairs come out in morton order so neighbouring tests touch neighbouring sprites
+	this->_scratch.broadPairs.clear();
+	this->_linearQuadTree.FindPairs(this->_scratch.broadPairs);
+
+	for (unsigned int i = 0; i < this->_scratch.broadPairs.size(); i++)
+	{
+		this->CheckCollisionPair(pairAlgorithm, this->_scratch.broadPairs[i].first, this->_scratch.broadPairs[i].second);
+	}
+}
+
+void CollisionHandler::HandleBroadPhaseSpatialHashGrid(NarrowPhaseTest collisionAlgorithm)
+{
+	// if the collision mode is AABB, pairs are only reported if their bounds overlap so can just ignore the detailed test
+	NarrowPhaseTest pairAlgorithm =
+		(this->_narrowCollisionMode == NarrowCollisionMode::AABB ? BypassNarrowTest : collisionAlgorithm);
+
+	// hash every sprite into the cells it overlaps and test the pairs sharing a cell
+	this->_scratch.broadPairs.clear();
+	this->_spatialHashGrid.FindPairs(this->_scratch.broadPairs);
+
+	for (unsigned int i = 0; i < this->_scratch.broadPairs.size(); i++)
+	{
+		this->CheckCollisionPair(pairAlgorithm, this->_scratch.broadPairs[i].first, this->_scratch.broadPairs[i].second);
+	}
+}
+
+void CollisionHandler::HandleBroadPhaseHierarchicalGrid(NarrowPhaseTest collisionAlgorithm)
+{
+	// if the collision mode is AABB, pairs are only reported if their bounds overlap so can just ignore the detailed test
+	NarrowPhaseTest pairAlgorithm =
+		(this->_narrowCollisionMode == NarrowCollisionMode::AABB ? BypassNarrowTest : collisionAlgorithm);
+
+	// each sprite is on the level matching its size and checks its own level and the coarser ones
+	this->_scratch.broadPairs.clear();
+	this->_hierarchicalGrid.FindPairs(this->_scratch.broadPairs);
+
+	for (unsigned int i = 0; i < this->_scratch.broadPairs.size(); i++)
+	{
+		this->CheckCollisionPair(pairAlgorithm, this->_scratch.broadPairs[i].first, this->_scratch.broadPairs[i].second);
+	}
+}
+
+void CollisionHandler::HandleBroadPhaseUniformGridCSR(NarrowPhaseTest collisionAlgorithm)
+{
+	// same neighbour pattern as the uniform grid, but every cell is a range of one contiguous array
+	for (int y = 0; y < this->_grid._numYCells; y++)
+	{
+		for (int x = 0; x < this->_grid._numXCells; x++)
+		{
+			unsigned int count = 0;
+			WireframeSprite* const* cell = this->_grid.GetCSRCell(x, y, count);
+
+			// loop through cell objects
+			for (unsigned int j = 0; j < count; j++)
 			{
-				// on 2nd iteration swap pointers
-				if (l == 1)
-				{
-					pSpriteA = spritesToCheck[i];
-					pSpriteB = spriteA;
-				}
+				WireframeSprite* sprite = cell[j];
+				unsigned int neighbourCount = 0;
+				WireframeSprite* const* neighbour = nullptr;
 
-				// Get the names of the derived class so specific action can be performed on specific collision types
-				const char* spriteAtype = typeid(*pSpriteA).name();
-				const char* spriteBtype = typeid(*pSpriteB).name();
+				// update collisions with starting cell
+				CheckCollision(collisionAlgorithm, sprite, cell + j + 1, count - j - 1);
 
-				// Test for player collision
-				if (this->_collidePlayer)
-					if (std::strcmp(spriteAtype, "class Player") == 0 && std::strcmp(spriteBtype, "class Asteroid") == 0)
+				// update collision with neighbor cells
+				if (x > 0)	// checks to the left
+				{
+					// check left
+					neighbour = this->_grid.GetCSRCell(x - 1, y, neighbourCount);
+					CheckCollision(collisionAlgorithm, sprite, neighbour, neighbourCount);
+					if (y > 0)
 					{
-						isPlayerColliding = true;
+						// check top left cell x-1 y-1
+						neighbour = this->_grid.GetCSRCell(x - 1, y - 1, neighbourCount);
+						CheckCollision(collisionAlgorithm, sprite, neighbour, neighbourCount);
 					}
-
-				// Test for bullet against asteroid collision
-				if (this->_collideBullets)
-					if (std::strcmp(spriteAtype, "class Bullet") == 0 && std::strcmp(spriteBtype, "class Asteroid") == 0)
+					// Check bottom left
+					if (y < this->_grid.GetNumYCells() - 1)
 					{
-						// find index in array for deletion
-						auto itr = std::find(this->_asteroids.begin(), this->_asteroids.end(), pSpriteB);
-						int index = std::distance(this->_asteroids.begin(), itr);
-
-						// clean up bullet after hitting an asteroid
-						Bullet* bulletToDestroy = dynamic_cast<Bullet*>(pSpriteA);
-						if (bulletToDestroy)
-							bulletToDestroy->Disable();
-
-						// mark the asteroid to be split
-						Asteroid* asteroidToSplit = dynamic_cast<Asteroid*>(pSpriteB);
-						if (asteroidToSplit)
-							asteroidToSplit->MarkForSplitting();
+						neighbour = this->_grid.GetCSRCell(x - 1, y + 1, neighbourCount);
+						CheckCollision(collisionAlgorithm, sprite, neighbour, neighbourCount);
 					}
-
-				// Test for asteroid against asteroid collision
-				// Only need to test once as both objects are the same type so either way round will trigger the method
-				if (this->_collideAsteroids && l == 0)
+				}
+				// Check top
+				if (y > 0)
 				{
-					if (strcmp(spriteAtype, "class Asteroid") == 0 && std::strcmp(spriteBtype, "class Asteroid") == 0)
-					{
-						pSpriteA->_shape.setOutlineColor(ASTEROID_COLLISION_COLOR);
-						pSpriteB->_shape.setOutlineColor(ASTEROID_COLLISION_COLOR);
-					}
+					neighbour = this->_grid.GetCSRCell(x, y - 1, neighbourCount);
+					CheckCollision(collisionAlgorithm, sprite, neighbour, neighbourCount);
 				}
 			}
 		}
 	}
+
+	// bullets are swept through the grid rather than stored in it
+	this->HandleBulletSweeps(true);
+}
+
+void CollisionHandler::CheckCollision(NarrowPhaseTest collisionAlgorithm,
+	WireframeSprite* spriteA, std::vector<WireframeSprite*>& spritesToCheck, unsigned int startingIndex)
+{
+	if (!spriteA)
+		return;
+
+	for (unsigned int i = startingIndex; i < spritesToCheck.size(); i++)
+	{
+		if (!spritesToCheck[i])
+			return;
+
+		// no point checking collision against yourself
+		if (spritesToCheck[i] == spriteA)
+			continue;
+
+		this->CheckCollisionPair(collisionAlgorithm, spriteA, spritesToCheck[i]);
+	}
+}
+
+// Overload taking a contiguous range of sprites (CSR grid cells)
+void CollisionHandler::CheckCollision(NarrowPhaseTest collisionAlgorithm,
+	WireframeSprite* spriteA, WireframeSprite* const* spritesToCheck, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		// no point checking collision against yourself
+		if (spritesToCheck[i] == spriteA)
+			continue;
+
+		this->CheckCollisionPair(collisionAlgorithm, spriteA, spritesToCheck[i]);
+	}
+}
+
+// Runs the narrow phase on a single pair and raises an event if they collide
+void CollisionHandler::CheckCollisionPair(NarrowPhaseTest collisionAlgorithm,
+	WireframeSprite* spriteA, WireframeSprite* spriteB)
+{
+	// pairs the masks forbid never reach the narrow phase
+	if (!spriteA->CanCollideWith(*spriteB))
+		return;
+
+	// test being performed, increase number for data collection
+	this->_nCollisionTestsThisFrame++;
+
+	// SAT goes through the pair cache when it's enabled. Wrap ghosts are reused for
+	// different sprites every frame so their ids can't key the cache
+	bool isGhostPair = spriteA->GetGhostOwner() || spriteB->GetGhostOwner();
+	bool isColliding = (this->_usePairCache && !isGhostPair && collisionAlgorithm == TestSATCollision) ?
+		this->TestSATCollisionCached(*spriteA, *spriteB) : collisionAlgorithm(*spriteA, *spriteB);
+
+	if (isColliding)
+		this->RaiseEvent(spriteA, spriteB);
+}
+
+/* void Subscribe
+ * Brief:
+ *	Registers a listener to be given the collision events at the end of every
+ *	collision pass, once the responses have run
+ * Params:
+ *	<CollisionEventListener>	listener	-	function to call
+ *	<void*>						context		-	passed through to the listener
+ */
+void CollisionHandler::Subscribe(CollisionEventListener listener, void* context)
+{
+	this->_listeners.push_back(std::make_pair(listener, context));
+}
+
+// Removes a listener registered with the same function and context
+void CollisionHandler::Unsubscribe(CollisionEventListener listener, void* context)
+{
+	this->_listeners.erase(std::remove(this->_listeners.begin(), this->_listeners.end(), std::make_pair(listener, context)), this->_listeners.end());
+}
+
+// Builds the event for a colliding pair, ordering the pair. Thread safe
+CollisionEvent CollisionHandler::MakeEvent(WireframeSprite* spriteA, WireframeSprite* spriteB)
+{
+	// the sprites actually tested, kept for the contact
+	WireframeSprite* testedA = spriteA;
+	WireframeSprite* testedB = spriteB;
+
+	// a hit on a wrap ghost is a hit on the sprite it was copied from, the
+	// owner's id also lets the pair be merged with the same hit found directly
+	if (spriteA->GetGhostOwner())
+		spriteA = spriteA->GetGhostOwner();
+	if (spriteB->GetGhostOwner())
+		spriteB = spriteB->GetGhostOwner();
+
+	// lower category first, only that half of the response table is filled
+	if (spriteA->GetCategory() > spriteB->GetCategory() ||
+		(spriteA->GetCategory() == spriteB->GetCategory() && spriteA->GetId() > spriteB->GetId()))
+	{
+		std::swap(spriteA, spriteB);
+		std::swap(testedA, testedB);
+	}
+
+	CollisionEvent collisionEvent;
+	collisionEvent.idA = spriteA->GetId();
+	collisionEvent.idB = spriteB->GetId();
+	collisionEvent.categoryA = spriteA->GetCategory();
+	collisionEvent.categoryB = spriteB->GetCategory();
+	collisionEvent.spriteA = spriteA;
+	collisionEvent.spriteB = spriteB;
+	collisionEvent.testedA = testedA;
+	collisionEvent.testedB = testedB;
+	return collisionEvent;
+}
+
+// Orders events by pair so duplicates sit next to each other
+bool CollisionHandler::EventPairLess(const CollisionEvent& a, const CollisionEvent& b)
+{
+	return a.idA < b.idA || (a.idA == b.idA && a.idB < b.idB);
+}
+
+bool CollisionHandler::EventPairEqual(const CollisionEvent& a, const CollisionEvent& b)
+{
+	return a.idA == b.idA && a.idB == b.idB;
+}
+
+/* void RespondToEvents
+ * Brief:
+ *	Runs once detection has finished. Removes duplicate pairs (a pair can be
+ *	found by more than one cell or node), then looks up and runs the response
+ *	for each event and records the EPA contacts.
+ * Params:
+ *	<bool&>	isPlayerColliding	-	set if the player hit an asteroid
+ */
+void CollisionHandler::RespondToEvents(bool& isPlayerColliding)
+{
+	std::vector<CollisionEvent>& events = this->_scratch.events;
+
+	// sorting doesn't allocate and leaves the events in a stable order for the listeners
+	std::sort(events.begin(), events.end(), EventPairLess);
+	events.erase(std::unique(events.begin(), events.end(), EventPairEqual), events.end());
+
+	for (unsigned int i = 0; i < events.size(); i++)
+	{
+		const CollisionEvent& collisionEvent = events[i];
+
+		// contact for a physical response, only GJK leaves a simplex to expand
+		if (this->_useEPA && this->_narrowCollisionMode == NarrowCollisionMode::GJK)
+			this->RecordContact(collisionEvent);
+
+		CollisionResponse response = this->_responses[static_cast<int>(collisionEvent.categoryA)][static_cast<int>(collisionEvent.categoryB)];
+		if (response)
+			(this->*response)(collisionEvent.spriteA, collisionEvent.spriteB, isPlayerColliding);
+	}
+}
+
+// Runs EPA on the sprites tested for a colliding pair and stores the contact for this frame
+void CollisionHandler::RecordContact(const CollisionEvent& collisionEvent)
+{
+	CollisionContact contact;
+	contact.spriteA = collisionEvent.spriteA;
+	contact.spriteB = collisionEvent.spriteB;
+
+	// the owners of a pair found through a wrap ghost are a window apart, only the tested sprites touch
+	if (GJK::FindContact(*collisionEvent.testedA, *collisionEvent.testedB, contact.normal, contact.depth))
+		this->_scratch.contacts.push_back(contact);
+}
+
+// Player hit an asteroid
+void CollisionHandler::RespondPlayerAsteroid(WireframeSprite* /*player*/, WireframeSprite* /*asteroid*/, bool& isPlayerColliding)
+{
+	if (this->_collidePlayer)
+		isPlayerColliding = true;
+}
+
+// Two asteroids overlap, highlight both
+void CollisionHandler::RespondAsteroidAsteroid(WireframeSprite* asteroidA, WireframeSprite* asteroidB, bool& /*isPlayerColliding*/)
+{
+	if (!this->_collideAsteroids)
+		return;
+
+	static_cast<Asteroid*>(asteroidA)->SetColour(ASTEROID_COLLISION_COLOR);
+	static_cast<Asteroid*>(asteroidB)->SetColour(ASTEROID_COLLISION_COLOR);
+}
+
+// Bullet hit an asteroid, the category tags guarantee the types so no dynamic_cast is needed
+void CollisionHandler::RespondAsteroidBullet(WireframeSprite* asteroid, WireframeSprite* bullet, bool& /*isPlayerColliding*/)
+{
+	if (!this->_collideBullets)
+		return;
+
+	// clean up bullet after hitting an asteroid
+	static_cast<Bullet*>(bullet)->Disable();
+
+	// mark the asteroid to be split
+	static_cast<Asteroid*>(asteroid)->MarkForSplitting();
 }
 
 bool CollisionHandler::AABBCollision(WireframeSprite& spriteA, WireframeSprite& spriteB)
@@ -285,10 +943,17 @@ bool CollisionHandler::AABBCollision(WireframeSprite& spriteA, WireframeSprite&
 }
 
 bool CollisionHandler::TestSATCollision(WireframeSprite& spriteA, WireframeSprite& spriteB)
+{
+	sf::Vector2f separatingAxis;
+	float gap = 0.0f;
+	return TestSATSeparation(spriteA, spriteB, separatingAxis, gap);
+}
+
+// SAT test that also outputs the axis separating the sprites and the gap between them along it
+bool CollisionHandler::TestSATSeparation(WireframeSprite& spriteA, WireframeSprite& spriteB, sf::Vector2f& separatingAxis, float& gap)
 {
 	WireframeSprite* pSpriteA = &spriteA;
 	WireframeSprite* pSpriteB = &spriteB;
-	float overlap = INFINITY;
 
 	// Loop over both shapes given
 	for (int i = 0; i < 2; i++)
@@ -300,8 +965,8 @@ bool CollisionHandler::TestSATCollision(WireframeSprite& spriteA, WireframeSprit
 			pSpriteB = &spriteA;
 		}
 		// Create references of the points belonging to the sprites (translated)
-		auto spriteAPoints = pSpriteA->GetPoints();
-		auto spriteBPoints = pSpriteB->GetPoints();
+		PointSpan spriteAPoints = pSpriteA->GetPoints();
+		PointSpan spriteBPoints = pSpriteB->GetPoints();
 
 		// Loop through points and test the collisions against them
 		for (unsigned int a = 0; a < spriteAPoints.size(); a++)
@@ -315,32 +980,171 @@ bool CollisionHandler::TestSATCollision(WireframeSprite& spriteA, WireframeSprit
 			float d = sqrtf(axisProj.x * axisProj.x + axisProj.y * axisProj.y);
 			axisProj = { axisProj.x / d, axisProj.y / d };
 
-			// Work out min and max 1D points for sprite 1
-			float min_sprite1 = INFINITY, max_sprite1 = -INFINITY;
-			for (unsigned int p = 0; p < spriteAPoints.size(); p++)
-			{
-				float q = (spriteAPoints[p].x * axisProj.x + spriteAPoints[p].y * axisProj.y);
-				min_sprite1 = std::min(min_sprite1, q);
-				max_sprite1 = std::max(max_sprite1, q);
-			}
+			// Work out min and max 1D points for both sprites
+			float min_sprite1, max_sprite1, min_sprite2, max_sprite2;
+			ProjectPoints(spriteAPoints, axisProj, min_sprite1, max_sprite1);
+			ProjectPoints(spriteBPoints, axisProj, min_sprite2, max_sprite2);
 
-			// Work out min and max 1D points for sprite 2
-			float min_sprite2 = INFINITY, max_sprite2 = -INFINITY;
-			for (unsigned int p = 0; p < spriteBPoints.size(); p++)
+			if (!(max_sprite2 >= min_sprite1 && max_sprite1 >= min_sprite2))
 			{
-				float q = (spriteBPoints[p].x * axisProj.x + spriteBPoints[p].y * axisProj.y);
-				min_sprite2 = std::min(min_sprite2, q);
-				max_sprite2 = std::max(max_sprite2, q);
+				separatingAxis = axisProj;
+				gap = std::max(min_sprite1 - max_sprite2, min_sprite2 - max_sprite1);
+				return false;
 			}
+		}
+	}
+
+	return true;
+}
 
+/* bool TestSATCollisionSpecialised
+ * Brief:
+ *	Dispatches to the SatTest specialisation matching the vertex counts of the
+ *	pair, falling back to the generic SAT test for any other shape.
+ */
+bool CollisionHandler::TestSATCollisionSpecialised(WireframeSprite& spriteA, WireframeSprite& spriteB)
+{
+	// bullets and the player are both triangles so share a specialisation
+	static_assert(Bullet::BULLET_VERTS == Player::PLAYER_VERTS, "bullet and player specialisations have diverged");
+	const unsigned int nAsteroidVerts = Asteroid::ASTEROID_VERTS;
+	const unsigned int nTriangleVerts = Bullet::BULLET_VERTS;
 
+	unsigned int nPointsA = spriteA.GetPointCount();
+	unsigned int nPointsB = spriteB.GetPointCount();
 
-			if (!(max_sprite2 >= min_sprite1 && max_sprite1 >= min_sprite2))
-				return false;
+	// asteroid vs asteroid
+	if (nPointsA == nAsteroidVerts && nPointsB == nAsteroidVerts)
+		return SatTest<nAsteroidVerts, nAsteroidVerts>::Test(spriteA, spriteB);
+
+	// asteroid vs bullet / player, always with the asteroid first
+	if (nPointsA == nAsteroidVerts && nPointsB == nTriangleVerts)
+		return SatTest<nAsteroidVerts, nTriangleVerts>::Test(spriteA, spriteB);
+	if (nPointsA == nTriangleVerts && nPointsB == nAsteroidVerts)
+		return SatTest<nAsteroidVerts, nTriangleVerts>::Test(spriteB, spriteA);
+
+	// triangle vs triangle
+	if (nPointsA == nTriangleVerts && nPointsB == nTriangleVerts)
+		return SatTest<nTriangleVerts, nTriangleVerts>::Test(spriteA, spriteB);
+
+	return TestSATCollision(spriteA, spriteB);
+}
+
+// Projects the points onto the axis and outputs the min and max 1D values
+void CollisionHandler::ProjectPoints(const PointSpan& points, const sf::Vector2f& axis, float& min, float& max)
+{
+	min = INFINITY;
+	max = -INFINITY;
+	for (unsigned int p = 0; p < points.size(); p++)
+	{
+		float q = (points[p].x * axis.x + points[p].y * axis.y);
+		min = std::min(min, q);
+		max = std::max(max, q);
+	}
+}
+
+/* bool TestSATCollisionCached
+ * Brief:
+ *	SAT test using the pair cache. If the pair was separated last frame and neither
+ *	sprite can have moved far enough to close the gap the narrow phase is skipped.
+ *	Otherwise the cached axis is tried first before falling back to the full test.
+ *	Separated pairs are stored in the cache for next frame.
+ */
+bool CollisionHandler::TestSATCollisionCached(WireframeSprite& spriteA, WireframeSprite& spriteB)
+{
+	// entries are always keyed with the lower id first
+	WireframeSprite* pSpriteA = &spriteA;
+	WireframeSprite* pSpriteB = &spriteB;
+	if (pSpriteA->GetId() > pSpriteB->GetId())
+		std::swap(pSpriteA, pSpriteB);
+
+	unsigned int idA = pSpriteA->GetId();
+	unsigned int idB = pSpriteB->GetId();
+
+	// the collision points are next frame's, so compare against next frame's position
+	sf::Vector2f positionA = pSpriteA->GetPosition() + pSpriteA->GetVelocity();
+	sf::Vector2f positionB = pSpriteB->GetPosition() + pSpriteB->GetVelocity();
+
+	const PairCache::Entry* cached = this->_pairCache.Find(idA, idB);
+	if (cached)
+	{
+		// furthest any point can have moved since the gap was measured, translation
+		// plus the arc travelled by the furthest point from rotating about the position
+		float moved = Length(positionA - cached->positionA) + Length(positionB - cached->positionB) +
+			cached->radiusA * AngleBetween(pSpriteA->GetRotation(), cached->rotationA) +
+			cached->radiusB * AngleBetween(pSpriteB->GetRotation(), cached->rotationB);
+
+		// can't have closed the gap, still separated. The entry is carried over
+		// unchanged so movement keeps being measured from when the gap was found
+		if (moved < cached->gap)
+		{
+			this->_pairCache.Store(idA, idB, *cached);
+			this->_nCacheSkipsThisFrame++;
+			return false;
+		}
+
+		// most likely still separated on the same axis so try that first
+		float minA, maxA, minB, maxB;
+		ProjectPoints(pSpriteA->GetPoints(), cached->axis, minA, maxA);
+		ProjectPoints(pSpriteB->GetPoints(), cached->axis, minB, maxB);
+
+		if (maxB < minA || maxA < minB)
+		{
+			PairCache::Entry entry = *cached;
+			entry.gap = std::max(minA - maxB, minB - maxA);
+			entry.positionA = positionA;
+			entry.positionB = positionB;
+			entry.rotationA = pSpriteA->GetRotation();
+			entry.rotationB = pSpriteB->GetRotation();
+			this->_pairCache.Store(idA, idB, entry);
+			return false;
 		}
 	}
 
-	return true;
+	// full test
+	PairCache::Entry entry;
+	if (TestSATSeparation(*pSpriteA, *pSpriteB, entry.axis, entry.gap))
+		return true;
+
+	// separated, remember the axis for next frame
+	entry.positionA = positionA;
+	entry.positionB = positionB;
+	entry.rotationA = pSpriteA->GetRotation();
+	entry.rotationB = pSpriteB->GetRotation();
+	entry.radiusA = BoundingRadius(*pSpriteA, positionA);
+	entry.radiusB = BoundingRadius(*pSpriteB, positionB);
+	this->_pairCache.Store(idA, idB, entry);
+
+	return false;
+}
+
+// Returns the length of the vector
+float CollisionHandler::Length(const sf::Vector2f& vector)
+{
+	return sqrtf(vector.x * vector.x + vector.y * vector.y);
+}
+
+// Returns the smallest angle in radians between two rotations given in degrees
+float CollisionHandler::AngleBetween(float degreesA, float degreesB)
+{
+	float difference = std::fabs(std::fmod(degreesA - degreesB, 360.0f));
+	if (difference > 180.0f)
+		difference = 360.0f - difference;
+
+	return difference * static_cast<float>(M_PI) / 180.0f;
+}
+
+// Returns the distance of the sprite's furthest point from the centre, shared shapes already know it
+float CollisionHandler::BoundingRadius(const WireframeSprite& sprite, const sf::Vector2f& centre)
+{
+	if (sprite.GetSharedShape())
+		return sprite.GetSharedShape()->boundingRadius;
+
+	PointSpan points = sprite.GetPoints();
+	float radius = 0.0f;
+	for (unsigned int p = 0; p < points.size(); p++)
+		radius = std::max(radius, Length(points[p] - centre));
+
+	return radius;
 }
 
 bool CollisionHandler::BypassNarrowTest(WireframeSprite& spriteA, WireframeSprite& spriteB)
@@ -1,7 +1,13 @@
 #pragma once
 #include <vector>
-#include <functional>
+#include <string>
+#include <utility>
+#include <atomic>
+#include <cmath>
 #include "SFML/Graphics.hpp"
+#include "PairCache.h"
+#include "BroadPhaseSelector.h"
+#include "../../GameObjects/Base/WireframeSprite.h"
 
 // pre definitions to keep header file size small
 class WireframeSprite;
@@ -10,25 +16,134 @@ class Bullet;
 class Player;
 class UniformGrid;
 class QuadTree;
+class SweepAndPrune;
+class DynamicAABBTree;
+class LinearQuadTree;
+class SpatialHashGrid;
+class HierarchicalGrid;
+class WorkerPool;
+class WrapGhosts;
+class CollisionHandler;
+
+/* struct CollisionContact
+ * Brief:
+ *	contact found by EPA for a colliding pair
+*/
+struct CollisionContact
+{
+	WireframeSprite* spriteA;
+	WireframeSprite* spriteB;
+	sf::Vector2f normal;				// unit normal pointing from A to B
+	float depth;						// distance A must move against the normal to separate
+};
+
+/* struct CollisionEvent
+ * Brief:
+ *	a colliding pair found by the detection pass. The pair is ordered so the
+ *	lower category comes first (lower id within a category), and the two
+ *	categories together give the type of collision. The ids are stable between
+ *	frames, the sprite pointers are only valid for the frame the event was raised.
+ *	A hit on a wrap ghost is reported against the ghost's owner, the tested
+ *	sprites keep the ghost so the contact can be worked out where they touched.
+*/
+struct CollisionEvent
+{
+	unsigned int idA;
+	unsigned int idB;
+	CollisionCategory categoryA;
+	CollisionCategory categoryB;
+	WireframeSprite* spriteA;
+	WireframeSprite* spriteB;
+	WireframeSprite* testedA;			// sprite the narrow phase tested in place of A, a wrap ghost or A itself
+	WireframeSprite* testedB;			// sprite the narrow phase tested in place of B, a wrap ghost or B itself
+};
+
+// Called once per frame with every collision event, after the responses have run
+typedef void(*CollisionEventListener)(void* context, const CollisionEvent* events, unsigned int count);
 
 struct CollisionPhaseData
 {
 	unsigned int nCollisions = 0;
 	unsigned int nCollisionTests = 0;
 	bool isPlayerColliding = false;
+	unsigned int nAllocations = 0;		// heap allocations made during the collision pass
+	unsigned int nCacheSkips = 0;		// narrow phase tests skipped by the pair cache
+	float collisionTime = 0.0f;			// seconds spent in the collision pass
+	const std::vector<CollisionContact>* contacts = nullptr;	// contacts found this frame, only filled by GJK with EPA enabled
+	const std::vector<CollisionEvent>* events = nullptr;		// every colliding pair found this frame
+};
+
+// Narrow phase test, a plain function pointer so passing it around never copies a std::function
+typedef bool(*NarrowPhaseTest)(WireframeSprite&, WireframeSprite&);
+
+/* struct ScratchArena
+ * Brief:
+ *	Per frame scratch containers used by the collision pass. They're cleared at
+ *	the start of every frame but keep their memory, so once they've grown to the
+ *	size of the scene the collision pass doesn't allocate.
+*/
+struct ScratchArena
+{
+	std::vector<std::pair<WireframeSprite*, WireframeSprite*>> broadPairs;	// pairs found by the pair based broad phases
+	std::vector<CollisionContact> contacts;									// contacts found by EPA
+	std::vector<CollisionEvent> events;										// colliding pairs found by the detection pass
+
+	// Empties every container without releasing memory
+	void Reset()
+	{
+		broadPairs.clear();
+		contacts.clear();
+		events.clear();
+	}
+};
+
+/* struct BulletSweep
+ * Brief:
+ *	State of one bullet's walk through the uniform grid
+*/
+struct BulletSweep
+{
+	CollisionHandler* handler;
+	Bullet* bullet;
+	sf::Vector2f start;					// bullet position this frame
+	sf::Vector2f end;					// bullet position next frame
+	WireframeSprite* hit = nullptr;		// nearest asteroid hit so far
+	float hitT = INFINITY;				// fraction of the segment where it hit
+};
+
+/* struct StripeResult
+ * Brief:
+ *	Output of one stripe of the parallel uniform grid. Written only by the
+ *	worker that claimed the stripe, read by the main thread once all are done.
+*/
+struct StripeResult
+{
+	std::vector<CollisionEvent> events;										// collision events in the order they were found
+	unsigned int nCollisionTests = 0;										// narrow phase tests run by the stripe
 };
 
 enum class NarrowCollisionMode
 {
 	AABB,
-	SEPERATED_AXIS_THEOREM
+	SEPERATED_AXIS_THEOREM,
+	SEPERATED_AXIS_THEOREM_SIMD,
+	SEPERATED_AXIS_THEOREM_SPECIALISED,
+	GJK
 };
 
 enum class BroadCollisionMode
 {
 	BRUTE_FORCE,
 	UNIFORM_GRID,
-	QUADTREE
+	QUADTREE,
+	SWEEP_AND_PRUNE,
+	AABB_TREE,
+	LINEAR_QUADTREE,
+	SPATIAL_HASH,
+	UNIFORM_GRID_CSR,
+	UNIFORM_GRID_PARALLEL,
+	HIERARCHICAL_GRID,
+	AUTO
 };
 
 class CollisionHandler
@@ -36,7 +151,8 @@ class CollisionHandler
 	// public methods
 public:
 	CollisionHandler(UniformGrid& grid, std::vector<Asteroid*>& asteroidContainer, std::vector<Bullet*>& bulletContainer,
-		Player& player, QuadTree* quadtree);
+		Player& player, QuadTree* quadtree, SweepAndPrune& sweepAndPrune, DynamicAABBTree& aabbTree, LinearQuadTree& linearQuadTree, SpatialHashGrid& spatialHashGrid,
+		HierarchicalGrid& hierarchicalGrid);
 	~CollisionHandler();
 
 	CollisionPhaseData HandleCollision();
@@ -44,28 +160,182 @@ public:
 	void TogglePlayerCollision() { this->_collidePlayer = !this->_collidePlayer; }
 	void ToggleBulletCollision() { this->_collideBullets = !this->_collideBullets; }
 	void ToggleAsteroidCollision() { this->_collideAsteroids = !this->_collideAsteroids; }
+	void TogglePairCache() { this->_usePairCache = !this->_usePairCache; }
+	void ToggleEPA() { this->_useEPA = !this->_useEPA; }
 
-	void SetBroadCollisionMode(BroadCollisionMode mode) { _broardCollisionMode = mode; }
+	/* void SetBroadCollisionMode
+	 * Brief:
+	 *	Sets the broad phase to run. AUTO hands the choice to the broad phase
+	 *	selector, which samples brute force, the uniform grid and the quadtree
+	 *	and keeps the cheapest. GetBroadCollisionMode always returns the mode
+	 *	actually running so the game knows which structure to maintain.
+	 * Params:
+	 *	<BroadCollisionMode> mode	-	mode to run
+	 */
+	void SetBroadCollisionMode(BroadCollisionMode mode);
 	void SetNarrowCollisionMode(NarrowCollisionMode mode) { _narrowCollisionMode = mode; }
 
 	void UpdateQuadTree(QuadTree* qt) { this->_quadTree = qt; }
+	void SetWrapGhosts(const WrapGhosts* wrapGhosts) { this->_wrapGhosts = wrapGhosts; }	// ghosts brute force tests the sprites against
+
+	/* void Subscribe
+	 * Brief:
+	 *	Registers a listener to be given the collision events at the end of every
+	 *	collision pass, once the responses have run
+	 * Params:
+	 *	<CollisionEventListener>	listener	-	function to call
+	 *	<void*>						context		-	passed through to the listener
+	 */
+	void Subscribe(CollisionEventListener listener, void* context);
+
+	// Removes a listener registered with the same function and context
+	void Unsubscribe(CollisionEventListener listener, void* context);
+
+	// Returns the events raised by the last collision pass
+	const std::vector<CollisionEvent>& GetEvents() const { return this->_scratch.events; }
 
 	BroadCollisionMode GetBroadCollisionMode() const { return this->_broardCollisionMode; }
+	bool IsAutoBroadPhase() const { return this->_autoBroadPhase; }
+
+	/* void UpdateAutoBroadPhase
+	 * Brief:
+	 *	Feeds the cost of this frame to the broad phase selector when AUTO is set,
+	 *	which may change the broad phase for the next frame. Brute force is skipped
+	 *	while sampling if it would run far more tests than the current mode.
+	 * Params:
+	 *	<float>						maintenanceTime	-	seconds spent updating the active structure this frame
+	 *	<const CollisionPhaseData&>	data			-	results of this frame's collision pass
+	 */
+	void UpdateAutoBroadPhase(float maintenanceTime, const CollisionPhaseData& data);
+
+	// Returns a display name for the active broad phase mode (used by the collision info)
+	std::string GetBroadCollisionModeName() const;
+
+	// Returns a display name for the active narrow phase mode (used by the collision info)
+	std::string GetNarrowCollisionModeName() const;
 
 	// private methods
 private:
-	void HandleBroadPhaseBruteForce(std::function<bool(WireframeSprite&, WireframeSprite&)> collisionAlgorithm, bool& isPlayerColliding);
-	void HandleBroadPhaseUniformGrid(std::function<bool(WireframeSprite&, WireframeSprite&)> collisionAlgorithm, bool& isPlayerColliding);
-	void HandleBroadPhaseQuadtree(std::function<bool(WireframeSprite&, WireframeSprite&)> collisionAlgorithm, bool& isPlayerColliding);
+	// Returns a display name for a broad phase mode
+	static std::string GetBroadCollisionModeName(BroadCollisionMode mode);
+
+	void HandleBroadPhaseBruteForce(NarrowPhaseTest collisionAlgorithm);
+	void HandleBroadPhaseUniformGrid(NarrowPhaseTest collisionAlgorithm);
+	void HandleBroadPhaseQuadtree(NarrowPhaseTest collisionAlgorithm);
+	void HandleBroadPhaseSweepAndPrune(NarrowPhaseTest collisionAlgorithm);
+	void HandleBroadPhaseAABBTree(NarrowPhaseTest collisionAlgorithm);
+	void HandleBroadPhaseLinearQuadTree(NarrowPhaseTest collisionAlgorithm);
+	void HandleBroadPhaseSpatialHashGrid(NarrowPhaseTest collisionAlgorithm);
+	void HandleBroadPhaseUniformGridCSR(NarrowPhaseTest collisionAlgorithm);
+	void HandleBroadPhaseHierarchicalGrid(NarrowPhaseTest collisionAlgorithm);
 
-	void CheckCollision(std::function<bool(WireframeSprite&, WireframeSprite&)> collisionAlgorithm,
-		WireframeSprite* spriteA, std::vector<WireframeSprite*>& spritesToCheck, unsigned int startingIndex, bool& isPlayerColliding);
+	/* void HandleBroadPhaseUniformGridParallel
+	 * Brief:
+	 *	Splits the grid cells, in row major order, into stripes claimed by the
+	 *	workers of the pool. Each stripe records its collision events in its own
+	 *	buffer, the buffers are then merged on the calling thread in stripe order.
+	 */
+	void HandleBroadPhaseUniformGridParallel(NarrowPhaseTest collisionAlgorithm);
+
+	/* void HandleBulletSweeps
+	 * Brief:
+	 *	Bullets aren't stored in the uniform grid. Each bullet is treated as the
+	 *	segment it travels along this frame and walked through the grid cells
+	 *	with a DDA, testing the asteroids around each cell. The walk ends at the
+	 *	first asteroid hit, so fast bullets can't pass through small asteroids.
+	 *	The cells are walked by the grid's segment query, the CSR copy by a
+	 *	visitor of its own as the query only reads the cells.
+	 * Params:
+	 *	<bool>	useCSR	-	read the CSR copy of the grid rather than the cells
+	 */
+	void HandleBulletSweeps(bool useCSR);
+
+	// Segment query callback for a bullet sweep, stops at the first asteroid the bullet can hit
+	static bool BulletSweepHit(void* context, WireframeSprite* sprite, float distance);
+
+	// Grid visitor for a bullet sweep over the CSR copy, tests the asteroids around the cell
+	static bool BulletSweepVisitor(void* context, int x, int y, float tEnter, float tExit);
+
+	// Worker job for the parallel grid, claims stripes until none are left
+	static void UniformGridStripeJob(void* context, unsigned int workerIndex);
+
+	// Runs the broad and narrow phase over every cell of a stripe, recording the colliding pairs
+	void ProcessUniformGridStripe(unsigned int stripe);
+
+	// Thread safe version of CheckCollision, records events in the stripe's buffer
+	void CheckCollisionStripe(WireframeSprite* spriteA, const std::vector<WireframeSprite*>& spritesToCheck,
+		unsigned int startingIndex, StripeResult& result);
+
+	void CheckCollision(NarrowPhaseTest collisionAlgorithm,
+		WireframeSprite* spriteA, std::vector<WireframeSprite*>& spritesToCheck, unsigned int startingIndex);
+
+	// Overload taking a contiguous range of sprites (CSR grid cells)
+	void CheckCollision(NarrowPhaseTest collisionAlgorithm,
+		WireframeSprite* spriteA, WireframeSprite* const* spritesToCheck, unsigned int count);
+
+	// Response to a colliding pair, sprite A always has the lower category
+	typedef void (CollisionHandler::*CollisionResponse)(WireframeSprite* spriteA, WireframeSprite* spriteB, bool& isPlayerColliding);
+
+	// Builds the event for a colliding pair, ordering the pair. Thread safe
+	static CollisionEvent MakeEvent(WireframeSprite* spriteA, WireframeSprite* spriteB);
+
+	// Orders events by pair so duplicates sit next to each other
+	static bool EventPairLess(const CollisionEvent& a, const CollisionEvent& b);
+	static bool EventPairEqual(const CollisionEvent& a, const CollisionEvent& b);
+
+	// Records the event for a colliding pair, detection never responds directly
+	void RaiseEvent(WireframeSprite* spriteA, WireframeSprite* spriteB) { this->_scratch.events.push_back(MakeEvent(spriteA, spriteB)); }
+
+	/* void RespondToEvents
+	 * Brief:
+	 *	Runs once detection has finished. Removes duplicate pairs (a pair can be
+	 *	found by more than one cell or node), then looks up and runs the response
+	 *	for each event and records the EPA contacts.
+	 * Params:
+	 *	<bool&>	isPlayerColliding	-	set if the player hit an asteroid
+	 */
+	void RespondToEvents(bool& isPlayerColliding);
+
+	// Runs EPA on the sprites tested for a colliding pair and stores the contact for this frame
+	void RecordContact(const CollisionEvent& collisionEvent);
+
+	// Collision responses, indexed through the response table
+	void RespondPlayerAsteroid(WireframeSprite* player, WireframeSprite* asteroid, bool& isPlayerColliding);
+	void RespondAsteroidAsteroid(WireframeSprite* asteroidA, WireframeSprite* asteroidB, bool& isPlayerColliding);
+	void RespondAsteroidBullet(WireframeSprite* asteroid, WireframeSprite* bullet, bool& isPlayerColliding);
+
+	// Runs the narrow phase on a single pair and raises an event if they collide
+	void CheckCollisionPair(NarrowPhaseTest collisionAlgorithm,
+		WireframeSprite* spriteA, WireframeSprite* spriteB);
 
 	// narrow phase algorithms
 	static bool AABBCollision(WireframeSprite& spriteA, WireframeSprite& spriteB);
 	static bool TestSATCollision(WireframeSprite& spriteA, WireframeSprite& spriteB);
+	static bool TestSATSeparation(WireframeSprite& spriteA, WireframeSprite& spriteB, sf::Vector2f& separatingAxis, float& gap);
+
+	/* bool TestSATCollisionSpecialised
+	 * Brief:
+	 *	Dispatches to the SatTest specialisation matching the vertex counts of the
+	 *	pair, falling back to the generic SAT test for any other shape.
+	 */
+	static bool TestSATCollisionSpecialised(WireframeSprite& spriteA, WireframeSprite& spriteB);
 	static bool BypassNarrowTest(WireframeSprite& spriteA, WireframeSprite& spriteB);
 
+	/* bool TestSATCollisionCached
+	 * Brief:
+	 *	SAT test using the pair cache. If the pair was separated last frame and neither
+	 *	sprite can have moved far enough to close the gap the narrow phase is skipped.
+	 *	Otherwise the cached axis is tried first before falling back to the full test.
+	 *	Separated pairs are stored in the cache for next frame.
+	 */
+	bool TestSATCollisionCached(WireframeSprite& spriteA, WireframeSprite& spriteB);
+
+	// Helpers for the narrow phase
+	static void ProjectPoints(const PointSpan& points, const sf::Vector2f& axis, float& min, float& max);
+	static float Length(const sf::Vector2f& vector);
+	static float AngleBetween(float degreesA, float degreesB);
+	static float BoundingRadius(const WireframeSprite& sprite, const sf::Vector2f& centre);
+
 	// private members
 private:
 	// Collision mode options
@@ -76,19 +346,54 @@ private:
 	bool _collidePlayer = true;						// Should tests for collision with the player be performed (godmode)
 	bool _collideAsteroids = true;					// Should collision between asteroids be performed
 	bool _collideBullets = true;					// should the bullets collide with the asteroids
+	bool _usePairCache = true;						// should separated pairs be cached between frames
+	bool _useEPA = false;							// should GJK collisions run EPA for a contact
+
+	// Adaptive broad phase
+	bool _autoBroadPhase = false;					// is the broad phase picked by the selector
+	BroadPhaseSelector _broadPhaseSelector{ AUTO_CANDIDATE_COUNT };
 
 	// Collision counters
-	unsigned int _nCollisionsThisFrame = 0;			// Amount of collisions on the current frame
 	unsigned int _nCollisionTestsThisFrame = 0;		// Amount of collision tests performed on the current frame
+	unsigned int _nCacheSkipsThisFrame = 0;			// Amount of narrow phase tests skipped by the pair cache
 
 	// game object container references
 	std::vector<Asteroid*>& _asteroids;				// references to all the asteroids in the game
 	std::vector<Bullet*>& _bullets;					// reference to all the bullets in the game
 	UniformGrid& _grid;
 	QuadTree* _quadTree;
+	SweepAndPrune& _sweepAndPrune;
+	DynamicAABBTree& _aabbTree;
+	LinearQuadTree& _linearQuadTree;
+	SpatialHashGrid& _spatialHashGrid;
+	HierarchicalGrid& _hierarchicalGrid;
 	Player& _player;								// reference to the player object
+	const WrapGhosts* _wrapGhosts = nullptr;		// ghosts of the sprites over a screen edge, read by brute force
+
+	// Scratch containers reused every frame
+	ScratchArena _scratch;
+
+	// Listeners given the events at the end of every collision pass
+	std::vector<std::pair<CollisionEventListener, void*>> _listeners;
+
+	// Collision response for each pair of categories, only filled where A <= B
+	CollisionResponse _responses[static_cast<int>(CollisionCategory::COUNT)][static_cast<int>(CollisionCategory::COUNT)] = {};
+
+	// Separating axes of the pairs separated last frame
+	PairCache _pairCache;
+
+	// Parallel uniform grid
+	WorkerPool* _workerPool = nullptr;				// Created the first time the parallel grid runs
+	std::vector<StripeResult> _stripeResults;		// Output of each stripe, reused between frames
+	std::atomic<unsigned int> _nextStripe{ 0 };		// Next stripe to be claimed by a worker
+	unsigned int _nStripes = 0;						// Number of stripes this frame
+	NarrowPhaseTest _stripeNarrowTest = nullptr;	// Narrow phase used by the workers this frame
 
 	// constants
 	sf::Color ASTEROID_COLLISION_COLOR = sf::Color::Green;
+	static constexpr unsigned int STRIPES_PER_WORKER = 4;	// More stripes than workers so fast workers can take on more
+	static constexpr unsigned int AUTO_CANDIDATE_COUNT = 3;	// Broad phases the selector picks between
+	static const BroadCollisionMode AUTO_CANDIDATES[AUTO_CANDIDATE_COUNT];
+	static constexpr unsigned int BRUTE_FORCE_SAMPLE_LIMIT = 20;	// Brute force isn't sampled if it would run this many times the tests
 };
 
@@ -0,0 +1,236 @@
+#include "GJK.h"
+#include "../../GameObjects/Base/WireframeSprite.h"
+#include <cmath>
+
+namespace
+{
+	constexpr unsigned int GJK_MAX_ITERATIONS = 32;		// Stops degenerate cases looping forever
+	constexpr unsigned int EPA_MAX_ITERATIONS = 32;		// Each iteration adds one point to the polytope
+	constexpr unsigned int EPA_MAX_POINTS = 3 + EPA_MAX_ITERATIONS;
+	constexpr float EPA_TOLERANCE = 0.001f;				// Stop once the closest edge moves less than this
+
+	float Dot(const sf::Vector2f& a, const sf::Vector2f& b) { return a.x * b.x + a.y * b.y; }
+	float Cross(const sf::Vector2f& a, const sf::Vector2f& b) { return a.x * b.y - a.y * b.x; }
+
+	// Returns (a x b) x c, used to get the perpendicular of a pointing towards b
+	sf::Vector2f TripleProduct(const sf::Vector2f& a, const sf::Vector2f& b, const sf::Vector2f& c)
+	{
+		return b * Dot(a, c) - a * Dot(b, c);
+	}
+
+	// Returns the point of the sprite furthest along the direction
+	sf::Vector2f Support(const WireframeSprite& sprite, const sf::Vector2f& direction)
+	{
+		PointSpan points = sprite.GetPoints();
+
+		unsigned int best = 0;
+		float bestDistance = Dot(points[0], direction);
+		for (unsigned int i = 1; i < points.size(); i++)
+		{
+			float distance = Dot(points[i], direction);
+			if (distance > bestDistance)
+			{
+				bestDistance = distance;
+				best = i;
+			}
+		}
+
+		return points[best];
+	}
+
+	// Returns the point of the Minkowski difference A - B furthest along the direction
+	sf::Vector2f Support(const WireframeSprite& spriteA, const WireframeSprite& spriteB, const sf::Vector2f& direction)
+	{
+		return Support(spriteA, direction) - Support(spriteB, -direction);
+	}
+
+	/* bool UpdateSimplex
+	* Brief:
+	*	Removes the points of the simplex that aren't nearest the origin and
+	*	picks the next search direction
+	* Returns:
+	*	<bool>	-	true if the simplex encloses the origin
+	*/
+	bool UpdateSimplex(GJK::Simplex& simplex, sf::Vector2f& direction)
+	{
+		sf::Vector2f a = simplex.points[simplex.count - 1];
+		sf::Vector2f ao = -a;
+
+		if (simplex.count == 2)
+		{
+			sf::Vector2f ab = simplex.points[0] - a;
+			direction = TripleProduct(ab, ao, ab);
+
+			// origin lies on the segment, the shapes are touching
+			if (Dot(direction, direction) == 0.0f)
+				return true;
+
+			return false;
+		}
+
+		// triangle, test the two edges that include the newest point
+		sf::Vector2f b = simplex.points[1];
+		sf::Vector2f c = simplex.points[0];
+		sf::Vector2f ab = b - a;
+		sf::Vector2f ac = c - a;
+
+		sf::Vector2f abPerp = TripleProduct(ac, ab, ab);
+		if (Dot(abPerp, ao) > 0.0f)
+		{
+			// origin is outside ab, drop c
+			simplex.points[0] = b;
+			simplex.points[1] = a;
+			simplex.count = 2;
+			direction = abPerp;
+			return false;
+		}
+
+		sf::Vector2f acPerp = TripleProduct(ab, ac, ac);
+		if (Dot(acPerp, ao) > 0.0f)
+		{
+			// origin is outside ac, drop b
+			simplex.points[1] = a;
+			simplex.count = 2;
+			direction = acPerp;
+			return false;
+		}
+
+		return true;
+	}
+}
+
+/* bool TestCollision
+* Brief:
+*	Returns true if the sprites overlap. Matches the signature of the other
+*	narrow phase tests.
+* Params:
+*	<WireframeSprite&> spriteA	-	first sprite
+*	<WireframeSprite&> spriteB	-	second sprite
+*/
+bool GJK::TestCollision(WireframeSprite& spriteA, WireframeSprite& spriteB)
+{
+	Simplex simplex;
+	return TestCollision(spriteA, spriteB, simplex);
+}
+
+/* bool TestCollision
+* Brief:
+*	Overload that also outputs the simplex the test finished with, which
+*	encloses the origin when the sprites overlap
+* Params:
+*	<const WireframeSprite&>	spriteA		-	first sprite
+*	<const WireframeSprite&>	spriteB		-	second sprite
+*	<Simplex&>					simplex		-	set to the final simplex
+*/
+bool GJK::TestCollision(const WireframeSprite& spriteA, const WireframeSprite& spriteB, Simplex& simplex)
+{
+	// start searching from B towards A
+	sf::Vector2f direction = spriteA.GetPosition() - spriteB.GetPosition();
+	if (Dot(direction, direction) == 0.0f)
+		direction = { 1.0f, 0.0f };
+
+	simplex.points[0] = Support(spriteA, spriteB, direction);
+	simplex.count = 1;
+	direction = -simplex.points[0];
+
+	// first point is the origin, the shapes are touching
+	if (Dot(direction, direction) == 0.0f)
+		return true;
+
+	for (unsigned int i = 0; i < GJK_MAX_ITERATIONS; i++)
+	{
+		sf::Vector2f point = Support(spriteA, spriteB, direction);
+
+		// the furthest point in the direction of the origin didn't pass it
+		if (Dot(point, direction) < 0.0f)
+			return false;
+
+		simplex.points[simplex.count++] = point;
+		if (UpdateSimplex(simplex, direction))
+			return true;
+	}
+
+	// didn't converge, only happens for touching shapes so treat as overlapping
+	return true;
+}
+
+/* bool FindContact
+* Brief:
+*	Runs GJK then EPA on an overlapping pair
+* Params:
+*	<const WireframeSprite&>	spriteA		-	first sprite
+*	<const WireframeSprite&>	spriteB		-	second sprite
+*	<sf::Vector2f&>				normal		-	set to the unit contact normal, pointing from A to B
+*	<float&>					depth		-	set to the distance A must move against the normal to separate
+* Returns:
+*	<bool>	-	false if the sprites don't overlap, the outputs are left unchanged
+*/
+bool GJK::FindContact(const WireframeSprite& spriteA, const WireframeSprite& spriteB, sf::Vector2f& normal, float& depth)
+{
+	Simplex simplex;
+	if (!TestCollision(spriteA, spriteB, simplex))
+		return false;
+
+	// only touching, no area to expand so there's no depth
+	if (simplex.count < 3)
+	{
+		sf::Vector2f direction = spriteB.GetPosition() - spriteA.GetPosition();
+		float length = std::sqrt(Dot(direction, direction));
+		normal = length > 0.0f ? direction / length : sf::Vector2f(1.0f, 0.0f);
+		depth = 0.0f;
+		return true;
+	}
+
+	// polytope on the stack so the pass never allocates
+	sf::Vector2f polytope[EPA_MAX_POINTS];
+	unsigned int nPoints = 3;
+	for (unsigned int i = 0; i < 3; i++)
+		polytope[i] = simplex.points[i];
+
+	// outward normals depend on the winding of the simplex
+	bool isCounterClockwise = Cross(polytope[1] - polytope[0], polytope[2] - polytope[0]) > 0.0f;
+
+	sf::Vector2f edgeNormal;
+	float edgeDistance = 0.0f;
+
+	for (unsigned int iteration = 0; ; iteration++)
+	{
+		// find the edge closest to the origin
+		unsigned int closestEdge = 0;
+		edgeDistance = INFINITY;
+		for (unsigned int i = 0; i < nPoints; i++)
+		{
+			sf::Vector2f edge = polytope[(i + 1) % nPoints] - polytope[i];
+			sf::Vector2f outward = isCounterClockwise ? sf::Vector2f(edge.y, -edge.x) : sf::Vector2f(-edge.y, edge.x);
+			float length = std::sqrt(Dot(outward, outward));
+			if (length == 0.0f)
+				continue;
+
+			outward /= length;
+			float distance = Dot(outward, polytope[i]);
+			if (distance < edgeDistance)
+			{
+				edgeDistance = distance;
+				edgeNormal = outward;
+				closestEdge = i;
+			}
+		}
+
+		// stop once the difference can't be expanded past the closest edge
+		sf::Vector2f point = Support(spriteA, spriteB, edgeNormal);
+		if (Dot(point, edgeNormal) - edgeDistance < EPA_TOLERANCE || iteration == EPA_MAX_ITERATIONS || nPoints == EPA_MAX_POINTS)
+			break;
+
+		// insert the new point between the ends of the closest edge
+		for (unsigned int i = nPoints; i > closestEdge + 1; i--)
+			polytope[i] = polytope[i - 1];
+		polytope[closestEdge + 1] = point;
+		nPoints++;
+	}
+
+	// the closest edge of A - B faces the same way as B from A, moving A back
+	// along it by the depth separates the pair
+	normal = edgeNormal;
+	depth = edgeDistance;
+	return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "SFML/Graphics.hpp"
+
+// class pre-definitions to save header space
+class WireframeSprite;
+
+/* namespace GJK
+ *	Gilbert-Johnson-Keerthi intersection test and the Expanding Polytope
+ *	Algorithm for convex sprites. Both work on the Minkowski difference of the
+ *	two shapes through a support function, so they only touch the vertices
+ *	furthest along each search direction. The sprites overlap if the difference
+ *	contains the origin. EPA then expands the final simplex to find the edge of
+ *	the difference closest to the origin, which gives the contact normal and
+ *	the penetration depth.
+*/
+namespace GJK
+{
+	/* struct Simplex
+	 * Brief:
+	 *	up to three points of the Minkowski difference, the last added point is
+	 *	always at the back
+	*/
+	struct Simplex
+	{
+		sf::Vector2f points[3];
+		unsigned int count = 0;
+	};
+
+	/* bool TestCollision
+	* Brief:
+	*	Returns true if the sprites overlap. Matches the signature of the other
+	*	narrow phase tests.
+	* Params:
+	*	<WireframeSprite&> spriteA	-	first sprite
+	*	<WireframeSprite&> spriteB	-	second sprite
+	*/
+	bool TestCollision(WireframeSprite& spriteA, WireframeSprite& spriteB);
+
+	/* bool TestCollision
+	* Brief:
+	*	Overload that also outputs the simplex the test finished with, which
+	*	encloses the origin when the sprites overlap
+	* Params:
+	*	<const WireframeSprite&>	spriteA		-	first sprite
+	*	<const WireframeSprite&>	spriteB		-	second sprite
+	*	<Simplex&>					simplex		-	set to the final simplex
+	*/
+	bool TestCollision(const WireframeSprite& spriteA, const WireframeSprite& spriteB, Simplex& simplex);
+
+	/* bool FindContact
+	* Brief:
+	*	Runs GJK then EPA on an overlapping pair
+	* Params:
+	*	<const WireframeSprite&>	spriteA		-	first sprite
+	*	<const WireframeSprite&>	spriteB		-	second sprite
+	*	<sf::Vector2f&>				normal		-	set to the unit contact normal, pointing from A to B
+	*	<float&>					depth		-	set to the distance A must move against the normal to separate
+	* Returns:
+	*	<bool>	-	false if the sprites don't overlap, the outputs are left unchanged
+	*/
+	bool FindContact(const WireframeSprite& spriteA, const WireframeSprite& spriteB, sf::Vector2f& normal, float& depth);
+}
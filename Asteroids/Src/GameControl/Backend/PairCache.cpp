@@ -0,0 +1,119 @@
+#include "PairCache.h"
+#include <utility>
+
+PairCache::PairCache()
+{
+	this->_previous.slots.resize(INITIAL_SLOTS);
+	this->_current.slots.resize(INITIAL_SLOTS);
+	this->_current.stamp = this->_frame;
+}
+
+PairCache::~PairCache(){}
+
+/* void BeginFrame
+* Brief:
+*	Makes this frame's entries the ones read by Find and empties the table
+*	that this frame's results are written to. Tables are emptied by a stamp
+*	so no memory is touched.
+*/
+void PairCache::BeginFrame()
+{
+	// last frame's results become the ones to read from
+	std::swap(this->_previous, this->_current);
+
+	// the old previous table is reused, a new stamp empties it
+	this->_frame++;
+	this->_current.stamp = this->_frame;
+	this->_current.count = 0;
+
+	// keep both tables the same size so a busy frame doesn't grow again next frame
+	while (this->_current.slots.size() < this->_previous.slots.size())
+		Grow(this->_current);
+}
+
+/* const Entry* Find
+* Brief:
+*	Looks up the entry stored for the pair last frame
+* Params:
+*	<unsigned int>	idA		-	lower id of the pair
+*	<unsigned int>	idB		-	higher id of the pair
+* Returns:
+*	<const Entry*>	-	the entry or nullptr if the pair wasn't separated last frame
+*/
+const PairCache::Entry* PairCache::Find(unsigned int idA, unsigned int idB) const
+{
+	const Table& table = this->_previous;
+	uint64_t key = MakeKey(idA, idB);
+	uint32_t mask = static_cast<uint32_t>(table.slots.size() - 1);
+
+	for (uint32_t index = Hash(key, table); table.slots[index].stamp == table.stamp; index = (index + 1) & mask)
+	{
+		if (table.slots[index].key == key)
+			return &table.slots[index].entry;
+	}
+
+	return nullptr;
+}
+
+/* void Store
+* Brief:
+*	Records the separated pair for next frame
+* Params:
+*	<unsigned int>	idA		-	lower id of the pair
+*	<unsigned int>	idB		-	higher id of the pair
+*	<const Entry&>	entry	-	state of the pair
+*/
+void PairCache::Store(unsigned int idA, unsigned int idB, const Entry& entry)
+{
+	Table& table = this->_current;
+
+	// keep the load under a half so probe sequences stay short
+	if ((table.count + 1) * 2 > table.slots.size())
+		Grow(table);
+
+	uint64_t key = MakeKey(idA, idB);
+	uint32_t mask = static_cast<uint32_t>(table.slots.size() - 1);
+	uint32_t index = Hash(key, table);
+
+	// find the pair or the first empty slot
+	while (table.slots[index].stamp == table.stamp && table.slots[index].key != key)
+		index = (index + 1) & mask;
+
+	Slot& slot = table.slots[index];
+	if (slot.stamp != table.stamp)
+		table.count++;
+
+	slot.key = key;
+	slot.stamp = table.stamp;
+	slot.entry = entry;
+}
+
+// Hashes a key into a slot index of the table
+uint32_t PairCache::Hash(uint64_t key, const Table& table)
+{
+	// 64 bit mix so pairs sharing one id still spread over the table
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	return static_cast<uint32_t>(key) & static_cast<uint32_t>(table.slots.size() - 1);
+}
+
+// Doubles the size of the table, keeping its entries
+void PairCache::Grow(Table& table)
+{
+	std::vector<Slot> oldSlots(table.slots.size() * 2);
+	oldSlots.swap(table.slots);
+
+	uint32_t mask = static_cast<uint32_t>(table.slots.size() - 1);
+	for (unsigned int i = 0; i < oldSlots.size(); i++)
+	{
+		if (oldSlots[i].stamp != table.stamp)
+			continue;
+
+		uint32_t index = Hash(oldSlots[i].key, table);
+		while (table.slots[index].stamp == table.stamp)
+			index = (index + 1) & mask;
+
+		table.slots[index] = oldSlots[i];
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "SFML/Graphics.hpp"
+
+/* class PairCache
+ *	Remembers, for every pair of sprites found separated by the narrow phase,
+ *	the axis that separated them and the size of the gap along it. Entries are
+ *	keyed by the ids of both sprites and only live for one frame: lookups read
+ *	last frame's table while this frame's results are written to a second table,
+ *	the two are swapped at the start of every frame. Pairs that stop being tested
+ *	simply drop out without needing to be removed.
+*/
+class PairCache
+{
+	// Public structures
+public:
+	/* struct Entry
+	 * Brief:
+	 *	State of a separated pair when it was last tested. Sprite A is always
+	 *	the one with the lower id.
+	*/
+	struct Entry
+	{
+		sf::Vector2f axis;					// unit axis the pair was separated on (world space)
+		float gap = 0.0f;					// distance between the projections along the axis
+		sf::Vector2f positionA;				// position of sprite A when tested
+		sf::Vector2f positionB;				// position of sprite B when tested
+		float rotationA = 0.0f;				// rotation of sprite A in degrees when tested
+		float rotationB = 0.0f;				// rotation of sprite B in degrees when tested
+		float radiusA = 0.0f;				// furthest point of sprite A from its position
+		float radiusB = 0.0f;				// furthest point of sprite B from its position
+	};
+
+	// Public interface
+public:
+	PairCache();
+	~PairCache();
+
+	/* void BeginFrame
+	* Brief:
+	*	Makes this frame's entries the ones read by Find and empties the table
+	*	that this frame's results are written to. Tables are emptied by a stamp
+	*	so no memory is touched.
+	*/
+	void BeginFrame();
+
+	/* const Entry* Find
+	* Brief:
+	*	Looks up the entry stored for the pair last frame
+	* Params:
+	*	<unsigned int>	idA		-	lower id of the pair
+	*	<unsigned int>	idB		-	higher id of the pair
+	* Returns:
+	*	<const Entry*>	-	the entry or nullptr if the pair wasn't separated last frame
+	*/
+	const Entry* Find(unsigned int idA, unsigned int idB) const;
+
+	/* void Store
+	* Brief:
+	*	Records the separated pair for next frame
+	* Params:
+	*	<unsigned int>	idA		-	lower id of the pair
+	*	<unsigned int>	idB		-	higher id of the pair
+	*	<const Entry&>	entry	-	state of the pair
+	*/
+	void Store(unsigned int idA, unsigned int idB, const Entry& entry);
+
+	// Private structures
+private:
+	/* struct Slot
+	 * Brief:
+	 *	slot of a table, empty unless the stamp matches the table's stamp
+	*/
+	struct Slot
+	{
+		uint64_t key = 0;					// both ids packed together
+		uint32_t stamp = 0;					// frame the slot was written
+		Entry entry;
+	};
+
+	/* struct Table
+	 * Brief:
+	 *	open addressing table with linear probing, size is always a power of two
+	*/
+	struct Table
+	{
+		std::vector<Slot> slots;
+		uint32_t stamp = 0;					// slots with any other stamp are empty
+		unsigned int count = 0;				// number of slots in use
+	};
+
+	// Private methods for internal use
+private:
+	// Packs both ids into one key
+	static uint64_t MakeKey(unsigned int idA, unsigned int idB) { return (static_cast<uint64_t>(idA) << 32) | idB; }
+
+	// Hashes a key into a slot index of the table
+	static uint32_t Hash(uint64_t key, const Table& table);
+
+	// Doubles the size of the table, keeping its entries
+	static void Grow(Table& table);
+
+	// Members
+private:
+	Table _previous;						// entries written last frame, read by Find
+	Table _current;							// entries written this frame
+	uint32_t _frame = 1;					// stamp given to the current table
+
+	// constants
+	static constexpr unsigned int INITIAL_SLOTS = 1024;	// Number of slots each table starts with
+};
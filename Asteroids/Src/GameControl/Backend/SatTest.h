@@ -0,0 +1,70 @@
+#pragma once
+#include <cmath>
+#include "SFML/Graphics.hpp"
+#include "../../GameObjects/Base/WireframeSprite.h"
+
+/* struct SatTest
+ *	Separating axis test specialised on the vertex count of both shapes, so every
+ *	loop has a fixed trip count the compiler can unroll. The shapes are rigid, so
+ *	instead of rebuilding and normalising the edge normals from the world points
+ *	each test, the unit normals cached in local space are rotated into world
+ *	space by the sine and cosine the sprite's points were built with.
+ *	Projections use the packed world points of both sprites.
+ * Template params:
+ *	<unsigned int> NA	-	number of vertices of sprite A
+ *	<unsigned int> NB	-	number of vertices of sprite B
+*/
+template<unsigned int NA, unsigned int NB>
+struct SatTest
+{
+	/* bool Test
+	* Brief:
+	*	Returns true if no edge normal of either sprite separates them. The point
+	*	counts of the sprites must match the template parameters.
+	* Params:
+	*	<WireframeSprite&> spriteA	-	sprite with NA vertices
+	*	<WireframeSprite&> spriteB	-	sprite with NB vertices
+	*/
+	static bool Test(WireframeSprite& spriteA, WireframeSprite& spriteB)
+	{
+		return !IsSeparatedByNormalsOf<NA, NB>(spriteA, spriteB) && !IsSeparatedByNormalsOf<NB, NA>(spriteB, spriteA);
+	}
+
+private:
+	// Tests the NOwner world space normals of the owner against both shapes
+	template<unsigned int NOwner, unsigned int NOther>
+	static bool IsSeparatedByNormalsOf(const WireframeSprite& owner, const WireframeSprite& other)
+	{
+		const sf::Vector2f* localNormals = owner.GetLocalNormals().data();
+		float s = owner.GetRotationSin();
+		float c = owner.GetRotationCos();
+
+		for (unsigned int i = 0; i < NOwner; i++)
+		{
+			// rotate the cached normal into world space, it stays unit length
+			sf::Vector2f axis(localNormals[i].x * c - localNormals[i].y * s, localNormals[i].x * s + localNormals[i].y * c);
+
+			float minOwner, maxOwner, minOther, maxOther;
+			Project<NOwner>(owner.GetPackedPointsX(), owner.GetPackedPointsY(), axis, minOwner, maxOwner);
+			Project<NOther>(other.GetPackedPointsX(), other.GetPackedPointsY(), axis, minOther, maxOther);
+
+			if (maxOther < minOwner || maxOwner < minOther)
+				return true;
+		}
+
+		return false;
+	}
+
+	// Projects N packed points onto the axis and outputs the min and max 1D values
+	template<unsigned int N>
+	static void Project(const float* x, const float* y, const sf::Vector2f& axis, float& min, float& max)
+	{
+		min = max = x[0] * axis.x + y[0] * axis.y;
+		for (unsigned int p = 1; p < N; p++)
+		{
+			float q = x[p] * axis.x + y[p] * axis.y;
+			min = q < min ? q : min;
+			max = q > max ? q : max;
+		}
+	}
+};
@@ -0,0 +1,148 @@
+#include "SimdSAT.h"
+#include "../../GameObjects/Base/WireframeSprite.h"
+#include <cmath>
+
+// pick the widest instruction set the compiler is targeting
+#if defined(__AVX2__)
+#define SIMD_SAT_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SAT_SSE
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	/* bool IsSeparatedByEdgesOf
+	* Brief:
+	*	Tests the edge normals of the owner against both shapes. The packed points
+	*	repeat the first point after the last one, so edge i is always point i + 1
+	*	minus point i, and the padding lanes give zero length normals that can
+	*	never separate anything.
+	* Params:
+	*	<const WireframeSprite&> owner	-	sprite whose edges give the axes
+	*	<const WireframeSprite&> other	-	sprite tested against them
+	*/
+	bool IsSeparatedByEdgesOf(const WireframeSprite& owner, const WireframeSprite& other)
+	{
+		const float* ownerX = owner.GetPackedPointsX();
+		const float* ownerY = owner.GetPackedPointsY();
+		const float* otherX = other.GetPackedPointsX();
+		const float* otherY = other.GetPackedPointsY();
+		unsigned int nOwnerPoints = owner.GetPointCount();
+		unsigned int nOtherPoints = other.GetPointCount();
+
+#if defined(SIMD_SAT_AVX2)
+		// 8 axes at a time
+		for (unsigned int k = 0; k < nOwnerPoints; k += 8)
+		{
+			// unnormalised edge normals (-dy, dx), the test only compares projections so the scale doesn't matter
+			__m256 normalX = _mm256_sub_ps(_mm256_loadu_ps(ownerY + k), _mm256_loadu_ps(ownerY + k + 1));
+			__m256 normalY = _mm256_sub_ps(_mm256_loadu_ps(ownerX + k + 1), _mm256_loadu_ps(ownerX + k));
+
+			__m256 minOwner = _mm256_set1_ps(INFINITY), maxOwner = _mm256_set1_ps(-INFINITY);
+			for (unsigned int p = 0; p < nOwnerPoints; p++)
+			{
+				__m256 q = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(ownerX[p]), normalX), _mm256_mul_ps(_mm256_set1_ps(ownerY[p]), normalY));
+				minOwner = _mm256_min_ps(minOwner, q);
+				maxOwner = _mm256_max_ps(maxOwner, q);
+			}
+
+			__m256 minOther = _mm256_set1_ps(INFINITY), maxOther = _mm256_set1_ps(-INFINITY);
+			for (unsigned int p = 0; p < nOtherPoints; p++)
+			{
+				__m256 q = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(otherX[p]), normalX), _mm256_mul_ps(_mm256_set1_ps(otherY[p]), normalY));
+				minOther = _mm256_min_ps(minOther, q);
+				maxOther = _mm256_max_ps(maxOther, q);
+			}
+
+			// any lane where the projections don't overlap is a separating axis
+			__m256 separated = _mm256_or_ps(_mm256_cmp_ps(maxOther, minOwner, _CMP_LT_OQ), _mm256_cmp_ps(maxOwner, minOther, _CMP_LT_OQ));
+			if (_mm256_movemask_ps(separated))
+				return true;
+		}
+#elif defined(SIMD_SAT_SSE)
+		// 4 axes at a time
+		for (unsigned int k = 0; k < nOwnerPoints; k += 4)
+		{
+			// unnormalised edge normals (-dy, dx), the test only compares projections so the scale doesn't matter
+			__m128 normalX = _mm_sub_ps(_mm_loadu_ps(ownerY + k), _mm_loadu_ps(ownerY + k + 1));
+			__m128 normalY = _mm_sub_ps(_mm_loadu_ps(ownerX + k + 1), _mm_loadu_ps(ownerX + k));
+
+			__m128 minOwner = _mm_set1_ps(INFINITY), maxOwner = _mm_set1_ps(-INFINITY);
+			for (unsigned int p = 0; p < nOwnerPoints; p++)
+			{
+				__m128 q = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(ownerX[p]), normalX), _mm_mul_ps(_mm_set1_ps(ownerY[p]), normalY));
+				minOwner = _mm_min_ps(minOwner, q);
+				maxOwner = _mm_max_ps(maxOwner, q);
+			}
+
+			__m128 minOther = _mm_set1_ps(INFINITY), maxOther = _mm_set1_ps(-INFINITY);
+			for (unsigned int p = 0; p < nOtherPoints; p++)
+			{
+				__m128 q = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(otherX[p]), normalX), _mm_mul_ps(_mm_set1_ps(otherY[p]), normalY));
+				minOther = _mm_min_ps(minOther, q);
+				maxOther = _mm_max_ps(maxOther, q);
+			}
+
+			// any lane where the projections don't overlap is a separating axis
+			__m128 separated = _mm_or_ps(_mm_cmplt_ps(maxOther, minOwner), _mm_cmplt_ps(maxOwner, minOther));
+			if (_mm_movemask_ps(separated))
+				return true;
+		}
+#else
+		// scalar fallback, same layout one axis at a time
+		for (unsigned int k = 0; k < nOwnerPoints; k++)
+		{
+			float normalX = ownerY[k] - ownerY[k + 1];
+			float normalY = ownerX[k + 1] - ownerX[k];
+
+			float minOwner = INFINITY, maxOwner = -INFINITY;
+			for (unsigned int p = 0; p < nOwnerPoints; p++)
+			{
+				float q = ownerX[p] * normalX + ownerY[p] * normalY;
+				minOwner = q < minOwner ? q : minOwner;
+				maxOwner = q > maxOwner ? q : maxOwner;
+			}
+
+			float minOther = INFINITY, maxOther = -INFINITY;
+			for (unsigned int p = 0; p < nOtherPoints; p++)
+			{
+				float q = otherX[p] * normalX + otherY[p] * normalY;
+				minOther = q < minOther ? q : minOther;
+				maxOther = q > maxOther ? q : maxOther;
+			}
+
+			if (maxOther < minOwner || maxOwner < minOther)
+				return true;
+		}
+#endif
+
+		return false;
+	}
+}
+
+/* bool TestCollision
+* Brief:
+*	Returns true if no edge normal of either sprite separates them.
+*	Matches the signature of the other narrow phase tests.
+* Params:
+*	<WireframeSprite&> spriteA	-	first sprite
+*	<WireframeSprite&> spriteB	-	second sprite
+*/
+bool SimdSAT::TestCollision(WireframeSprite& spriteA, WireframeSprite& spriteB)
+{
+	return !IsSeparatedByEdgesOf(spriteA, spriteB) && !IsSeparatedByEdgesOf(spriteB, spriteA);
+}
+
+// Returns the name of the instruction set the test was compiled with
+const char* SimdSAT::GetInstructionSetName()
+{
+#if defined(SIMD_SAT_AVX2)
+	return "AVX2";
+#elif defined(SIMD_SAT_SSE)
+	return "SSE";
+#else
+	return "Scalar";
+#endif
+}
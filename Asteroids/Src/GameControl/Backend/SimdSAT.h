@@ -0,0 +1,29 @@
+#pragma once
+
+// class pre-definitions to save header space
+class WireframeSprite;
+
+/* namespace SimdSAT
+ *	Separating axis test vectorised across the edges of a shape. The sprites keep
+ *	their points as structure of arrays padded to PACKED_CAPACITY, so a block of
+ *	edge normals can be loaded straight out of the x and y arrays. Each point of
+ *	both shapes is then projected onto the whole block of axes at once and the
+ *	min / max of every lane is compared with a single mask, so there are no
+ *	horizontal reductions and the axes never need normalising.
+ *	AVX2 is used when the compiler targets it, then SSE, then a scalar fallback.
+*/
+namespace SimdSAT
+{
+	/* bool TestCollision
+	* Brief:
+	*	Returns true if no edge normal of either sprite separates them.
+	*	Matches the signature of the other narrow phase tests.
+	* Params:
+	*	<WireframeSprite&> spriteA	-	first sprite
+	*	<WireframeSprite&> spriteB	-	second sprite
+	*/
+	bool TestCollision(WireframeSprite& spriteA, WireframeSprite& spriteB);
+
+	// Returns the name of the instruction set the test was compiled with
+	const char* GetInstructionSetName();
+}
@@ -0,0 +1,559 @@
+#include "DynamicAABBTree.h"
+#include "../../../GameObjects/Base/WireframeSprite.h"
+#include <algorithm>
+
+DynamicAABBTree::DynamicAABBTree(){}
+
+DynamicAABBTree::~DynamicAABBTree(){}
+
+/* void AddObject
+* Brief:
+*	Creates a leaf proxy for the sprite with a fat bounding box and inserts
+*	it into the tree. The proxy id is stored on the sprite so it can be found
+*	again without searching.
+* Params:
+*	<WireframeSprite*> sprite	-	the sprite to add to the tree structure
+*/
+void DynamicAABBTree::AddObject(WireframeSprite* sprite)
+{
+	int leaf = this->AllocateNode();
+
+	// setup the leaf with the current bounds of the sprite
+	Node& node = this->_nodes[leaf];
+	node.sprite = sprite;
+	node.tightBounds = Bounds::FromRect(sprite->GetBoundingRectangle());
+	node.fatBounds = this->CalculateFatBounds(node.tightBounds, sprite->GetVelocity());
+	node.height = 0;
+
+	this->InsertLeaf(leaf);
+	sprite->SetTreeProxy(leaf);
+}
+
+/* void RemoveObject
+* Brief:
+*	Removes the sprite's leaf from the tree and releases the proxy node
+* Params:
+*	<WireframeSprite*> sprite	-	the sprite to remove from the tree
+*/
+void DynamicAABBTree::RemoveObject(WireframeSprite* sprite)
+{
+	int leaf = sprite->GetTreeProxy();
+
+	// sprite isn't in the tree
+	if (leaf == NULL_NODE)
+		return;
+
+	this->RemoveLeaf(leaf);
+	this->FreeNode(leaf);
+	sprite->SetTreeProxy(NULL_NODE);
+}
+
+/* bool UpdateObject
+* Brief:
+*	Refreshes the tight bounds of the sprite's proxy. If the sprite is still
+*	contained by the fat box nothing else happens, otherwise the leaf is
+*	reinserted with a new fat box padded by the sprite's velocity.
+* Params:
+*	<WireframeSprite*> sprite	-	the sprite that has moved
+* Returns:
+*	<bool>	-	true if the proxy had to be reinserted
+*/
+bool DynamicAABBTree::UpdateObject(WireframeSprite* sprite)
+{
+	int leaf = sprite->GetTreeProxy();
+	if (leaf == NULL_NODE)
+		return false;
+
+	Bounds tight = Bounds::FromRect(sprite->GetBoundingRectangle());
+	this->_nodes[leaf].tightBounds = tight;
+
+	// still inside the fat box, tree doesn't need to change
+	if (this->_nodes[leaf].fatBounds.Contains(tight))
+		return false;
+
+	// escaped the fat box, reinsert with a new one
+	this->RemoveLeaf(leaf);
+	this->_nodes[leaf].fatBounds = this->CalculateFatBounds(tight, sprite->GetVelocity());
+	this->InsertLeaf(leaf);
+
+	return true;
+}
+
+/* void FindPairs
+* Brief:
+*	Self overlap query of the tree against itself. Both children of every
+*	internal node are descended together so each overlapping pair of leaves
+*	is reported exactly once. Pairs are only output if their tight bounds overlap.
+* Params:
+*	<vector<pair<wireframesprite*, wireframesprite*>>&> pairs	-	vector to store result to
+*/
+void DynamicAABBTree::FindPairs(std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs)
+{
+	if (this->_root == NULL_NODE)
+		return;
+
+	this->QuerySelf(this->_root, pairs);
+}
+
+/* void Query
+* Brief:
+*	finds all sprites whose tight bounds intersect the given range
+* Params:
+*	<FloatRect>					range	-	query range
+*	<vector<wireframesprite*>&> sprites	-	vector to store result to
+*/
+void DynamicAABBTree::Query(sf::FloatRect range, std::vector<WireframeSprite*>& sprites)
+{
+	if (this->_root == NULL_NODE)
+		return;
+
+	Bounds queryBounds = Bounds::FromRect(range);
+
+	this->_stack.clear();
+	this->_stack.push_back(this->_root);
+
+	while (!this->_stack.empty())
+	{
+		int index = this->_stack.back();
+		this->_stack.pop_back();
+
+		const Node& node = this->_nodes[index];
+		if (!node.fatBounds.Overlaps(queryBounds))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			if (node.tightBounds.Overlaps(queryBounds))
+				sprites.push_back(node.sprite);
+		}
+		else
+		{
+			this->_stack.push_back(node.child1);
+			this->_stack.push_back(node.child2);
+		}
+	}
+}
+
+/* void Draw
+* Brief:
+*	Draws the fat box of every node in the tree
+* Params:
+*	<sf::RenderWindow* window>	-	window to draw the structure to
+*/
+void DynamicAABBTree::Draw(sf::RenderWindow* window)
+{
+	sf::RectangleShape rect;
+	rect.setFillColor(sf::Color::Transparent);
+	rect.setOutlineColor(this->_gridColor);
+	rect.setOutlineThickness(1);
+
+	for (unsigned int i = 0; i < this->_nodes.size(); i++)
+	{
+		// skip nodes sitting in the free list
+		if (this->_nodes[i].height < 0)
+			continue;
+
+		const Bounds& bounds = this->_nodes[i].fatBounds;
+		rect.setPosition({ bounds.minX, bounds.minY });
+		rect.setSize({ bounds.maxX - bounds.minX, bounds.maxY - bounds.minY });
+		window->draw(rect);
+	}
+}
+
+// Takes a node from the free list, growing the pool if needed
+int DynamicAABBTree::AllocateNode()
+{
+	// pool is empty, grow it and thread the new nodes onto the free list
+	if (this->_freeList == NULL_NODE)
+	{
+		unsigned int oldSize = static_cast<unsigned int>(this->_nodes.size());
+		unsigned int newSize = oldSize == 0 ? 16 : oldSize * 2;
+		this->_nodes.resize(newSize);
+
+		for (unsigned int i = oldSize; i < newSize; i++)
+		{
+			this->_nodes[i].parent = (i + 1 < newSize) ? static_cast<int>(i + 1) : NULL_NODE;
+			this->_nodes[i].height = -1;
+		}
+		this->_freeList = static_cast<int>(oldSize);
+	}
+
+	// pop the first free node
+	int index = this->_freeList;
+	Node& node = this->_nodes[index];
+	this->_freeList = node.parent;
+
+	node.parent = NULL_NODE;
+	node.child1 = NULL_NODE;
+	node.child2 = NULL_NODE;
+	node.height = 0;
+	node.sprite = nullptr;
+
+	return index;
+}
+
+// Returns a node to the free list
+void DynamicAABBTree::FreeNode(int node)
+{
+	this->_nodes[node].parent = this->_freeList;
+	this->_nodes[node].height = -1;
+	this->_nodes[node].sprite = nullptr;
+	this->_freeList = node;
+}
+
+// Finds the cheapest sibling and inserts the leaf beside it
+void DynamicAABBTree::InsertLeaf(int leaf)
+{
+	// first node becomes the root
+	if (this->_root == NULL_NODE)
+	{
+		this->_root = leaf;
+		this->_nodes[leaf].parent = NULL_NODE;
+		return;
+	}
+
+	// Descend the tree choosing the child that grows the least
+	Bounds leafBounds = this->_nodes[leaf].fatBounds;
+	int index = this->_root;
+	while (!this->_nodes[index].IsLeaf())
+	{
+		int child1 = this->_nodes[index].child1;
+		int child2 = this->_nodes[index].child2;
+
+		float perimeter = this->_nodes[index].fatBounds.Perimeter();
+		float combinedPerimeter = Bounds::Combine(this->_nodes[index].fatBounds, leafBounds).Perimeter();
+
+		// cost of creating a new parent for this node and the new leaf
+		float cost = 2.0f * combinedPerimeter;
+
+		// minimum cost of pushing the leaf further down the tree
+		float inheritanceCost = 2.0f * (combinedPerimeter - perimeter);
+
+		// cost of descending into each child
+		float cost1 = Bounds::Combine(leafBounds, this->_nodes[child1].fatBounds).Perimeter() + inheritanceCost;
+		if (!this->_nodes[child1].IsLeaf())
+			cost1 -= this->_nodes[child1].fatBounds.Perimeter();
+
+		float cost2 = Bounds::Combine(leafBounds, this->_nodes[child2].fatBounds).Perimeter() + inheritanceCost;
+		if (!this->_nodes[child2].IsLeaf())
+			cost2 -= this->_nodes[child2].fatBounds.Perimeter();
+
+		// stop descending once it's cheapest to pair with this node
+		if (cost < cost1 && cost < cost2)
+			break;
+
+		index = cost1 < cost2 ? child1 : child2;
+	}
+
+	int sibling = index;
+
+	// Create a new parent for the sibling and leaf
+	int oldParent = this->_nodes[sibling].parent;
+	int newParent = this->AllocateNode();
+	this->_nodes[newParent].parent = oldParent;
+	this->_nodes[newParent].fatBounds = Bounds::Combine(leafBounds, this->_nodes[sibling].fatBounds);
+	this->_nodes[newParent].height = this->_nodes[sibling].height + 1;
+	this->_nodes[newParent].child1 = sibling;
+	this->_nodes[newParent].child2 = leaf;
+	this->_nodes[sibling].parent = newParent;
+	this->_nodes[leaf].parent = newParent;
+
+	// link the new parent into the old parent's place
+	if (oldParent != NULL_NODE)
+	{
+		if (this->_nodes[oldParent].child1 == sibling)
+			this->_nodes[oldParent].child1 = newParent;
+		else
+			this->_nodes[oldParent].child2 = newParent;
+	}
+	else
+	{
+		this->_root = newParent;
+	}
+
+	// Walk back up the tree fixing heights and bounds
+	index = this->_nodes[leaf].parent;
+	while (index != NULL_NODE)
+	{
+		index = this->Balance(index);
+
+		int child1 = this->_nodes[index].child1;
+		int child2 = this->_nodes[index].child2;
+
+		this->_nodes[index].height = 1 + std::max(this->_nodes[child1].height, this->_nodes[child2].height);
+		this->_nodes[index].fatBounds = Bounds::Combine(this->_nodes[child1].fatBounds, this->_nodes[child2].fatBounds);
+
+		index = this->_nodes[index].parent;
+	}
+}
+
+// Detaches a leaf and collapses its parent
+void DynamicAABBTree::RemoveLeaf(int leaf)
+{
+	if (leaf == this->_root)
+	{
+		this->_root = NULL_NODE;
+		return;
+	}
+
+	int parent = this->_nodes[leaf].parent;
+	int grandParent = this->_nodes[parent].parent;
+	int sibling = this->_nodes[parent].child1 == leaf ? this->_nodes[parent].child2 : this->_nodes[parent].child1;
+
+	// parent is the root, sibling takes its place
+	if (grandParent == NULL_NODE)
+	{
+		this->_root = sibling;
+		this->_nodes[sibling].parent = NULL_NODE;
+		this->FreeNode(parent);
+		return;
+	}
+
+	// Destroy the parent and connect the sibling to the grand parent
+	if (this->_nodes[grandParent].child1 == parent)
+		this->_nodes[grandParent].child1 = sibling;
+	else
+		this->_nodes[grandParent].child2 = sibling;
+	this->_nodes[sibling].parent = grandParent;
+	this->FreeNode(parent);
+
+	// Walk back up the tree fixing heights and bounds
+	int index = grandParent;
+	while (index != NULL_NODE)
+	{
+		index = this->Balance(index);
+
+		int child1 = this->_nodes[index].child1;
+		int child2 = this->_nodes[index].child2;
+
+		this->_nodes[index].fatBounds = Bounds::Combine(this->_nodes[child1].fatBounds, this->_nodes[child2].fatBounds);
+		this->_nodes[index].height = 1 + std::max(this->_nodes[child1].height, this->_nodes[child2].height);
+
+		index = this->_nodes[index].parent;
+	}
+}
+
+/* int Balance
+* Brief:
+*	If one child of node A is more than one level taller than the other, the
+*	taller child is rotated up to take A's place. A then adopts the shorter
+*	grandchild, the taller grandchild stays with the promoted node.
+* Params:
+*	<int> iA	-	node to balance
+* Returns:
+*	<int>	-	node that now sits in A's position in the tree
+*/
+int DynamicAABBTree::Balance(int iA)
+{
+	if (this->_nodes[iA].IsLeaf() || this->_nodes[iA].height < 2)
+		return iA;
+
+	int iB = this->_nodes[iA].child1;
+	int iC = this->_nodes[iA].child2;
+
+	int balance = this->_nodes[iC].height - this->_nodes[iB].height;
+
+	// Rotate C up
+	if (balance > 1)
+	{
+		int iF = this->_nodes[iC].child1;
+		int iG = this->_nodes[iC].child2;
+
+		// Swap A and C
+		this->_nodes[iC].child1 = iA;
+		this->_nodes[iC].parent = this->_nodes[iA].parent;
+		this->_nodes[iA].parent = iC;
+
+		// A's old parent should point to C
+		int cParent = this->_nodes[iC].parent;
+		if (cParent != NULL_NODE)
+		{
+			if (this->_nodes[cParent].child1 == iA)
+				this->_nodes[cParent].child1 = iC;
+			else
+				this->_nodes[cParent].child2 = iC;
+		}
+		else
+		{
+			this->_root = iC;
+		}
+
+		// Keep the taller grandchild under C, give the other to A
+		if (this->_nodes[iF].height > this->_nodes[iG].height)
+		{
+			this->_nodes[iC].child2 = iF;
+			this->_nodes[iA].child2 = iG;
+			this->_nodes[iG].parent = iA;
+			this->_nodes[iA].fatBounds = Bounds::Combine(this->_nodes[iB].fatBounds, this->_nodes[iG].fatBounds);
+			this->_nodes[iC].fatBounds = Bounds::Combine(this->_nodes[iA].fatBounds, this->_nodes[iF].fatBounds);
+
+			this->_nodes[iA].height = 1 + std::max(this->_nodes[iB].height, this->_nodes[iG].height);
+			this->_nodes[iC].height = 1 + std::max(this->_nodes[iA].height, this->_nodes[iF].height);
+		}
+		else
+		{
+			this->_nodes[iC].child2 = iG;
+			this->_nodes[iA].child2 = iF;
+			this->_nodes[iF].parent = iA;
+			this->_nodes[iA].fatBounds = Bounds::Combine(this->_nodes[iB].fatBounds, this->_nodes[iF].fatBounds);
+			this->_nodes[iC].fatBounds = Bounds::Combine(this->_nodes[iA].fatBounds, this->_nodes[iG].fatBounds);
+
+			this->_nodes[iA].height = 1 + std::max(this->_nodes[iB].height, this->_nodes[iF].height);
+			this->_nodes[iC].height = 1 + std::max(this->_nodes[iA].height, this->_nodes[iG].height);
+		}
+
+		return iC;
+	}
+
+	// Rotate B up
+	if (balance < -1)
+	{
+		int iD = this->_nodes[iB].child1;
+		int iE = this->_nodes[iB].child2;
+
+		// Swap A and B
+		this->_nodes[iB].child1 = iA;
+		this->_nodes[iB].parent = this->_nodes[iA].parent;
+		this->_nodes[iA].parent = iB;
+
+		// A's old parent should point to B
+		int bParent = this->_nodes[iB].parent;
+		if (bParent != NULL_NODE)
+		{
+			if (this->_nodes[bParent].child1 == iA)
+				this->_nodes[bParent].child1 = iB;
+			else
+				this->_nodes[bParent].child2 = iB;
+		}
+		else
+		{
+			this->_root = iB;
+		}
+
+		// Keep the taller grandchild under B, give the other to A
+		if (this->_nodes[iD].height > this->_nodes[iE].height)
+		{
+			this->_nodes[iB].child2 = iD;
+			this->_nodes[iA].child1 = iE;
+			this->_nodes[iE].parent = iA;
+			this->_nodes[iA].fatBounds = Bounds::Combine(this->_nodes[iC].fatBounds, this->_nodes[iE].fatBounds);
+			this->_nodes[iB].fatBounds = Bounds::Combine(this->_nodes[iA].fatBounds, this->_nodes[iD].fatBounds);
+
+			this->_nodes[iA].height = 1 + std::max(this->_nodes[iC].height, this->_nodes[iE].height);
+			this->_nodes[iB].height = 1 + std::max(this->_nodes[iA].height, this->_nodes[iD].height);
+		}
+		else
+		{
+			this->_nodes[iB].child2 = iE;
+			this->_nodes[iA].child1 = iD;
+			this->_nodes[iD].parent = iA;
+			this->_nodes[iA].fatBounds = Bounds::Combine(this->_nodes[iC].fatBounds, this->_nodes[iD].fatBounds);
+			this->_nodes[iB].fatBounds = Bounds::Combine(this->_nodes[iA].fatBounds, this->_nodes[iE].fatBounds);
+
+			this->_nodes[iA].height = 1 + std::max(this->_nodes[iC].height, this->_nodes[iD].height);
+			this->_nodes[iB].height = 1 + std::max(this->_nodes[iA].height, this->_nodes[iE].height);
+		}
+
+		return iB;
+	}
+
+	return iA;
+}
+
+// Calculates a fat box for the sprite padded by margin and velocity
+DynamicAABBTree::Bounds DynamicAABBTree::CalculateFatBounds(const Bounds& tight, const sf::Vector2f& velocity) const
+{
+	Bounds fat = tight;
+
+	// pad every side by the margin
+	fat.minX -= FAT_MARGIN;
+	fat.minY -= FAT_MARGIN;
+	fat.maxX += FAT_MARGIN;
+	fat.maxY += FAT_MARGIN;
+
+	// extend in the direction of travel so moving sprites stay inside for longer
+	sf::Vector2f displacement = velocity * VELOCITY_PADDING;
+
+	if (displacement.x < 0.0f)
+		fat.minX += displacement.x;
+	else
+		fat.maxX += displacement.x;
+
+	if (displacement.y < 0.0f)
+		fat.minY += displacement.y;
+	else
+		fat.maxY += displacement.y;
+
+	return fat;
+}
+
+// Reports every overlapping pair of leaves below the node
+void DynamicAABBTree::QuerySelf(int node, std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs)
+{
+	if (this->_nodes[node].IsLeaf())
+		return;
+
+	int child1 = this->_nodes[node].child1;
+	int child2 = this->_nodes[node].child2;
+
+	// pairs within each child, then pairs between the two children
+	this->QuerySelf(child1, pairs);
+	this->QuerySelf(child2, pairs);
+	this->QueryCross(child1, child2, pairs);
+}
+
+// Reports every overlapping pair with one leaf below node A and the other below node B
+void DynamicAABBTree::QueryCross(int nodeA, int nodeB, std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs)
+{
+	const Node& a = this->_nodes[nodeA];
+	const Node& b = this->_nodes[nodeB];
+
+	if (!a.fatBounds.Overlaps(b.fatBounds))
+		return;
+
+	// two leaves, test the actual bounds
+	if (a.IsLeaf() && b.IsLeaf())
+	{
+		if (a.tightBounds.Overlaps(b.tightBounds))
+			pairs.push_back({ a.sprite, b.sprite });
+		return;
+	}
+
+	// descend the larger node (or the only internal node) first
+	if (b.IsLeaf() || (!a.IsLeaf() && a.fatBounds.Perimeter() > b.fatBounds.Perimeter()))
+	{
+		int child1 = a.child1;
+		int child2 = a.child2;
+		this->QueryCross(child1, nodeB, pairs);
+		this->QueryCross(child2, nodeB, pairs);
+	}
+	else
+	{
+		int child1 = b.child1;
+		int child2 = b.child2;
+		this->QueryCross(nodeA, child1, pairs);
+		this->QueryCross(nodeA, child2, pairs);
+	}
+}
+
+// Combines two bounds into one that contains both
+DynamicAABBTree::Bounds DynamicAABBTree::Bounds::Combine(const Bounds& a, const Bounds& b)
+{
+	Bounds out;
+	out.minX = std::min(a.minX, b.minX);
+	out.minY = std::min(a.minY, b.minY);
+	out.maxX = std::max(a.maxX, b.maxX);
+	out.maxY = std::max(a.maxY, b.maxY);
+	return out;
+}
+
+// Converts an SFML rect (top left + size) into min / max bounds
+DynamicAABBTree::Bounds DynamicAABBTree::Bounds::FromRect(const sf::FloatRect& rect)
+{
+	Bounds out;
+	out.minX = rect.left;
+	out.minY = rect.top;
+	out.maxX = rect.left + rect.width;
+	out.maxY = rect.top + rect.height;
+	return out;
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include "SFML/Graphics.hpp"
+
+// class pre-definitions to save header space
+class WireframeSprite;
+
+/* class DynamicAABBTree
+ *	Bounding volume hierarchy where every leaf is a proxy for one sprite. Each
+ *	proxy stores a "fat" bounding box that is padded by a margin and by the
+ *	sprite's velocity, so while the sprite stays inside it nothing in the tree
+ *	changes. Only proxies that escape their fat box are removed and reinserted,
+ *	meaning the structure is never rebuilt from scratch. Nodes are kept balanced
+ *	with tree rotations whenever a leaf is inserted or removed.
+*/
+class DynamicAABBTree
+{
+	// Public interface
+public:
+	DynamicAABBTree();
+	~DynamicAABBTree();
+
+	/* void AddObject
+	* Brief:
+	*	Creates a leaf proxy for the sprite with a fat bounding box and inserts
+	*	it into the tree. The proxy id is stored on the sprite so it can be found
+	*	again without searching.
+	* Params:
+	*	<WireframeSprite*> sprite	-	the sprite to add to the tree structure
+	*/
+	void AddObject(WireframeSprite* sprite);
+
+	/* void RemoveObject
+	* Brief:
+	*	Removes the sprite's leaf from the tree and releases the proxy node
+	* Params:
+	*	<WireframeSprite*> sprite	-	the sprite to remove from the tree
+	*/
+	void RemoveObject(WireframeSprite* sprite);
+
+	/* bool UpdateObject
+	* Brief:
+	*	Refreshes the tight bounds of the sprite's proxy. If the sprite is still
+	*	contained by the fat box nothing else happens, otherwise the leaf is
+	*	reinserted with a new fat box padded by the sprite's velocity.
+	* Params:
+	*	<WireframeSprite*> sprite	-	the sprite that has moved
+	* Returns:
+	*	<bool>	-	true if the proxy had to be reinserted
+	*/
+	bool UpdateObject(WireframeSprite* sprite);
+
+	/* void FindPairs
+	* Brief:
+	*	Self overlap query of the tree against itself. Both children of every
+	*	internal node are descended together so each overlapping pair of leaves
+	*	is reported exactly once. Pairs are only output if their tight bounds overlap.
+	* Params:
+	*	<vector<pair<wireframesprite*, wireframesprite*>>&> pairs	-	vector to store result to
+	*/
+	void FindPairs(std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs);
+
+	/* void Query
+	* Brief:
+	*	finds all sprites whose tight bounds intersect the given range
+	* Params:
+	*	<FloatRect>					range	-	query range
+	*	<vector<wireframesprite*>&> sprites	-	vector to store result to
+	*/
+	void Query(sf::FloatRect range, std::vector<WireframeSprite*>& sprites);
+
+	/* void Draw
+	* Brief:
+	*	Draws the fat box of every node in the tree
+	* Params:
+	*	<sf::RenderWindow* window>	-	window to draw the structure to
+	*/
+	void Draw(sf::RenderWindow* window);
+
+	// Returns the height of the tree (0 for a single leaf)
+	int GetHeight() const { return this->_root == NULL_NODE ? 0 : this->_nodes[this->_root].height; }
+
+	// Private structures
+private:
+	/* struct Bounds
+	 * Brief:
+	 *	min / max bounding box, cheaper to combine and test than a FloatRect
+	*/
+	struct Bounds
+	{
+		float minX = 0.0f, minY = 0.0f;
+		float maxX = 0.0f, maxY = 0.0f;
+
+		bool Overlaps(const Bounds& other) const
+		{
+			return !(other.minX > maxX || other.maxX < minX || other.minY > maxY || other.maxY < minY);
+		}
+
+		bool Contains(const Bounds& other) const
+		{
+			return minX <= other.minX && minY <= other.minY && maxX >= other.maxX && maxY >= other.maxY;
+		}
+
+		// Perimeter is used as the cost metric in 2D instead of area
+		float Perimeter() const { return 2.0f * ((maxX - minX) + (maxY - minY)); }
+
+		static Bounds Combine(const Bounds& a, const Bounds& b);
+		static Bounds FromRect(const sf::FloatRect& rect);
+	};
+
+	/* struct Node
+	 * Brief:
+	 *	Node of the tree, leaves hold a sprite and the tight bounds of that sprite.
+	 *	Free nodes reuse the parent index as the next link of the free list.
+	*/
+	struct Node
+	{
+		Bounds fatBounds;						// Enlarged bounds (leaf) or union of the children
+		Bounds tightBounds;						// actual bounds of the sprite at the last update (leaves only)
+		WireframeSprite* sprite = nullptr;		// sprite stored in the leaf
+		int parent = NULL_NODE;					// parent node or next free node
+		int child1 = NULL_NODE;					// first child
+		int child2 = NULL_NODE;					// second child
+		int height = 0;							// leaf = 0, free node = -1
+
+		bool IsLeaf() const { return child1 == NULL_NODE; }
+	};
+
+	// Private methods for internal use
+private:
+	int AllocateNode();							// Takes a node from the free list, growing the pool if needed
+	void FreeNode(int node);					// Returns a node to the free list
+
+	void InsertLeaf(int leaf);					// Finds the cheapest sibling and inserts the leaf beside it
+	void RemoveLeaf(int leaf);					// Detaches a leaf and collapses its parent
+	int Balance(int node);						// Rotates the node if its children heights differ by more than one
+
+	// Calculates a fat box for the sprite padded by margin and velocity
+	Bounds CalculateFatBounds(const Bounds& tight, const sf::Vector2f& velocity) const;
+
+	void QuerySelf(int node, std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs);
+	void QueryCross(int nodeA, int nodeB, std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs);
+
+	// Members
+private:
+	std::vector<Node> _nodes;					// Pool of all nodes, linked by index
+	int _root = NULL_NODE;						// Root node of the tree
+	int _freeList = NULL_NODE;					// First free node in the pool
+	std::vector<int> _stack;					// Traversal stack reused between queries
+	sf::Color _gridColor = sf::Color::Blue;		// colour to draw the tree
+
+	// constants
+	static constexpr int NULL_NODE = -1;		// Index used for no node
+	static constexpr float FAT_MARGIN = 4.0f;	// Padding in pixels added to every side of the fat box
+	static constexpr float VELOCITY_PADDING = 4.0f;	// Number of frames of movement the fat box is extended by
+};
@@ -0,0 +1,320 @@
+#include "HierarchicalGrid.h"
+#include "../../../GameObjects/Base/WireframeSprite.h"
+#include "../../../Global/ApplicationDefines.h"
+#include <algorithm>
+#include <cmath>
+
+/* Constructor
+ * Brief:
+ *	Takes the size in world pixels of the cells on the finest level,
+ *	each level above doubles it.
+ */
+HierarchicalGrid::HierarchicalGrid(float minCellSize)
+{
+	// lay the levels out one after another in the cell array
+	unsigned int nCells = 0;
+	float cellSize = minCellSize;
+	for (unsigned int i = 0; i < MAX_LEVELS; i++)
+	{
+		Level level;
+		level.cellSize = cellSize;
+		level.numXCells = static_cast<int>(std::ceil(WINDOW_WIDTH / cellSize)) + 2;
+		level.numYCells = static_cast<int>(std::ceil(WINDOW_HEIGHT / cellSize)) + 2;
+		level.firstCell = nCells;
+		this->_levels.push_back(level);
+
+		nCells += level.numXCells * level.numYCells;
+		cellSize *= 2.0f;
+	}
+
+	this->_cellStart.assign(nCells + 1, 0);
+}
+
+HierarchicalGrid::~HierarchicalGrid(){}
+
+/* void AddObject
+* Brief:
+*	Adds the sprite to the list of sprites binned on the next call to update
+* Params:
+*	<WireframeSprite*> sprite	-	the sprite to add to the structure
+*/
+void HierarchicalGrid::AddObject(WireframeSprite* sprite)
+{
+	this->_sprites.push_back(sprite);
+}
+
+/* void RemoveObject
+* Brief:
+*	Removes the sprite from the list of sprites with a swap delete,
+*	the cells are rebuilt on the next update.
+* Params:
+*	<WireframeSprite*> sprite	-	the sprite to remove from the structure
+*/
+void HierarchicalGrid::RemoveObject(WireframeSprite* sprite)
+{
+	auto it = std::find(this->_sprites.begin(), this->_sprites.end(), sprite);
+
+	// sprite isn't in the structure
+	if (it == this->_sprites.end())
+		return;
+
+	*it = this->_sprites.back();
+	this->_sprites.pop_back();
+
+	// the cells still reference the sprite until the next update
+	this->_entries.clear();
+	std::fill(this->_cellStart.begin(), this->_cellStart.end(), 0);
+	for (unsigned int i = 0; i < this->_levels.size(); i++)
+		this->_levels[i].nObjects = 0;
+}
+
+/* void RemoveObjects
+* Brief:
+*	Removes every sprite in the list with one pass over the structure
+*	instead of one search per sprite. The list must be sorted by address.
+* Params:
+*	<const vector<WireframeSprite*>&> sprites	-	sorted sprites to remove from the structure
+*/
+void HierarchicalGrid::RemoveObjects(const std::vector<WireframeSprite*>& sprites)
+{
+	if (sprites.empty())
+		return;
+
+	// keep every sprite not in the list, in order
+	unsigned int writeIndex = 0;
+	for (unsigned int i = 0; i < this->_sprites.size(); i++)
+	{
+		if (!std::binary_search(sprites.begin(), sprites.end(), this->_sprites[i]))
+			this->_sprites[writeIndex++] = this->_sprites[i];
+	}
+	this->_sprites.resize(writeIndex);
+
+	// the cells still reference the sprites until the next update
+	this->_entries.clear();
+	std::fill(this->_cellStart.begin(), this->_cellStart.end(), 0);
+	for (unsigned int i = 0; i < this->_levels.size(); i++)
+		this->_levels[i].nObjects = 0;
+}
+
+/* void Update
+* Brief:
+*	Picks the level of every sprite from the size of its bounds and
+*	rebuilds the cells with a counting sort over the cells of every level.
+*/
+void HierarchicalGrid::Update()
+{
+	unsigned int nSprites = static_cast<unsigned int>(this->_sprites.size());
+	this->_pending.resize(nSprites);
+	this->_pendingCell.resize(nSprites);
+	this->_entries.resize(nSprites);
+
+	std::fill(this->_cellStart.begin(), this->_cellStart.end(), 0);
+	for (unsigned int i = 0; i < this->_levels.size(); i++)
+		this->_levels[i].nObjects = 0;
+
+	// count the sprites landing in each cell
+	for (unsigned int i = 0; i < nSprites; i++)
+	{
+		sf::FloatRect rect = this->_sprites[i]->GetBoundingRectangle();
+		Entry entry = { this->_sprites[i], rect.left, rect.top, rect.left + rect.width, rect.top + rect.height };
+
+		Level& level = this->_levels[this->PickLevel(std::max(rect.width, rect.height))];
+		int x = this->ToCell(level, rect.left + rect.width * 0.5f, level.numXCells);
+		int y = this->ToCell(level, rect.top + rect.height * 0.5f, level.numYCells);
+		level.nObjects++;
+
+		this->_pending[i] = entry;
+		this->_pendingCell[i] = this->CellIndex(level, x, y);
+		this->_cellStart[this->_pendingCell[i]]++;
+	}
+
+	// turn the counts into offsets, the extra entry ends up holding the total
+	unsigned int offset = 0;
+	for (unsigned int c = 0; c < this->_cellStart.size(); c++)
+	{
+		unsigned int count = this->_cellStart[c];
+		this->_cellStart[c] = offset;
+		offset += count;
+	}
+
+	// write each sprite into its cell, moving the cell's start along as it fills
+	for (unsigned int i = 0; i < nSprites; i++)
+		this->_entries[this->_cellStart[this->_pendingCell[i]]++] = this->_pending[i];
+
+	// every start has moved to the next cell's start, shift them back
+	for (unsigned int c = static_cast<unsigned int>(this->_cellStart.size()) - 1; c > 0; c--)
+		this->_cellStart[c] = this->_cellStart[c - 1];
+	this->_cellStart[0] = 0;
+}
+
+/* void FindPairs
+* Brief:
+*	Tests each sprite against the 3x3 cells around it on its own level and
+*	on every occupied level above it. On its own level only sprites later in
+*	the array are taken so each pair is found once. Pairs are only output if
+*	their bounds overlap.
+* Params:
+*	<vector<pair<wireframesprite*, wireframesprite*>>&> pairs	-	vector to store result to
+*/
+void HierarchicalGrid::FindPairs(std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs)
+{
+	for (unsigned int l = 0; l < this->_levels.size(); l++)
+	{
+		const Level& ownLevel = this->_levels[l];
+		if (ownLevel.nObjects == 0)
+			continue;
+
+		// the level's sprites are one contiguous range of the array
+		unsigned int first = this->_cellStart[ownLevel.firstCell];
+		unsigned int last = this->_cellStart[ownLevel.firstCell + ownLevel.numXCells * ownLevel.numYCells];
+
+		for (unsigned int i = first; i < last; i++)
+		{
+			const Entry& a = this->_entries[i];
+			float centreX = (a.minX + a.maxX) * 0.5f;
+			float centreY = (a.minY + a.maxY) * 0.5f;
+
+			for (unsigned int k = l; k < this->_levels.size(); k++)
+			{
+				const Level& level = this->_levels[k];
+				if (level.nObjects == 0)
+					continue;
+
+				int cellX = this->ToCell(level, centreX, level.numXCells);
+				int cellY = this->ToCell(level, centreY, level.numYCells);
+
+				for (int y = std::max(cellY - 1, 0); y <= std::min(cellY + 1, level.numYCells - 1); y++)
+				{
+					// the three cells of a row are next to each other in the array
+					unsigned int rowFirst = this->_cellStart[this->CellIndex(level, std::max(cellX - 1, 0), y)];
+					unsigned int rowLast = this->_cellStart[this->CellIndex(level, std::min(cellX + 1, level.numXCells - 1), y) + 1];
+
+					// only sprites after this one on its own level
+					if (k == l)
+						rowFirst = std::max(rowFirst, i + 1);
+
+					for (unsigned int j = rowFirst; j < rowLast; j++)
+					{
+						const Entry& b = this->_entries[j];
+
+						// bounds must overlap
+						if (a.minX > b.maxX || a.maxX < b.minX || a.minY > b.maxY || a.maxY < b.minY)
+							continue;
+
+						pairs.push_back({ a.sprite, b.sprite });
+					}
+				}
+			}
+		}
+	}
+}
+
+/* void Query
+* Brief:
+*	finds all sprites whose bounds intersect the given range
+* Params:
+*	<FloatRect>					range	-	query range
+*	<vector<wireframesprite*>&> sprites	-	vector to store result to
+*/
+void HierarchicalGrid::Query(sf::FloatRect range, std::vector<WireframeSprite*>& sprites)
+{
+	float maxX = range.left + range.width;
+	float maxY = range.top + range.height;
+
+	for (unsigned int l = 0; l < this->_levels.size(); l++)
+	{
+		const Level& level = this->_levels[l];
+		if (level.nObjects == 0)
+			continue;
+
+		// sprites are binned by their centre and are no bigger than a cell,
+		// so any sprite touching the range has its centre within half a cell of it
+		float margin = level.cellSize * 0.5f;
+		int minCellX = this->ToCell(level, range.left - margin, level.numXCells);
+		int minCellY = this->ToCell(level, range.top - margin, level.numYCells);
+		int maxCellX = this->ToCell(level, maxX + margin, level.numXCells);
+		int maxCellY = this->ToCell(level, maxY + margin, level.numYCells);
+
+		for (int y = minCellY; y <= maxCellY; y++)
+		{
+			unsigned int rowFirst = this->_cellStart[this->CellIndex(level, minCellX, y)];
+			unsigned int rowLast = this->_cellStart[this->CellIndex(level, maxCellX, y) + 1];
+
+			for (unsigned int i = rowFirst; i < rowLast; i++)
+			{
+				const Entry& entry = this->_entries[i];
+				if (!(range.left > entry.maxX || maxX < entry.minX || range.top > entry.maxY || maxY < entry.minY))
+					sprites.push_back(entry.sprite);
+			}
+		}
+	}
+}
+
+/* void Draw
+* Brief:
+*	Draws the outline of every occupied cell, finer levels in a lighter colour
+* Params:
+*	<sf::RenderWindow* window>	-	window to draw the structure to
+*/
+void HierarchicalGrid::Draw(sf::RenderWindow* window)
+{
+	sf::VertexArray lines(sf::Lines);
+
+	for (unsigned int l = 0; l < this->_levels.size(); l++)
+	{
+		const Level& level = this->_levels[l];
+		if (level.nObjects == 0)
+			continue;
+
+		// fade finer levels towards white so the levels can be told apart
+		sf::Uint8 fade = static_cast<sf::Uint8>(255 * (this->_levels.size() - 1 - l) / this->_levels.size());
+		sf::Color colour(std::max(this->_gridColor.r, fade), std::max(this->_gridColor.g, fade), this->_gridColor.b);
+
+		for (int y = 0; y < level.numYCells; y++)
+		{
+			for (int x = 0; x < level.numXCells; x++)
+			{
+				unsigned int cell = this->CellIndex(level, x, y);
+				if (this->_cellStart[cell] == this->_cellStart[cell + 1])
+					continue;
+
+				// the grid starts one cell before the window
+				float left = (x - 1) * level.cellSize;
+				float top = (y - 1) * level.cellSize;
+				sf::Vector2f topLeft(left, top);
+				sf::Vector2f topRight(left + level.cellSize, top);
+				sf::Vector2f bottomLeft(left, top + level.cellSize);
+				sf::Vector2f bottomRight(left + level.cellSize, top + level.cellSize);
+
+				lines.append(sf::Vertex(topLeft, colour));
+				lines.append(sf::Vertex(topRight, colour));
+				lines.append(sf::Vertex(topRight, colour));
+				lines.append(sf::Vertex(bottomRight, colour));
+				lines.append(sf::Vertex(bottomRight, colour));
+				lines.append(sf::Vertex(bottomLeft, colour));
+				lines.append(sf::Vertex(bottomLeft, colour));
+				lines.append(sf::Vertex(topLeft, colour));
+			}
+		}
+	}
+
+	window->draw(lines);
+}
+
+// Returns the finest level with cells at least as big as the given size
+unsigned int HierarchicalGrid::PickLevel(float size) const
+{
+	unsigned int level = 0;
+	while (level + 1 < this->_levels.size() && this->_levels[level].cellSize < size)
+		level++;
+
+	return level;
+}
+
+// Returns the cell coordinate on a level of a world position, clamped to the level
+int HierarchicalGrid::ToCell(const Level& level, float value, int numCells) const
+{
+	// the grid starts one cell before the window, clamping keeps neighbouring sprites in neighbouring cells
+	int cell = static_cast<int>(std::floor(value / level.cellSize)) + 1;
+	return std::min(std::max(cell, 0), numCells - 1);
+}
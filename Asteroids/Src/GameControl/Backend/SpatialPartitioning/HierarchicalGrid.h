@@ -0,0 +1,145 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include "SFML/Graphics.hpp"
+
+// class pre-definitions to save header space
+class WireframeSprite;
+
+/* class HierarchicalGrid
+ *	Stack of uniform grids covering the window where each level's cells are
+ *	twice the size of the level below. Every sprite is binned by its centre on
+ *	the finest level whose cells are at least as big as its bounds, so small
+ *	asteroids and bullets get small cells and large asteroids get large ones
+ *	without one cell size having to suit both. Two overlapping sprites are
+ *	always in neighbouring cells of the coarser sprite's level, so a sprite
+ *	only has to look at the 3x3 cells around it on its own level and above.
+ *	All the levels share one compressed (CSR) array rebuilt every frame.
+*/
+class HierarchicalGrid
+{
+	// Public interface
+public:
+	/* Constructor
+	 * Brief:
+	 *	Takes the size in world pixels of the cells on the finest level,
+	 *	each level above doubles it.
+	 */
+	HierarchicalGrid(float minCellSize);
+	~HierarchicalGrid();
+
+	/* void AddObject
+	* Brief:
+	*	Adds the sprite to the list of sprites binned on the next call to update
+	* Params:
+	*	<WireframeSprite*> sprite	-	the sprite to add to the structure
+	*/
+	void AddObject(WireframeSprite* sprite);
+
+	/* void RemoveObject
+	* Brief:
+	*	Removes the sprite from the list of sprites with a swap delete,
+	*	the cells are rebuilt on the next update.
+	* Params:
+	*	<WireframeSprite*> sprite	-	the sprite to remove from the structure
+	*/
+	void RemoveObject(WireframeSprite* sprite);
+
+	/* void RemoveObjects
+	* Brief:
+	*	Removes every sprite in the list with one pass over the structure
+	*	instead of one search per sprite. The list must be sorted by address.
+	* Params:
+	*	<const vector<WireframeSprite*>&> sprites	-	sorted sprites to remove from the structure
+	*/
+	void RemoveObjects(const std::vector<WireframeSprite*>& sprites);
+
+	/* void Update
+	* Brief:
+	*	Picks the level of every sprite from the size of its bounds and
+	*	rebuilds the cells with a counting sort over the cells of every level.
+	*/
+	void Update();
+
+	/* void FindPairs
+	* Brief:
+	*	Tests each sprite against the 3x3 cells around it on its own level and
+	*	on every occupied level above it. On its own level only sprites later in
+	*	the array are taken so each pair is found once. Pairs are only output if
+	*	their bounds overlap.
+	* Params:
+	*	<vector<pair<wireframesprite*, wireframesprite*>>&> pairs	-	vector to store result to
+	*/
+	void FindPairs(std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs);
+
+	/* void Query
+	* Brief:
+	*	finds all sprites whose bounds intersect the given range
+	* Params:
+	*	<FloatRect>					range	-	query range
+	*	<vector<wireframesprite*>&> sprites	-	vector to store result to
+	*/
+	void Query(sf::FloatRect range, std::vector<WireframeSprite*>& sprites);
+
+	/* void Draw
+	* Brief:
+	*	Draws the outline of every occupied cell, finer levels in a lighter colour
+	* Params:
+	*	<sf::RenderWindow* window>	-	window to draw the structure to
+	*/
+	void Draw(sf::RenderWindow* window);
+
+	// Private structures
+private:
+	/* struct Entry
+	 * Brief:
+	 *	sprite stored in a cell alongside the bounds it was binned with
+	*/
+	struct Entry
+	{
+		WireframeSprite* sprite;
+		float minX, minY;
+		float maxX, maxY;
+	};
+
+	/* struct Level
+	 * Brief:
+	 *	one grid of the hierarchy. The grid starts a cell before the window
+	 *	on each side so sprites wrapping around the edge still get their own cell.
+	*/
+	struct Level
+	{
+		float cellSize = 0.0f;				// Size in world pixels of each cell
+		int numXCells = 0;					// Number of cells in the X direction
+		int numYCells = 0;					// Number of cells in the Y direction
+		unsigned int firstCell = 0;			// index of the level's first cell in _cellStart
+		unsigned int nObjects = 0;			// sprites on the level this frame
+	};
+
+	// Private methods for internal use
+private:
+	// Returns the finest level with cells at least as big as the given size
+	unsigned int PickLevel(float size) const;
+
+	// Returns the cell coordinate on a level of a world position, clamped to the level
+	int ToCell(const Level& level, float value, int numCells) const;
+
+	// Returns the index in _cellStart of a cell on a level
+	unsigned int CellIndex(const Level& level, int x, int y) const { return level.firstCell + y * level.numXCells + x; }
+
+	// Members
+private:
+	std::vector<WireframeSprite*> _sprites;		// All sprites in the structure
+	std::vector<Level> _levels;					// Levels from finest to coarsest
+
+	// CSR layout shared by every level, rebuilt every frame
+	std::vector<unsigned int> _cellStart;		// offset of each cell's first sprite, one extra entry holds the total
+	std::vector<Entry> _entries;				// every sprite ordered by level then cell
+	std::vector<Entry> _pending;				// bounds of each sprite worked out on the counting pass
+	std::vector<unsigned int> _pendingCell;		// cell of each sprite worked out on the counting pass
+
+	sf::Color _gridColor = sf::Color::Blue;		// colour to draw the coarsest level
+
+	// constants
+	static constexpr unsigned int MAX_LEVELS = 8;	// Levels in the stack, the coarsest is far larger than the window
+};
@@ -0,0 +1,389 @@
+#include "LinearQuadTree.h"
+#include "../../../GameObjects/Base/WireframeSprite.h"
+#include <algorithm>
+#include <cmath>
+
+/* Constructor
+ * Brief:
+ *	Takes the region covered by the tree (left, top, width, height).
+ *	Sprites outside the region are clamped to its edge.
+ */
+LinearQuadTree::LinearQuadTree(sf::FloatRect region)
+	:
+	_region(region){}
+
+LinearQuadTree::~LinearQuadTree(){}
+
+/* void AddObject
+* Brief:
+*	Adds the sprite to the list of sprites sorted on the next call to update
+* Params:
+*	<WireframeSprite*> sprite	-	the sprite to add to the structure
+*/
+void LinearQuadTree::AddObject(WireframeSprite* sprite)
+{
+	this->_sprites.push_back(sprite);
+}
+
+/* void RemoveObject
+* Brief:
+*	Removes the sprite from the list of sprites with a swap delete,
+*	the sorted array is rebuilt on the next update.
+* Params:
+*	<WireframeSprite*> sprite	-	the sprite to remove from the structure
+*/
+void LinearQuadTree::RemoveObject(WireframeSprite* sprite)
+{
+	auto it = std::find(this->_sprites.begin(), this->_sprites.end(), sprite);
+
+	// sprite isn't in the structure
+	if (it == this->_sprites.end())
+		return;
+
+	*it = this->_sprites.back();
+	this->_sprites.pop_back();
+
+	// the sorted arrays still reference the sprite until the next update
+	this->_entries.clear();
+	this->_codes.clear();
+	this->_bounds.clear();
+	this->_sorted.clear();
+}
+
+/* void RemoveObjects
+* Brief:
+*	Removes every sprite in the list with one pass over the structure
+*	instead of one search per sprite. The list must be sorted by address.
+* Params:
+*	<const vector<WireframeSprite*>&> sprites	-	sorted sprites to remove from the structure
+*/
+void LinearQuadTree::RemoveObjects(const std::vector<WireframeSprite*>& sprites)
+{
+	if (sprites.empty())
+		return;
+
+	// keep every sprite not in the list, in order
+	unsigned int writeIndex = 0;
+	for (unsigned int i = 0; i < this->_sprites.size(); i++)
+	{
+		if (!std::binary_search(sprites.begin(), sprites.end(), this->_sprites[i]))
+			this->_sprites[writeIndex++] = this->_sprites[i];
+	}
+	this->_sprites.resize(writeIndex);
+
+	// the sorted arrays still reference the sprites until the next update
+	this->_entries.clear();
+	this->_codes.clear();
+	this->_bounds.clear();
+	this->_sorted.clear();
+}
+
+/* void Update
+* Brief:
+*	Calculates the morton code of every sprite and radix sorts them. The
+*	bounds and sprite pointers are then copied out in sorted order.
+*/
+void LinearQuadTree::Update()
+{
+	uint32_t count = static_cast<uint32_t>(this->_sprites.size());
+
+	this->_entries.resize(count);
+	this->_maxHalfWidth = 0.0f;
+	this->_maxHalfHeight = 0.0f;
+
+	// Create a code for the centre of every sprite
+	for (uint32_t i = 0; i < count; i++)
+	{
+		sf::FloatRect rect = this->_sprites[i]->GetBoundingRectangle();
+		float halfWidth = rect.width / 2;
+		float halfHeight = rect.height / 2;
+
+		this->_entries[i].code = this->CalculateCode(rect.left + halfWidth, rect.top + halfHeight);
+		this->_entries[i].sprite = i;
+
+		// track the largest sprite so queries know how far to expand
+		this->_maxHalfWidth = std::max(this->_maxHalfWidth, halfWidth);
+		this->_maxHalfHeight = std::max(this->_maxHalfHeight, halfHeight);
+	}
+
+	this->RadixSort();
+
+	// copy everything needed by the queries out in sorted order
+	this->_codes.resize(count);
+	this->_bounds.resize(count);
+	this->_sorted.resize(count);
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		WireframeSprite* sprite = this->_sprites[this->_entries[i].sprite];
+		sf::FloatRect rect = sprite->GetBoundingRectangle();
+
+		this->_codes[i] = this->_entries[i].code;
+		this->_bounds[i] = { rect.left, rect.top, rect.left + rect.width, rect.top + rect.height };
+		this->_sorted[i] = sprite;
+	}
+}
+
+/* void FindPairs
+* Brief:
+*	Walks the sorted array and queries the tree with the bounds of each sprite.
+*	Only sprites later in the sorted order are reported so each pair is
+*	found once. Pairs are only output if their bounds overlap.
+* Params:
+*	<vector<pair<wireframesprite*, wireframesprite*>>&> pairs	-	vector to store result to
+*/
+void LinearQuadTree::FindPairs(std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs)
+{
+	uint32_t count = static_cast<uint32_t>(this->_sorted.size());
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		this->_results.clear();
+		this->QueryRange(this->_bounds[i], i + 1, this->_results);
+
+		for (unsigned int r = 0; r < this->_results.size(); r++)
+			pairs.push_back({ this->_sorted[i], this->_sorted[this->_results[r]] });
+	}
+}
+
+/* void Query
+* Brief:
+*	finds all sprites whose bounds intersect the given range
+* Params:
+*	<FloatRect>					range	-	query range
+*	<vector<wireframesprite*>&> sprites	-	vector to store result to
+*/
+void LinearQuadTree::Query(sf::FloatRect range, std::vector<WireframeSprite*>& sprites)
+{
+	Bounds bounds = { range.left, range.top, range.left + range.width, range.top + range.height };
+
+	this->_results.clear();
+	this->QueryRange(bounds, 0, this->_results);
+
+	for (unsigned int r = 0; r < this->_results.size(); r++)
+		sprites.push_back(this->_sorted[this->_results[r]]);
+}
+
+/* void Draw
+* Brief:
+*	Draws every implicit node that holds more sprites than a leaf can
+* Params:
+*	<sf::RenderWindow* window>	-	window to draw the structure to
+*/
+void LinearQuadTree::Draw(sf::RenderWindow* window)
+{
+	sf::VertexArray lines(sf::Lines);
+
+	// outline of the root
+	sf::Vector2f topLeft(this->_region.left, this->_region.top);
+	sf::Vector2f topRight(this->_region.left + this->_region.width, this->_region.top);
+	sf::Vector2f bottomLeft(this->_region.left, this->_region.top + this->_region.height);
+	sf::Vector2f bottomRight(this->_region.left + this->_region.width, this->_region.top + this->_region.height);
+	lines.append(sf::Vertex(topLeft, this->_gridColor));
+	lines.append(sf::Vertex(topRight, this->_gridColor));
+	lines.append(sf::Vertex(topRight, this->_gridColor));
+	lines.append(sf::Vertex(bottomRight, this->_gridColor));
+	lines.append(sf::Vertex(bottomRight, this->_gridColor));
+	lines.append(sf::Vertex(bottomLeft, this->_gridColor));
+	lines.append(sf::Vertex(bottomLeft, this->_gridColor));
+	lines.append(sf::Vertex(topLeft, this->_gridColor));
+
+	this->_stack.clear();
+	this->_stack.push_back({ 0, 0, 0, static_cast<uint32_t>(this->_codes.size()) });
+
+	while (!this->_stack.empty())
+	{
+		Node node = this->_stack.back();
+		this->_stack.pop_back();
+
+		// leaves aren't split so have nothing to draw
+		if (node.end - node.begin <= LEAF_SIZE || node.depth >= MAX_DEPTH)
+			continue;
+
+		sf::FloatRect rect = this->GetNodeRect(node);
+		float x = rect.left, y = rect.top, width = rect.width, height = rect.height;
+
+		// cross dividing the node into its children
+		lines.append(sf::Vertex({ x + width / 2, y }, this->_gridColor));
+		lines.append(sf::Vertex({ x + width / 2, y + height }, this->_gridColor));
+		lines.append(sf::Vertex({ x, y + height / 2 }, this->_gridColor));
+		lines.append(sf::Vertex({ x + width, y + height / 2 }, this->_gridColor));
+
+		this->PushChildren(node);
+	}
+
+	window->draw(lines);
+}
+
+// Spreads the lower 16 bits of the value out to the even bits
+uint32_t LinearQuadTree::SpreadBits(uint32_t value)
+{
+	value &= 0x0000FFFF;
+	value = (value | (value << 8)) & 0x00FF00FF;
+	value = (value | (value << 4)) & 0x0F0F0F0F;
+	value = (value | (value << 2)) & 0x33333333;
+	value = (value | (value << 1)) & 0x55555555;
+	return value;
+}
+
+// Gathers the even bits of the value back into the lower 16 bits
+uint32_t LinearQuadTree::CompactBits(uint32_t value)
+{
+	value &= 0x55555555;
+	value = (value | (value >> 1)) & 0x33333333;
+	value = (value | (value >> 2)) & 0x0F0F0F0F;
+	value = (value | (value >> 4)) & 0x00FF00FF;
+	value = (value | (value >> 8)) & 0x0000FFFF;
+	return value;
+}
+
+// Works out the rectangle covered by an implicit node from its prefix
+sf::FloatRect LinearQuadTree::GetNodeRect(const Node& node) const
+{
+	uint32_t cells = 1u << node.depth;
+	float width = this->_region.width / cells;
+	float height = this->_region.height / cells;
+
+	// the prefix holds the node's cell coordinates in its top bits
+	float x = this->_region.left + (CompactBits(node.prefix) >> (16 - node.depth)) * width;
+	float y = this->_region.top + (CompactBits(node.prefix >> 1) >> (16 - node.depth)) * height;
+
+	return sf::FloatRect(x, y, width, height);
+}
+
+// Pushes the non empty children of a node, found by binary searching its range
+void LinearQuadTree::PushChildren(const Node& node)
+{
+	uint32_t shift = 30 - 2 * node.depth;
+	uint32_t begin = node.begin;
+
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		// each child ends where the codes of the next child begin
+		uint32_t end = node.end;
+		if (c < 3)
+		{
+			uint32_t nextPrefix = node.prefix + ((c + 1) << shift);
+			end = static_cast<uint32_t>(std::lower_bound(this->_codes.begin() + begin, this->_codes.begin() + node.end, nextPrefix) - this->_codes.begin());
+		}
+
+		if (end > begin)
+			this->_stack.push_back({ node.prefix + (c << shift), node.depth + 1, begin, end });
+		begin = end;
+	}
+}
+
+// Calculates the morton code of a position within the region
+uint32_t LinearQuadTree::CalculateCode(float x, float y) const
+{
+	// quantise to 16 bits, clamping anything outside the region to its edge
+	float fx = (x - this->_region.left) / this->_region.width * 65536.0f;
+	float fy = (y - this->_region.top) / this->_region.height * 65536.0f;
+	uint32_t qx = static_cast<uint32_t>(std::min(std::max(fx, 0.0f), 65535.0f));
+	uint32_t qy = static_cast<uint32_t>(std::min(std::max(fy, 0.0f), 65535.0f));
+
+	// x on the even bits, y on the odd bits
+	return SpreadBits(qx) | (SpreadBits(qy) << 1);
+}
+
+// Sorts _entries by code, least significant byte first
+void LinearQuadTree::RadixSort()
+{
+	uint32_t count = static_cast<uint32_t>(this->_entries.size());
+	this->_sortBuffer.resize(count);
+
+	for (uint32_t shift = 0; shift < 32; shift += 8)
+	{
+		// count how many codes fall in each bucket
+		uint32_t histogram[256] = {};
+		for (uint32_t i = 0; i < count; i++)
+			histogram[(this->_entries[i].code >> shift) & 0xFF]++;
+
+		// every code has the same byte, this pass wouldn't change the order
+		if (count == 0 || histogram[(this->_entries[0].code >> shift) & 0xFF] == count)
+			continue;
+
+		// turn the counts into starting offsets
+		uint32_t offset = 0;
+		for (uint32_t b = 0; b < 256; b++)
+		{
+			uint32_t bucketSize = histogram[b];
+			histogram[b] = offset;
+			offset += bucketSize;
+		}
+
+		// scatter into the buffer, stable so earlier passes are kept
+		for (uint32_t i = 0; i < count; i++)
+			this->_sortBuffer[histogram[(this->_entries[i].code >> shift) & 0xFF]++] = this->_entries[i];
+
+		this->_entries.swap(this->_sortBuffer);
+	}
+}
+
+/* void QueryRange
+* Brief:
+*	Collects the sorted index of every sprite whose centre could give bounds
+*	overlapping the range. Nodes are skipped if the range, expanded by the
+*	largest sprite half size, misses them.
+* Params:
+*	<const Bounds&>			range		-	query range
+*	<uint32_t>				firstIndex	-	sorted indices below this are ignored
+*	<vector<uint32_t>&>		results		-	vector to store result to
+*/
+void LinearQuadTree::QueryRange(const Bounds& range, uint32_t firstIndex, std::vector<uint32_t>& results)
+{
+	uint32_t count = static_cast<uint32_t>(this->_codes.size());
+	if (firstIndex >= count)
+		return;
+
+	// any sprite overlapping the range has its centre inside the expanded range
+	float minX = range.minX - this->_maxHalfWidth;
+	float minY = range.minY - this->_maxHalfHeight;
+	float maxX = range.maxX + this->_maxHalfWidth;
+	float maxY = range.maxY + this->_maxHalfHeight;
+
+	float regionRight = this->_region.left + this->_region.width;
+	float regionBottom = this->_region.top + this->_region.height;
+
+	this->_stack.clear();
+	this->_stack.push_back({ 0, 0, 0, count });
+
+	while (!this->_stack.empty())
+	{
+		Node node = this->_stack.back();
+		this->_stack.pop_back();
+
+		// node is entirely before the first index of interest
+		if (node.end <= firstIndex)
+			continue;
+
+		sf::FloatRect rect = this->GetNodeRect(node);
+		float nodeMinX = rect.left;
+		float nodeMinY = rect.top;
+		float nodeMaxX = rect.left + rect.width;
+		float nodeMaxY = rect.top + rect.height;
+
+		// nodes on the edge of the region also hold the clamped sprites beyond it
+		if (nodeMinX <= this->_region.left) nodeMinX = -INFINITY;
+		if (nodeMinY <= this->_region.top) nodeMinY = -INFINITY;
+		if (nodeMaxX >= regionRight) nodeMaxX = INFINITY;
+		if (nodeMaxY >= regionBottom) nodeMaxY = INFINITY;
+
+		if (minX > nodeMaxX || maxX < nodeMinX || minY > nodeMaxY || maxY < nodeMinY)
+			continue;
+
+		// small enough to scan, test the bounds of each sprite
+		if (node.end - node.begin <= LEAF_SIZE || node.depth >= MAX_DEPTH)
+		{
+			for (uint32_t i = std::max(node.begin, firstIndex); i < node.end; i++)
+			{
+				const Bounds& bounds = this->_bounds[i];
+				if (!(range.minX > bounds.maxX || range.maxX < bounds.minX || range.minY > bounds.maxY || range.maxY < bounds.minY))
+					results.push_back(i);
+			}
+			continue;
+		}
+
+		this->PushChildren(node);
+	}
+}
@@ -0,0 +1,179 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "SFML/Graphics.hpp"
+
+// class pre-definitions to save header space
+class WireframeSprite;
+
+/* class LinearQuadTree
+ *	Pointer free quadtree rebuilt every frame. The centre of each sprite is
+ *	quantised to 16 bits per axis and interleaved into a 32 bit morton code,
+ *	the codes are then radix sorted. Every node of the tree is implicit: a node
+ *	is the range of the sorted array sharing a code prefix, so the children of a
+ *	node are found by binary searching within the parent's range.
+ *	The sorted order keeps sprites that are close in space close in memory,
+ *	so the pair search iterates the sorted array directly.
+*/
+class LinearQuadTree
+{
+	// Public interface
+public:
+	/* Constructor
+	 * Brief:
+	 *	Takes the region covered by the tree (left, top, width, height).
+	 *	Sprites outside the region are clamped to its edge.
+	 */
+	LinearQuadTree(sf::FloatRect region);
+	~LinearQuadTree();
+
+	/* void AddObject
+	* Brief:
+	*	Adds the sprite to the list of sprites sorted on the next call to update
+	* Params:
+	*	<WireframeSprite*> sprite	-	the sprite to add to the structure
+	*/
+	void AddObject(WireframeSprite* sprite);
+
+	/* void RemoveObject
+	* Brief:
+	*	Removes the sprite from the list of sprites with a swap delete,
+	*	the sorted array is rebuilt on the next update.
+	* Params:
+	*	<WireframeSprite*> sprite	-	the sprite to remove from the structure
+	*/
+	void RemoveObject(WireframeSprite* sprite);
+
+	/* void RemoveObjects
+	* Brief:
+	*	Removes every sprite in the list with one pass over the structure
+	*	instead of one search per sprite. The list must be sorted by address.
+	* Params:
+	*	<const vector<WireframeSprite*>&> sprites	-	sorted sprites to remove from the structure
+	*/
+	void RemoveObjects(const std::vector<WireframeSprite*>& sprites);
+
+	/* void Update
+	* Brief:
+	*	Calculates the morton code of every sprite and radix sorts them. The
+	*	bounds and sprite pointers are then copied out in sorted order.
+	*/
+	void Update();
+
+	/* void FindPairs
+	* Brief:
+	*	Walks the sorted array and queries the tree with the bounds of each sprite.
+	*	Only sprites later in the sorted order are reported so each pair is
+	*	found once. Pairs are only output if their bounds overlap.
+	* Params:
+	*	<vector<pair<wireframesprite*, wireframesprite*>>&> pairs	-	vector to store result to
+	*/
+	void FindPairs(std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs);
+
+	/* void Query
+	* Brief:
+	*	finds all sprites whose bounds intersect the given range
+	* Params:
+	*	<FloatRect>					range	-	query range
+	*	<vector<wireframesprite*>&> sprites	-	vector to store result to
+	*/
+	void Query(sf::FloatRect range, std::vector<WireframeSprite*>& sprites);
+
+	/* void Draw
+	* Brief:
+	*	Draws every implicit node that holds more sprites than a leaf can
+	* Params:
+	*	<sf::RenderWindow* window>	-	window to draw the structure to
+	*/
+	void Draw(sf::RenderWindow* window);
+
+	// Private structures
+private:
+	/* struct Entry
+	 * Brief:
+	 *	key / value pair sorted by the radix sort
+	*/
+	struct Entry
+	{
+		uint32_t code;						// morton code of the sprite's centre
+		uint32_t sprite;					// index of the sprite in _sprites
+	};
+
+	/* struct Bounds
+	 * Brief:
+	 *	min / max box of a sprite, stored in sorted order
+	*/
+	struct Bounds
+	{
+		float minX, minY;
+		float maxX, maxY;
+	};
+
+	/* struct Node
+	 * Brief:
+	 *	implicit node on the traversal stack, the prefix identifies the
+	 *	node and begin / end are its range in the sorted array
+	*/
+	struct Node
+	{
+		uint32_t prefix;					// code of the node's first possible sprite
+		uint32_t depth;						// depth of the node (root = 0)
+		uint32_t begin;						// first sorted index in the node
+		uint32_t end;						// one past the last sorted index in the node
+	};
+
+	// Private methods for internal use
+private:
+	// Spreads the lower 16 bits of the value out to the even bits
+	static uint32_t SpreadBits(uint32_t value);
+
+	// Gathers the even bits of the value back into the lower 16 bits
+	static uint32_t CompactBits(uint32_t value);
+
+	// Works out the rectangle covered by an implicit node from its prefix
+	sf::FloatRect GetNodeRect(const Node& node) const;
+
+	// Pushes the non empty children of a node, found by binary searching its range
+	void PushChildren(const Node& node);
+
+	// Calculates the morton code of a position within the region
+	uint32_t CalculateCode(float x, float y) const;
+
+	// Sorts _entries by code, least significant byte first
+	void RadixSort();
+
+	/* void QueryRange
+	* Brief:
+	*	Collects the sorted index of every sprite whose centre could give bounds
+	*	overlapping the range. Nodes are skipped if the range, expanded by the
+	*	largest sprite half size, misses them.
+	* Params:
+	*	<const Bounds&>			range		-	query range
+	*	<uint32_t>				firstIndex	-	sorted indices below this are ignored
+	*	<vector<uint32_t>&>		results		-	vector to store result to
+	*/
+	void QueryRange(const Bounds& range, uint32_t firstIndex, std::vector<uint32_t>& results);
+
+	// Members
+private:
+	sf::FloatRect _region;						// Region covered by the tree
+	std::vector<WireframeSprite*> _sprites;		// All sprites in the structure, unsorted
+
+	std::vector<Entry> _entries;				// codes of the sprites, sorted on update
+	std::vector<Entry> _sortBuffer;				// ping pong buffer for the radix sort
+	std::vector<uint32_t> _codes;				// sorted codes, searched to find node ranges
+	std::vector<Bounds> _bounds;				// bounds of the sprites in sorted order
+	std::vector<WireframeSprite*> _sorted;		// sprites in sorted order
+
+	float _maxHalfWidth = 0.0f;					// largest half width of any sprite this update
+	float _maxHalfHeight = 0.0f;				// largest half height of any sprite this update
+
+	std::vector<Node> _stack;					// Traversal stack reused between queries
+	std::vector<uint32_t> _results;				// Query results reused between queries
+	sf::Color _gridColor = sf::Color::Blue;		// colour to draw the tree
+
+	// constants
+	static constexpr uint32_t LEAF_SIZE = 8;	// Nodes with this many sprites or less are scanned directly
+	static constexpr uint32_t MAX_DEPTH = 16;	// Depth at which the code has no more bits to split on
+};
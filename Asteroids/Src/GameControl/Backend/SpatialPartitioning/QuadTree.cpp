@@ -1,112 +1,118 @@
 #include "QuadTree.h"
 #include "../../../GameObjects/Base/WireframeSprite.h"
 #include <algorithm>
+#include <cmath>
 
 
 /* Constructor
  * Brief:
- *	sets up the rectangle shape with default parameters, assigns the
- *	internal boundary and assigns the internal capacity needed before splitting
+ *	Creates the root node from the boundary (centre and half size), assigns
+ *	the internal capacity needed before splitting. The looseness factor
+ *	scales the boundary to give the loose bounds of each node
  */
-QuadTree::QuadTree(sf::FloatRect boundary, unsigned int capacity)
+QuadTree::QuadTree(sf::FloatRect boundary, unsigned int capacity, float looseness)
 	:
-_boundary(boundary),
-_capacity(capacity){
+_freeItem(NULL_INDEX),
+_capacity(capacity),
+_looseness(looseness){
 
-	this->_rect.setFillColor(sf::Color::Transparent);
-	this->_rect.setOutlineColor(_gridColor);
-	this->_rect.setOutlineThickness(1);
+	// Create the root node
+	Node root;
+	root.centreX = boundary.left;
+	root.centreY = boundary.top;
+	root.halfWidth = boundary.width;
+	root.halfHeight = boundary.height;
+	root.firstChild = NULL_INDEX;
+	root.parent = NULL_INDEX;
+	root.firstItem = NULL_INDEX;
+	root.itemCount = 0;
+	root.depth = 0;
 
-	this->_rect.setPosition({ boundary.left - boundary.width, boundary.top - boundary.height });
-	this->_rect.setSize({ boundary.width*2, boundary.height*2 });
+	this->_nodes.push_back(root);
 }
 
 /* Destructor
 * Brief:
-*	deletes any children trees if this node has divided
+*	node and item pools are released with the tree
 */
-QuadTree::~QuadTree()
-{
-	if (this->_isDivided)
-	{
-		delete this->_nw;
-		delete this->_ne;
-		delete this->_sw;
-		delete this->_se;
-	}
-}
+QuadTree::~QuadTree(){}
 
 /*void AddObject
 * Brief:
-*	Takes a pointer to a wire frame sprite and adds it to the appropriate container
-*	within the structure. calls itself recursively on children so it will be stored in
-*	the correct node of the global structure.
+*	Takes a pointer to a wire frame sprite and adds it to the appropriate node
+*	within the structure. Descends from the root into the child containing the
+*	sprite's centre for as long as the sprite fits in that child's loose bounds.
 * *Params:
 * <WireframeSprite& > sprite	- the sprite to add to the tree structure
 */
 void QuadTree::AddObject(WireframeSprite* sprite)
 {
-	sf::Vector2f pos = sprite->GetPosition();
-	if (!this->Contains(pos))
-		return;
-
-	// node has capacity, just add to sprites
-	if (this->_sprites.size() < this->_capacity)
-	{
-		this->_sprites.push_back(sprite);
-		sprite->SetOwnerTree(this);
-	}
-	// There's no room in this node
-	else
-	{
-		// if no children yet make them
-		if (!this->_isDivided)
-			this->SubDivide();
-
-		// pass object to children
-		this->_nw->AddObject(sprite);
-		this->_ne->AddObject(sprite);
-		this->_sw->AddObject(sprite);
-		this->_se->AddObject(sprite);
-	}
+	this->AddFrom(0, sprite, sprite->GetBoundingRectangle());
 }
 
-/*void AddObject
+/*void RemoveObject
 * Brief:
 *	Takes a pointer to a wire frame sprite and removes it from the stored
-*	 location in the tree. calls itself recursively on children to find the right
-*	container
+*	location in the tree. The owner item index on the sprite is used
+*	to unlink it from its node without searching.
 * <WireframeSprite& > sprite	- the sprite to remove from the tree
 */
 void QuadTree::RemoveObject(WireframeSprite* sprite)
 {
-	// Check that object is within quadtree bounds
-	sf::Vector2f pos = sprite->GetPosition();
-	if (!this->Contains(pos))
+	int item = sprite->GetOwnerTreeItem();
+	if (item < 0)
 		return;
 
-	// Check if this is the owner tree
-	if (sprite->GetOwnerTree() == this)
-	{
-		// Erase sprite from the container
-		this->_sprites.erase(std::find(this->_sprites.begin(), this->_sprites.end(), sprite));
-		sprite->SetOwnerTree(nullptr);
-	}
+	this->UnlinkItem(static_cast<uint32_t>(item));
+	this->FreeItem(static_cast<uint32_t>(item));
+	sprite->SetOwnerTreeItem(-1);
+}
 
-	// Remove object from children
-	else if (this->_isDivided)
+/*void UpdateObject
+* Brief:
+*	Called after a sprite has moved. If the sprite still fits in the loose
+*	bounds of its owner node nothing changes. Otherwise it's removed and the tree
+*	is climbed until a node that can hold it is found, it's then re-added from there.
+* <WireframeSprite& > sprite	- the sprite that has moved
+*/
+void QuadTree::UpdateObject(WireframeSprite* sprite)
+{
+	int item = sprite->GetOwnerTreeItem();
+
+	// not in the tree yet, add from the top
+	if (item < 0)
 	{
-		this->_nw->RemoveObject(sprite);
-		this->_ne->RemoveObject(sprite);
-		this->_sw->RemoveObject(sprite);
-		this->_se->RemoveObject(sprite);
+		this->AddObject(sprite);
+		return;
 	}
+
+	uint32_t owner = this->_items[item].node;
+
+	// The root holds anything that doesn't fit elsewhere so always counts as fitting
+	sf::FloatRect bounds = sprite->GetBoundingRectangle();
+	bool fitsOwner = owner == 0 || this->LooseContains(owner, bounds);
+
+	// Still inside the loose bounds and can't move down to a child, no need to move
+	if (fitsOwner && !(this->_nodes[owner].firstChild != NULL_INDEX && this->GetChildFor(owner, bounds) != NULL_INDEX))
+		return;
+
+	// unlink from the owner, the item itself is reused
+	this->UnlinkItem(static_cast<uint32_t>(item));
+	this->FreeItem(static_cast<uint32_t>(item));
+	sprite->SetOwnerTreeItem(-1);
+
+	// climb until a node is found that can hold the sprite
+	uint32_t node = owner;
+	while (node != 0 && !this->LooseContains(node, bounds))
+		node = this->_nodes[node].parent;
+
+	this->AddFrom(node, sprite, bounds);
 }
 
 /* void Query
 * Brief:
-*	queries the tree recursively to find all wireframe sprites within a given range.
-*	these sprites from each tree are added to the sprites reference vector that is
+*	queries the tree to find all wireframe sprites within a given range.
+*	these sprites from each node are added to the sprites reference vector that is
 *	passed as a parameter. This therefore means the output of the method is stored
 *	in the referenced parameter.
 * Params:
@@ -115,129 +121,517 @@ void QuadTree::RemoveObject(WireframeSprite* sprite)
 */
 void QuadTree::Query(sf::FloatRect range, std::vector<WireframeSprite*>& sprites)
 {
-	// if this boundary doesn't intersect the range just return
-	if (!this->Intersects(range))
-		return;
+	this->_stack.clear();
+	this->_stack.push_back(0);
 
-
-	// if it does add the points from this quadtree that are contained within the range
-	else
+	while (!this->_stack.empty())
 	{
-		for (unsigned int i = 0; i < this->_sprites.size(); i++)
+		uint32_t nodeIndex = this->_stack.back();
+		this->_stack.pop_back();
+
+		// if this loose boundary doesn't intersect the range skip the branch
+		if (!this->Intersects(nodeIndex, range))
+			continue;
+
+		const Node& node = this->_nodes[nodeIndex];
+
+		// add the sprites from this node that are contained within the range
+		for (uint32_t item = node.firstItem; item != NULL_INDEX; item = this->_items[item].next)
 		{
 			// Broad phase test for if there's any point checking for further collision
 			// AABB
-			if (_sprites[i]->GetBoundingRectangle().intersects(range))
-				sprites.push_back(_sprites[i]);	// push back the sprite for narrow phase collision
+			WireframeSprite* sprite = this->_items[item].sprite;
+			if (sprite->GetBoundingRectangle().intersects(range))
+				sprites.push_back(sprite);	// push back the sprite for narrow phase collision
+		}
+
+		// If this node has divided also query the children to find more
+		// possibly colliding objects
+		if (node.firstChild != NULL_INDEX)
+		{
+			for (uint32_t i = 0; i < 4; i++)
+				this->_stack.push_back(node.firstChild + i);
+		}
+	}
+}
+
+/* void FindPairs
+* Brief:
+*	Self overlap query of the tree in a single walk. Each node's sprites are
+*	tested against each other and against a list of candidates passed down to
+*	it: the sprites of its ancestors and of its earlier siblings' subtrees
+*	(loose nodes overlap their siblings) that reach into its loose bounds.
+*	A sprite lives in one node so every overlapping pair is reported exactly once.
+*	Pairs are only output if their bounds overlap.
+* Params:
+*	<vector<pair<wireframesprite*, wireframesprite*>>&> pairs	-	vector to store result to
+*/
+void QuadTree::FindPairs(std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs)
+{
+	this->_pairCandidates.clear();
+	this->FindPairsFrom(0, 0, pairs);
+}
+
+/* void RayCast
+* Brief:
+*	Reports every sprite hit by the ray to the callback, nearest first, until
+*	the callback returns false or max distance is reached. Nodes are visited
+*	in order of where the ray enters their loose bounds, and a hit is reported
+*	once no unvisited node could hold anything nearer.
+* Params:
+*	<const sf::Vector2f&>	origin		-	start of the ray
+*	<const sf::Vector2f&>	direction	-	direction of the ray, doesn't need to be unit length
+*	<float>					maxDistance	-	length of the ray
+*	<RayCast::HitCallback>	callback	-	called for each sprite hit with its distance from the origin
+*	<void*>					context		-	passed through to the callback
+*/
+void QuadTree::RayCast(const sf::Vector2f& origin, const sf::Vector2f& direction, float maxDistance, RayCast::HitCallback callback, void* context)
+{
+	float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+	if (length == 0.0f)
+		return;
+
+	this->SegmentQuery(origin, origin + direction * (maxDistance / length), callback, context);
+}
+
+/* void SegmentQuery
+* Brief:
+*	Same as RayCast but for the segment between two points
+* Params:
+*	<const sf::Vector2f&>	start		-	start of the segment
+*	<const sf::Vector2f&>	end			-	end of the segment
+*	<RayCast::HitCallback>	callback	-	called for each sprite hit with its distance from the start
+*	<void*>					context		-	passed through to the callback
+*/
+void QuadTree::SegmentQuery(const sf::Vector2f& start, const sf::Vector2f& end, RayCast::HitCallback callback, void* context)
+{
+	float length = std::sqrt((end.x - start.x) * (end.x - start.x) + (end.y - start.y) * (end.y - start.y));
+
+	std::vector<NodeEntry>& nodes = this->_queryNodes;
+	std::vector<RayCast::Hit>& hits = this->_queryHits;
+	nodes.clear();
+	hits.clear();
+
+	// the root holds anything that doesn't fit elsewhere so it's always visited
+	nodes.push_back({ 0, 0.0f });
+
+	while (!nodes.empty())
+	{
+		std::pop_heap(nodes.begin(), nodes.end(), FurtherThan);
+		NodeEntry entry = nodes.back();
+		nodes.pop_back();
+
+		// nothing left to visit can hold a hit nearer than the node being entered
+		while (!hits.empty() && hits.front().distance <= entry.distance)
+		{
+			std::pop_heap(hits.begin(), hits.end(), RayCast::FurtherThan);
+			RayCast::Hit hit = hits.back();
+			hits.pop_back();
+
+			if (!callback(context, hit.sprite, hit.distance))
+				return;
+		}
+
+		const Node& node = this->_nodes[entry.node];
+
+		// test the sprites stored in this node
+		for (uint32_t item = node.firstItem; item != NULL_INDEX; item = this->_items[item].next)
+		{
+			WireframeSprite* sprite = this->_items[item].sprite;
+
+			float t;
+			if (RayCast::IntersectPolygon(start, end, sprite->GetPoints(), t))
+			{
+				hits.push_back({ sprite, t * length });
+				std::push_heap(hits.begin(), hits.end(), RayCast::FurtherThan);
+			}
+		}
+
+		// queue the children the segment passes through
+		if (node.firstChild != NULL_INDEX)
+		{
+			for (uint32_t i = 0; i < 4; i++)
+			{
+				uint32_t child = node.firstChild + i;
+				const Node& childNode = this->_nodes[child];
+				float looseWidth = childNode.halfWidth * this->_looseness;
+				float looseHeight = childNode.halfHeight * this->_looseness;
+
+				float t;
+				if (RayCast::IntersectRect(start, end,
+					childNode.centreX - looseWidth, childNode.centreY - looseHeight,
+					childNode.centreX + looseWidth, childNode.centreY + looseHeight, t))
+				{
+					nodes.push_back({ child, t * length });
+					std::push_heap(nodes.begin(), nodes.end(), FurtherThan);
+				}
+			}
 		}
 	}
 
-	// If this node has divided also query the children to find more
-	// possibly colliding objects
-	if (this->_isDivided)
+	// every node has been visited, report the rest
+	while (!hits.empty())
 	{
-		this->_nw->Query(range, sprites);
-		this->_ne->Query(range, sprites);
-		this->_sw->Query(range, sprites);
-		this->_se->Query(range, sprites);
+		std::pop_heap(hits.begin(), hits.end(), RayCast::FurtherThan);
+		RayCast::Hit hit = hits.back();
+		hits.pop_back();
+
+		if (!callback(context, hit.sprite, hit.distance))
+			return;
 	}
 }
 
 /* void Clear
  * Brief:
- *	Clears all the sprites held by the current quad tree (this) and
- *	deletes all of it's children. Whenever a quad tree is deleted all of it's subsequent
- *	children are also deleted
- *	therefore any branch lower than the node that clear is called upon will be deleted.
- *	Calling this on the root node therefore clears the entire tree.
+ *	Removes every sprite and node apart from the root. The pools keep their
+ *	memory so the tree can be refilled without allocating.
+ *	The owner item of every removed sprite is reset so it can be re-added later.
 */
 void QuadTree::Clear()
 {
-	// if tree has children, recursively delete the children also
-	if (this->_isDivided)
+	// reset the owners of all sprites still linked into a node
+	for (unsigned int i = 0; i < this->_nodes.size(); i++)
 	{
-		delete this->_nw;
-		delete this->_ne;
-		delete this->_sw;
-		delete this->_se;
-
-		this->_isDivided = false;
+		for (uint32_t item = this->_nodes[i].firstItem; item != NULL_INDEX; item = this->_items[item].next)
+			this->_items[item].sprite->SetOwnerTreeItem(-1);
 	}
 
-	// clear sprites of this node as it's not deleted
-	this->_sprites.clear();
+	// drop everything but the root
+	this->_nodes.resize(1);
+	this->_nodes[0].firstChild = NULL_INDEX;
+	this->_nodes[0].firstItem = NULL_INDEX;
+	this->_nodes[0].itemCount = 0;
+
+	this->_items.clear();
+	this->_freeItem = NULL_INDEX;
 }
 
 /* void SubDivide
 * Brief:
-*	If the isDivided flag for this node hasn't already been set to true,
-*	the method will create a new quad tree for each child member and then set
-*	the isDivided flag to true.
+*	Appends a block of four children for the node to the node pool and
+*	pushes down any of the node's sprites that fit in a child.
+* Params:
+*	<uint32_t> node	-	index of the leaf to split
 */
-void QuadTree::SubDivide()
+void QuadTree::SubDivide(uint32_t node)
 {
-	// local variables to help readability
-	using namespace sf;
-	float x = this->_boundary.left;
-	float y = this->_boundary.top;
-	float w = this->_boundary.width;
-	float h = this->_boundary.height;
+	// local copy as the pool may reallocate when children are appended
+	Node parent = this->_nodes[node];
+	float w = parent.halfWidth / 2;
+	float h = parent.halfHeight / 2;
+
+	// Calculate boundaries for children (nw, ne, sw, se)
+	const float offsets[4][2] = { { -w, -h }, { w, -h }, { -w, h }, { w, h } };
+
+	uint32_t firstChild = static_cast<uint32_t>(this->_nodes.size());
+	for (int i = 0; i < 4; i++)
+	{
+		Node child;
+		child.centreX = parent.centreX + offsets[i][0];
+		child.centreY = parent.centreY + offsets[i][1];
+		child.halfWidth = w;
+		child.halfHeight = h;
+		child.firstChild = NULL_INDEX;
+		child.parent = node;
+		child.firstItem = NULL_INDEX;
+		child.itemCount = 0;
+		child.depth = parent.depth + 1;
 
-	// Calculate boundaries for children
-	FloatRect neBoundary = FloatRect(x+w/2, y-h/2, w/2, h/2);
-	FloatRect nwBoundary = FloatRect(x-w/2, y-h/2, w/2, h/2);
-	FloatRect seBoundary = FloatRect(x+w/2, y+h/2, w/2, h/2);
-	FloatRect swBoundary = FloatRect(x-w/2, y+h/2, w/2, h/2);
-	
-	// Create the children
-	this->_nw = new QuadTree(nwBoundary, this->_capacity);
-	this->_ne = new QuadTree(neBoundary, this->_capacity);
-	this->_sw = new QuadTree(swBoundary, this->_capacity);
-	this->_se = new QuadTree(seBoundary, this->_capacity);
+		this->_nodes.push_back(child);
+	}
+
+	// indicate this node has divided
+	this->_nodes[node].firstChild = firstChild;
 
-	// indicate this quadtree has divided
-	this->_isDivided = true;
+	// push down any sprites small enough to fit in a child
+	uint32_t item = this->_nodes[node].firstItem;
+	while (item != NULL_INDEX)
+	{
+		uint32_t next = this->_items[item].next;
+		WireframeSprite* sprite = this->_items[item].sprite;
+		sf::FloatRect bounds = sprite->GetBoundingRectangle();
+
+		uint32_t child = this->GetChildFor(node, bounds);
+		if (child != NULL_INDEX)
+		{
+			// move the existing item over to the child
+			this->UnlinkItem(item);
+			this->LinkItem(child, item);
+
+			// child can go over capacity as well
+			Node& childNode = this->_nodes[child];
+			if (childNode.firstChild == NULL_INDEX && childNode.itemCount > this->_capacity && childNode.depth < MAX_DEPTH)
+				this->SubDivide(child);
+		}
+
+		item = next;
+	}
+}
+
+// Stores the sprite in the node, subdividing if the node goes over capacity
+void QuadTree::Insert(uint32_t node, WireframeSprite* sprite)
+{
+	uint32_t item = this->AllocateItem();
+	this->_items[item].sprite = sprite;
+	this->LinkItem(node, item);
+	sprite->SetOwnerTreeItem(static_cast<int>(item));
+
+	// over capacity, split the leaf so its sprites can be spread out
+	const Node& target = this->_nodes[node];
+	if (target.firstChild == NULL_INDEX && target.itemCount > this->_capacity && target.depth < MAX_DEPTH)
+		this->SubDivide(node);
+}
+
+// Descends from the node and inserts the sprite in the deepest node that can hold it
+void QuadTree::AddFrom(uint32_t node, WireframeSprite* sprite, const sf::FloatRect& bounds)
+{
+	while (this->_nodes[node].firstChild != NULL_INDEX)
+	{
+		uint32_t child = this->GetChildFor(node, bounds);
+		if (child == NULL_INDEX)
+			break;
+		node = child;
+	}
+
+	this->Insert(node, sprite);
 }
 
+/* void FindPairsFrom
+* Brief:
+*	Pairs the node's sprites with each other and with the candidates passed
+*	down to it, then recurses into its children
+* Params:
+*	<uint32_t>	node			-	index of the node to visit
+*	<size_t>	firstCandidate	-	the candidates from the end of the list back to here reach the node
+*	<vector<pair<wireframesprite*, wireframesprite*>>&> pairs	-	vector to store result to
+*/
+void QuadTree::FindPairsFrom(uint32_t node, size_t firstCandidate, std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs)
+{
+	std::vector<PairCandidate>& candidates = this->_pairCandidates;
+	size_t firstOwn = candidates.size();
+
+	// test each of the node's sprites against the candidates and the node's sprites before it
+	for (uint32_t item = this->_nodes[node].firstItem; item != NULL_INDEX; item = this->_items[item].next)
+	{
+		PairCandidate own;
+		own.sprite = this->_items[item].sprite;
+		own.bounds = own.sprite->GetBoundingRectangle();
+
+		for (size_t i = firstCandidate; i < candidates.size(); i++)
+		{
+			if (candidates[i].bounds.intersects(own.bounds))
+				pairs.push_back(std::make_pair(candidates[i].sprite, own.sprite));
+		}
+
+		candidates.push_back(own);
+	}
+
+	uint32_t firstChild = this->_nodes[node].firstChild;
+	if (firstChild == NULL_INDEX)
+	{
+		candidates.resize(firstOwn);
+		return;
+	}
+
+	size_t lastCandidate = candidates.size();
+	for (uint32_t child = firstChild; child < firstChild + 4; child++)
+	{
+		// pass down only the sprites that reach into the child's loose bounds
+		size_t childFirst = candidates.size();
+		for (size_t i = firstCandidate; i < lastCandidate; i++)
+		{
+			if (this->Intersects(child, candidates[i].bounds))
+			{
+				PairCandidate candidate = candidates[i];
+				candidates.push_back(candidate);
+			}
+		}
+
+		// the earlier siblings have already been visited, so their sprites are
+		// paired with this child here and this child's are never paired back
+		for (uint32_t sibling = firstChild; sibling < child; sibling++)
+			this->CollectCandidates(sibling, child);
+
+		this->FindPairsFrom(child, childFirst, pairs);
+		candidates.resize(childFirst);
+	}
+
+	candidates.resize(firstOwn);
+}
+
+// Adds the sprites in the subtree that reach into the target's loose bounds to the pair candidates
+void QuadTree::CollectCandidates(uint32_t subtree, uint32_t target)
+{
+	const Node& targetNode = this->_nodes[target];
+	sf::FloatRect targetBounds(
+		targetNode.centreX - targetNode.halfWidth * this->_looseness,
+		targetNode.centreY - targetNode.halfHeight * this->_looseness,
+		targetNode.halfWidth * this->_looseness * 2,
+		targetNode.halfHeight * this->_looseness * 2);
+
+	this->_stack.clear();
+	this->_stack.push_back(subtree);
+
+	while (!this->_stack.empty())
+	{
+		uint32_t nodeIndex = this->_stack.back();
+		this->_stack.pop_back();
+
+		// nothing below a node can reach the target if the loose bounds don't touch
+		if (!this->Intersects(nodeIndex, targetBounds))
+			continue;
+
+		const Node& node = this->_nodes[nodeIndex];
+		for (uint32_t item = node.firstItem; item != NULL_INDEX; item = this->_items[item].next)
+		{
+			PairCandidate candidate;
+			candidate.sprite = this->_items[item].sprite;
+			candidate.bounds = candidate.sprite->GetBoundingRectangle();
+
+			if (this->Intersects(target, candidate.bounds))
+				this->_pairCandidates.push_back(candidate);
+		}
+
+		if (node.firstChild != NULL_INDEX)
+		{
+			for (uint32_t i = 0; i < 4; i++)
+				this->_stack.push_back(node.firstChild + i);
+		}
+	}
+}
+
+// Links an item at the head of a node's list
+void QuadTree::LinkItem(uint32_t node, uint32_t item)
+{
+	Node& owner = this->_nodes[node];
+
+	this->_items[item].node = node;
+	this->_items[item].prev = NULL_INDEX;
+	this->_items[item].next = owner.firstItem;
+
+	if (owner.firstItem != NULL_INDEX)
+		this->_items[owner.firstItem].prev = item;
+
+	owner.firstItem = item;
+	owner.itemCount++;
+}
+
+// Unlinks an item from its node's list
+void QuadTree::UnlinkItem(uint32_t item)
+{
+	Item& entry = this->_items[item];
+	Node& owner = this->_nodes[entry.node];
+
+	if (entry.prev != NULL_INDEX)
+		this->_items[entry.prev].next = entry.next;
+	else
+		owner.firstItem = entry.next;
+
+	if (entry.next != NULL_INDEX)
+		this->_items[entry.next].prev = entry.prev;
+
+	owner.itemCount--;
+}
+
+// Takes an item from the free list, growing the pool if needed
+uint32_t QuadTree::AllocateItem()
+{
+	if (this->_freeItem == NULL_INDEX)
+	{
+		Item item;
+		item.sprite = nullptr;
+		item.node = NULL_INDEX;
+		item.prev = NULL_INDEX;
+		item.next = NULL_INDEX;
+		this->_items.push_back(item);
+		return static_cast<uint32_t>(this->_items.size() - 1);
+	}
+
+	uint32_t item = this->_freeItem;
+	this->_freeItem = this->_items[item].next;
+	return item;
+}
+
+// Returns an item to the free list
+void QuadTree::FreeItem(uint32_t item)
+{
+	this->_items[item].sprite = nullptr;
+	this->_items[item].node = NULL_INDEX;
+	this->_items[item].next = this->_freeItem;
+	this->_freeItem = item;
+}
 
 /* void Draw
 * Brief:
-*	Draws the tree's rectangle shape recursively on any child node below it
-*	Drawing from the super node will therefore draw the entire structure.
+*	Builds the outline of every node from the node pool and draws
+*	it, the debug geometry only exists while drawing.
 * Params:
 *	<sf::RenderWindow* window>	-	window to draw the structure to
 */
 void QuadTree::Draw(sf::RenderWindow* window)
 {
-	// Draw this quadtree
-	window->draw(this->_rect);
+	sf::VertexArray lines(sf::Lines);
 
-	// Draw children quadtrees
-	if (this->_isDivided)
+	for (unsigned int i = 0; i < this->_nodes.size(); i++)
 	{
-		this->_nw->Draw(window);
-		this->_ne->Draw(window);
-		this->_sw->Draw(window);
-		this->_se->Draw(window);
+		const Node& node = this->_nodes[i];
+		sf::Vector2f topLeft(node.centreX - node.halfWidth, node.centreY - node.halfHeight);
+		sf::Vector2f topRight(node.centreX + node.halfWidth, node.centreY - node.halfHeight);
+		sf::Vector2f bottomLeft(node.centreX - node.halfWidth, node.centreY + node.halfHeight);
+		sf::Vector2f bottomRight(node.centreX + node.halfWidth, node.centreY + node.halfHeight);
+
+		// four edges of the node
+		lines.append(sf::Vertex(topLeft, this->_gridColor));
+		lines.append(sf::Vertex(topRight, this->_gridColor));
+		lines.append(sf::Vertex(topRight, this->_gridColor));
+		lines.append(sf::Vertex(bottomRight, this->_gridColor));
+		lines.append(sf::Vertex(bottomRight, this->_gridColor));
+		lines.append(sf::Vertex(bottomLeft, this->_gridColor));
+		lines.append(sf::Vertex(bottomLeft, this->_gridColor));
+		lines.append(sf::Vertex(topLeft, this->_gridColor));
 	}
+
+	window->draw(lines);
+}
+
+// Returns the child the bounds should be filed in or NULL_INDEX if it doesn't fit in any
+uint32_t QuadTree::GetChildFor(uint32_t node, const sf::FloatRect& bounds) const
+{
+	const Node& parent = this->_nodes[node];
+
+	// pick the quadrant containing the centre of the bounds
+	float centreX = bounds.left + bounds.width / 2;
+	float centreY = bounds.top + bounds.height / 2;
+
+	uint32_t quadrant = (centreX >= parent.centreX ? 1 : 0) + (centreY >= parent.centreY ? 2 : 0);
+	uint32_t child = parent.firstChild + quadrant;
+
+	// the sprite only belongs to the child if it fits the loose bounds
+	return this->LooseContains(child, bounds) ? child : NULL_INDEX;
 }
 
-// Returns true if the position point passed in in contained within the tree's boundary
-bool QuadTree::Contains(sf::Vector2f& pos)
+// Returns true if the rect fits entirely within the node's loose boundary
+bool QuadTree::LooseContains(uint32_t node, const sf::FloatRect& rect) const
 {
-	return (pos.x >= this->_boundary.left - this->_boundary.width &&
-		pos.x <= this->_boundary.left + this->_boundary.width &&
-		pos.y >= this->_boundary.top - this->_boundary.height &&
-		pos.y <= this->_boundary.top + this->_boundary.height);
+	const Node& n = this->_nodes[node];
+	float looseWidth = n.halfWidth * this->_looseness;
+	float looseHeight = n.halfHeight * this->_looseness;
+
+	return (rect.left >= n.centreX - looseWidth &&
+		rect.left + rect.width <= n.centreX + looseWidth &&
+		rect.top >= n.centreY - looseHeight &&
+		rect.top + rect.height <= n.centreY + looseHeight);
 }
 
-// Returns true if the given range intersects with the tree's boundary
-bool QuadTree::Intersects(sf::FloatRect rect)
+// Returns true if the given range intersects with the node's loose boundary
+bool QuadTree::Intersects(uint32_t node, const sf::FloatRect& rect) const
 {
-	sf::FloatRect bdry = this->_boundary;
+	const Node& n = this->_nodes[node];
+	float looseWidth = n.halfWidth * this->_looseness;
+	float looseHeight = n.halfHeight * this->_looseness;
 
-	return !(rect.left > this->_boundary.left + this->_boundary.width ||
-		rect.left + rect.width < this->_boundary.left - this->_boundary.width ||
-		rect.top > this->_boundary.top + this->_boundary.height ||
-		rect.top + rect.height < this->_boundary.top - this->_boundary.height);
-}
\ No newline at end of file
+	return !(rect.left > n.centreX + looseWidth ||
+		rect.left + rect.width < n.centreX - looseWidth ||
+		rect.top > n.centreY + looseHeight ||
+		rect.top + rect.height < n.centreY - looseHeight);
+}
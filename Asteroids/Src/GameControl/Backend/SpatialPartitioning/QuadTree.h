@@ -1,6 +1,8 @@
 #pragma once
 #include <vector>
+#include <cstdint>
 #include "SFML/Graphics.hpp"
+#include "RayCast.h"
 
 // class pre-definitions to save header space
 class WireframeSprite;
@@ -9,6 +11,13 @@ class WireframeSprite;
  *	 an nTree structure that divides a region recursively into quad structures.
  *	THe number of objects needed in a cell before it divides is pass into the constructor
  *	as capacity.
+ *	The tree is loose, each node accepts any object that fits inside its boundary
+ *	expanded by the looseness factor. Objects are filed by their size so large
+ *	objects sit higher in the tree, and moved objects are only relocated when they
+ *	leave the loose bounds of their owner node. A looseness of 1 gives a regular tree.
+ *	Nodes are stored in one contiguous pool and link to their children by index.
+ *	The sprites of every node live in a shared item pool as index linked lists,
+ *	so once the pools have grown no memory is allocated by the tree.
 */
 class QuadTree
 {
@@ -20,40 +29,50 @@ class QuadTree
 public:
 	/* Constructor
 	 * Brief:
-	 *	sets up the rectangle shape with default parameters, assigns the 
-	 *	internal boundary and assigns the internal capacity needed before splitting
+	 *	Creates the root node from the boundary (centre and half size), assigns
+	 *	the internal capacity needed before splitting. The looseness factor
+	 *	scales the boundary to give the loose bounds of each node
 	 */
-	QuadTree(sf::FloatRect boundary, unsigned int capacity);
+	QuadTree(sf::FloatRect boundary, unsigned int capacity, float looseness = 1.0f);
 
 	/* Destructor
 	* Brief:
-	*	deletes any children trees if this node has divided
+	*	node and item pools are released with the tree
 	*/
 	~QuadTree();
 
 	/*void AddObject
 	* Brief:
-	*	Takes a pointer to a wire frame sprite and adds it to the appropriate container
-	*	within the structure. calls itself recursively on children so it will be stored in 
-	*	the correct node of the global structure.
+	*	Takes a pointer to a wire frame sprite and adds it to the appropriate node
+	*	within the structure. Descends from the root into the child containing the
+	*	sprite's centre for as long as the sprite fits in that child's loose bounds.
 	* *Params:
 	* <WireframeSprite& > sprite	- the sprite to add to the tree structure
 	*/
 	void AddObject(WireframeSprite* sprite);
 
-	/*void AddObject
+	/*void RemoveObject
 	* Brief:
 	*	Takes a pointer to a wire frame sprite and removes it from the stored
-	*	 location in the tree. calls itself recursively on children to find the right 
-	*	container
+	*	location in the tree. The owner item index on the sprite is used
+	*	to unlink it from its node without searching.
 	* <WireframeSprite& > sprite	- the sprite to remove from the tree
 	*/
 	void RemoveObject(WireframeSprite* sprite);
 
+	/*void UpdateObject
+	* Brief:
+	*	Called after a sprite has moved. If the sprite still fits in the loose
+	*	bounds of its owner node nothing changes. Otherwise it's removed and the tree
+	*	is climbed until a node that can hold it is found, it's then re-added from there.
+	* <WireframeSprite& > sprite	- the sprite that has moved
+	*/
+	void UpdateObject(WireframeSprite* sprite);
+
 	/* void Query
 	* Brief:
-	*	queries the tree recursively to find all wireframe sprites within a given range.
-	*	these sprites from each tree are added to the sprites reference vector that is
+	*	queries the tree to find all wireframe sprites within a given range.
+	*	these sprites from each node are added to the sprites reference vector that is
 	*	passed as a parameter. This therefore means the output of the method is stored
 	*	in the referenced parameter.
 	* Params:
@@ -62,10 +81,49 @@ public:
 	*/
 	void Query(sf::FloatRect range, std::vector<WireframeSprite*>& sprites);
 
+	/* void FindPairs
+	* Brief:
+	*	Self overlap query of the tree in a single walk. Each node's sprites are
+	*	tested against each other and against a list of candidates passed down to
+	*	it: the sprites of its ancestors and of its earlier siblings' subtrees
+	*	(loose nodes overlap their siblings) that reach into its loose bounds.
+	*	A sprite lives in one node so every overlapping pair is reported exactly once.
+	*	Pairs are only output if their bounds overlap.
+	* Params:
+	*	<vector<pair<wireframesprite*, wireframesprite*>>&> pairs	-	vector to store result to
+	*/
+	void FindPairs(std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs);
+
+	/* void RayCast
+	* Brief:
+	*	Reports every sprite hit by the ray to the callback, nearest first, until
+	*	the callback returns false or max distance is reached. Nodes are visited
+	*	in order of where the ray enters their loose bounds, and a hit is reported
+	*	once no unvisited node could hold anything nearer.
+	* Params:
+	*	<const sf::Vector2f&>	origin		-	start of the ray
+	*	<const sf::Vector2f&>	direction	-	direction of the ray, doesn't need to be unit length
+	*	<float>					maxDistance	-	length of the ray
+	*	<RayCast::HitCallback>	callback	-	called for each sprite hit with its distance from the origin
+	*	<void*>					context		-	passed through to the callback
+	*/
+	void RayCast(const sf::Vector2f& origin, const sf::Vector2f& direction, float maxDistance, RayCast::HitCallback callback, void* context);
+
+	/* void SegmentQuery
+	* Brief:
+	*	Same as RayCast but for the segment between two points
+	* Params:
+	*	<const sf::Vector2f&>	start		-	start of the segment
+	*	<const sf::Vector2f&>	end			-	end of the segment
+	*	<RayCast::HitCallback>	callback	-	called for each sprite hit with its distance from the start
+	*	<void*>					context		-	passed through to the callback
+	*/
+	void SegmentQuery(const sf::Vector2f& start, const sf::Vector2f& end, RayCast::HitCallback callback, void* context);
+
 	/* void Draw
 	* Brief:
-	*	Draws the tree's rectangle shape recursively on any child node below it
-	*	Drawing from the super node will therefore draw the entire structure.
+	*	Builds the outline of every node from the node pool and draws
+	*	it, the debug geometry only exists while drawing.
 	* Params:
 	*	<sf::RenderWindow* window>	-	window to draw the structure to
 	*/
@@ -73,49 +131,134 @@ public:
 
 	/* void Clear
 	 * Brief:
-	 *	Clears all the sprites held by the current quad tree (this) and
-	 *	deletes all of it's children. Whenever a quad tree is deleted all of it's subsequent 
-	 *	children are also deleted
-	 *	therefore any branch lower than the node that clear is called upon will be deleted.
-	 *	Calling this on the root node therefore clears the entire tree.
+	 *	Removes every sprite and node apart from the root. The pools keep their
+	 *	memory so the tree can be refilled without allocating.
+	 *	The owner item of every removed sprite is reset so it can be re-added later.
 	*/
 	void Clear();
 
+	// Private structures
+private:
+	/* struct Node
+	 * Brief:
+	 *	Compact node stored in the node pool. Boundary is stored as centre and half
+	 *	size like the constructor's rect. Children are always allocated as a block
+	 *	of four so only the index of the first is stored (nw, ne, sw, se order).
+	*/
+	struct Node
+	{
+		float centreX, centreY;			// centre of the node's boundary
+		float halfWidth, halfHeight;	// half size of the node's boundary
+		uint32_t firstChild;			// index of the first of four children, NULL_INDEX for leaves
+		uint32_t parent;				// index of the parent node, NULL_INDEX for the root
+		uint32_t firstItem;				// head of the item list, NULL_INDEX when empty
+		uint32_t itemCount;				// number of items in the list, a full leaf at MAX_DEPTH can hold any number
+		uint16_t depth;					// depth of the node (root = 0)
+	};
+
+	/* struct Item
+	 * Brief:
+	 *	Entry of the shared item pool linking a sprite into a node's list.
+	 *	Free items reuse next as the free list link.
+	*/
+	struct Item
+	{
+		WireframeSprite* sprite;		// sprite stored in the item
+		uint32_t node;					// node owning the item
+		uint32_t prev;					// previous item in the node's list
+		uint32_t next;					// next item in the node's list
+	};
+
+	/* struct NodeEntry
+	 * Brief:
+	 *	Node waiting to be visited by a segment query, with the distance
+	 *	at which the segment enters its loose bounds
+	*/
+	struct NodeEntry
+	{
+		uint32_t node;
+		float distance;
+	};
+
+	/* struct PairCandidate
+	 * Brief:
+	 *	Sprite waiting to be paired during FindPairs, the bounds are
+	 *	cached so they're only calculated once per sprite
+	*/
+	struct PairCandidate
+	{
+		WireframeSprite* sprite;
+		sf::FloatRect bounds;
+	};
+
+	// Orders node entries so the nearest sits on top of a heap
+	static bool FurtherThan(const NodeEntry& a, const NodeEntry& b) { return a.distance > b.distance; }
 
 	// Private methods for internal use
 private:
 
 	/* void SubDivide
 	* Brief:
-	*	If the isDivided flag for this node hasn't already been set to true,
-	*	the method will create a new quad tree for each child member and then set
-	*	the isDivided flag to true.
+	*	Appends a block of four children for the node to the node pool and
+	*	pushes down any of the node's sprites that fit in a child.
+	* Params:
+	*	<uint32_t> node	-	index of the leaf to split
+	*/
+	void SubDivide(uint32_t node);
+
+	// Stores the sprite in the node, subdividing if the node goes over capacity
+	void Insert(uint32_t node, WireframeSprite* sprite);
+
+	// Descends from the node and inserts the sprite in the deepest node that can hold it
+	void AddFrom(uint32_t node, WireframeSprite* sprite, const sf::FloatRect& bounds);
+
+	/* void FindPairsFrom
+	* Brief:
+	*	Pairs the node's sprites with each other and with the candidates passed
+	*	down to it, then recurses into its children
+	* Params:
+	*	<uint32_t>	node			-	index of the node to visit
+	*	<size_t>	firstCandidate	-	the candidates from the end of the list back to here reach the node
+	*	<vector<pair<wireframesprite*, wireframesprite*>>&> pairs	-	vector to store result to
 	*/
-	void SubDivide();
+	void FindPairsFrom(uint32_t node, size_t firstCandidate, std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs);
 
-	// Returns true if the position point passed in in contained within the tree's boundary
-	bool Contains(sf::Vector2f& position);
+	// Adds the sprites in the subtree that reach into the target's loose bounds to the pair candidates
+	void CollectCandidates(uint32_t subtree, uint32_t target);
 
-	// Returns true if the given range intersects with the tree's boundary
-	bool Intersects(sf::FloatRect rect);
+	// Links and unlinks items from a node's list
+	void LinkItem(uint32_t node, uint32_t item);
+	void UnlinkItem(uint32_t item);
+
+	// Takes an item from the free list (growing the pool if needed) / returns it to the free list
+	uint32_t AllocateItem();
+	void FreeItem(uint32_t item);
+
+	// Returns the child the bounds should be filed in or NULL_INDEX if it doesn't fit in any
+	uint32_t GetChildFor(uint32_t node, const sf::FloatRect& bounds) const;
+
+	// Returns true if the rect fits entirely within the node's loose boundary
+	bool LooseContains(uint32_t node, const sf::FloatRect& rect) const;
+
+	// Returns true if the given range intersects with the node's loose boundary
+	bool Intersects(uint32_t node, const sf::FloatRect& rect) const;
 
 
 	// Members
 private:
-	std::vector<WireframeSprite*> _sprites;		// sprites in this current boundary
-	bool _isDivided = false;					// does this node have children
-	sf::FloatRect _boundary;					// boundary of this node
-	unsigned int _capacity;						// Maximum capacity of a quad tree before it subdivides
+	std::vector<Node> _nodes;					// Pool of all nodes, root is always index 0
+	std::vector<Item> _items;					// Shared pool of all items
+	uint32_t _freeItem;							// First item in the free list
+	std::vector<uint32_t> _stack;				// Traversal stack reused between queries
+	std::vector<NodeEntry> _queryNodes;			// Nodes waiting to be visited by a segment query, nearest on top
+	std::vector<RayCast::Hit> _queryHits;		// Hits waiting to be reported by a segment query, nearest on top
+	std::vector<PairCandidate> _pairCandidates;	// Sprites passed down the tree by FindPairs, one run per level
+
+	unsigned int _capacity;						// Maximum capacity of a node before it subdivides
+	float _looseness;							// Scale applied to the boundary to give the loose bounds
 	sf::Color _gridColor = sf::Color::Blue;		// color to draw the grid
 
-	sf::RectangleShape _rect;					// Rectangle shape that is draw when
-												// the draw method is called
-												// Note: 
-												// While boundary has the origin as the middle of the image
-												// _rect uses the top left corner as the origin
-
-	QuadTree* _nw = nullptr;					// north-west child node
-	QuadTree* _ne = nullptr;					// north-east child node
-	QuadTree* _sw = nullptr;					// south-west child node
-	QuadTree* _se = nullptr;					// south-east child node
-};
\ No newline at end of file
+	// constants
+	static constexpr uint32_t NULL_INDEX = 0xFFFFFFFF;	// Index used for no node / item
+	static constexpr unsigned int MAX_DEPTH = 8;		// Nodes at this depth won't subdivide
+};
@@ -0,0 +1,105 @@
+#include "RayCast.h"
+#include "../../../GameObjects/Base/WireframeSprite.h"
+#include <algorithm>
+
+/* bool IntersectPolygon
+* Brief:
+*	Clips the segment against every edge of the convex polygon (Cyrus-Beck)
+* Params:
+*	<const sf::Vector2f&>				start	-	start of the segment
+*	<const sf::Vector2f&>				end		-	end of the segment
+*	<const PointSpan&>					points	-	points of the polygon, either winding
+*	<float&>							t		-	set to the fraction of the segment where it enters
+*/
+bool RayCast::IntersectPolygon(const sf::Vector2f& start, const sf::Vector2f& end, const PointSpan& points, float& t)
+{
+	// twice the signed area gives the winding, so the edge normals can be made to point out
+	float area = 0.0f;
+	for (unsigned int a = 0; a < points.size(); a++)
+	{
+		unsigned int b = (a + 1) % points.size();
+		area += points[a].x * points[b].y - points[b].x * points[a].y;
+	}
+	float winding = area > 0.0f ? 1.0f : -1.0f;
+
+	sf::Vector2f direction = end - start;
+	float tEnter = 0.0f;
+	float tExit = 1.0f;
+
+	for (unsigned int a = 0; a < points.size(); a++)
+	{
+		unsigned int b = (a + 1) % points.size();
+		sf::Vector2f edge = points[b] - points[a];
+		sf::Vector2f outward(edge.y * winding, -edge.x * winding);
+
+		// a point q is inside the edge when outward . (q - a) <= 0
+		float numerator = outward.x * (points[a].x - start.x) + outward.y * (points[a].y - start.y);
+		float denominator = outward.x * direction.x + outward.y * direction.y;
+
+		if (denominator == 0.0f)
+		{
+			// parallel to the edge and outside it
+			if (numerator < 0.0f)
+				return false;
+			continue;
+		}
+
+		float tEdge = numerator / denominator;
+		if (denominator < 0.0f)
+			tEnter = std::max(tEnter, tEdge);	// entering through this edge
+		else
+			tExit = std::min(tExit, tEdge);		// leaving through this edge
+
+		if (tEnter > tExit)
+			return false;
+	}
+
+	t = tEnter;
+	return true;
+}
+
+/* bool IntersectRect
+* Brief:
+*	Clips the segment against the rect one axis at a time (slab test)
+* Params:
+*	<const sf::Vector2f&>	start	-	start of the segment
+*	<const sf::Vector2f&>	end		-	end of the segment
+*	<float>					left	-	left edge of the rect
+*	<float>					top		-	top edge of the rect
+*	<float>					right	-	right edge of the rect
+*	<float>					bottom	-	bottom edge of the rect
+*	<float&>				t		-	set to the fraction of the segment where it enters
+*/
+bool RayCast::IntersectRect(const sf::Vector2f& start, const sf::Vector2f& end, float left, float top, float right, float bottom, float& t)
+{
+	float origin[2] = { start.x, start.y };
+	float direction[2] = { end.x - start.x, end.y - start.y };
+	float minimum[2] = { left, top };
+	float maximum[2] = { right, bottom };
+
+	float tEnter = 0.0f;
+	float tExit = 1.0f;
+	for (int axis = 0; axis < 2; axis++)
+	{
+		if (direction[axis] == 0.0f)
+		{
+			// parallel to this axis, either always inside or never
+			if (origin[axis] < minimum[axis] || origin[axis] > maximum[axis])
+				return false;
+			continue;
+		}
+
+		float tNear = (minimum[axis] - origin[axis]) / direction[axis];
+		float tFar = (maximum[axis] - origin[axis]) / direction[axis];
+		if (tNear > tFar)
+			std::swap(tNear, tFar);
+
+		tEnter = std::max(tEnter, tNear);
+		tExit = std::min(tExit, tFar);
+		if (tEnter > tExit)
+			return false;
+	}
+
+	t = tEnter;
+	return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include "SFML/Graphics.hpp"
+
+// class pre-definitions to save header space
+class WireframeSprite;
+struct PointSpan;
+
+/* namespace RayCast
+ *	Shared pieces of the ray and segment queries on the spatial structures.
+ *	Queries report every sprite the ray hits through a callback, nearest
+ *	first, and stop as soon as the callback returns false.
+*/
+namespace RayCast
+{
+	// Called for each sprite hit, in order of distance along the ray from its
+	// origin. Return false to stop the query.
+	typedef bool(*HitCallback)(void* context, WireframeSprite* sprite, float distance);
+
+	/* struct Hit
+	 * Brief:
+	 *	A sprite found by a query that hasn't been reported yet
+	*/
+	struct Hit
+	{
+		WireframeSprite* sprite;
+		float distance;
+	};
+
+	// Orders hits so the nearest sits on top of a heap
+	inline bool FurtherThan(const Hit& a, const Hit& b) { return a.distance > b.distance; }
+
+	/* bool IntersectPolygon
+	* Brief:
+	*	Clips the segment against every edge of the convex polygon (Cyrus-Beck)
+	* Params:
+	*	<const sf::Vector2f&>				start	-	start of the segment
+	*	<const sf::Vector2f&>				end		-	end of the segment
+	*	<const PointSpan&>					points	-	points of the polygon, either winding
+	*	<float&>							t		-	set to the fraction of the segment where it enters
+	*/
+	bool IntersectPolygon(const sf::Vector2f& start, const sf::Vector2f& end, const PointSpan& points, float& t);
+
+	/* bool IntersectRect
+	* Brief:
+	*	Clips the segment against the rect one axis at a time (slab test)
+	* Params:
+	*	<const sf::Vector2f&>	start	-	start of the segment
+	*	<const sf::Vector2f&>	end		-	end of the segment
+	*	<float>					left	-	left edge of the rect
+	*	<float>					top		-	top edge of the rect
+	*	<float>					right	-	right edge of the rect
+	*	<float>					bottom	-	bottom edge of the rect
+	*	<float&>				t		-	set to the fraction of the segment where it enters
+	*/
+	bool IntersectRect(const sf::Vector2f& start, const sf::Vector2f& end, float left, float top, float right, float bottom, float& t);
+}
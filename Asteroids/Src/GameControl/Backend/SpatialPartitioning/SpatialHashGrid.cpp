@@ -0,0 +1,289 @@
+#include "SpatialHashGrid.h"
+#include "../../../GameObjects/Base/WireframeSprite.h"
+#include <algorithm>
+#include <cmath>
+
+/* Constructor
+ * Brief:
+ *	Takes the size in world pixels of each cell (both x and y)
+ */
+SpatialHashGrid::SpatialHashGrid(float cellSize)
+	:
+	_cellSize(cellSize),
+	_slots(INITIAL_SLOTS){}
+
+SpatialHashGrid::~SpatialHashGrid(){}
+
+/* void AddObject
+* Brief:
+*	Adds the sprite to the list of sprites hashed on the next call to update
+* Params:
+*	<WireframeSprite*> sprite	-	the sprite to add to the structure
+*/
+void SpatialHashGrid::AddObject(WireframeSprite* sprite)
+{
+	this->_sprites.push_back(sprite);
+}
+
+/* void RemoveObject
+* Brief:
+*	Removes the sprite from the list of sprites with a swap delete,
+*	the cells are rebuilt on the next update.
+* Params:
+*	<WireframeSprite*> sprite	-	the sprite to remove from the structure
+*/
+void SpatialHashGrid::RemoveObject(WireframeSprite* sprite)
+{
+	auto it = std::find(this->_sprites.begin(), this->_sprites.end(), sprite);
+
+	// sprite isn't in the structure
+	if (it == this->_sprites.end())
+		return;
+
+	*it = this->_sprites.back();
+	this->_sprites.pop_back();
+
+	// the cells still reference the sprite until the next update
+	this->_stamp++;
+	this->_nUsedCells = 0;
+}
+
+/* void RemoveObjects
+* Brief:
+*	Removes every sprite in the list with one pass over the structure
+*	instead of one search per sprite. The list must be sorted by address.
+* Params:
+*	<const vector<WireframeSprite*>&> sprites	-	sorted sprites to remove from the structure
+*/
+void SpatialHashGrid::RemoveObjects(const std::vector<WireframeSprite*>& sprites)
+{
+	if (sprites.empty())
+		return;
+
+	// keep every sprite not in the list, in order
+	unsigned int writeIndex = 0;
+	for (unsigned int i = 0; i < this->_sprites.size(); i++)
+	{
+		if (!std::binary_search(sprites.begin(), sprites.end(), this->_sprites[i]))
+			this->_sprites[writeIndex++] = this->_sprites[i];
+	}
+	this->_sprites.resize(writeIndex);
+
+	// the cells still reference the sprites until the next update
+	this->_stamp++;
+	this->_nUsedCells = 0;
+}
+
+/* void Update
+* Brief:
+*	Starts a new frame stamp, which empties every slot of the table, then
+*	adds every sprite to each cell its bounds overlap.
+*/
+void SpatialHashGrid::Update()
+{
+	// a new stamp empties every slot without touching them
+	this->_stamp++;
+	this->_nUsedCells = 0;
+
+	for (unsigned int i = 0; i < this->_sprites.size(); i++)
+	{
+		sf::FloatRect rect = this->_sprites[i]->GetBoundingRectangle();
+		Entry entry = { this->_sprites[i], rect.left, rect.top, rect.left + rect.width, rect.top + rect.height };
+
+		// add to every cell the bounds overlap
+		int minCellX = this->ToCell(entry.minX);
+		int minCellY = this->ToCell(entry.minY);
+		int maxCellX = this->ToCell(entry.maxX);
+		int maxCellY = this->ToCell(entry.maxY);
+
+		for (int y = minCellY; y <= maxCellY; y++)
+			for (int x = minCellX; x <= maxCellX; x++)
+				this->GetOrCreateCell(x, y).objects.push_back(entry);
+	}
+}
+
+/* void FindPairs
+* Brief:
+*	Tests every pair of sprites sharing a cell. A pair that shares several
+*	cells is only reported by the cell holding the top left corner of the
+*	overlap of their bounds, so each pair is found once.
+* Params:
+*	<vector<pair<wireframesprite*, wireframesprite*>>&> pairs	-	vector to store result to
+*/
+void SpatialHashGrid::FindPairs(std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs)
+{
+	for (unsigned int c = 0; c < this->_nUsedCells; c++)
+	{
+		const HashCell& cell = this->_cells[c];
+		const std::vector<Entry>& objects = cell.objects;
+
+		for (unsigned int i = 0; i < objects.size(); i++)
+		{
+			const Entry& a = objects[i];
+
+			for (unsigned int j = i + 1; j < objects.size(); j++)
+			{
+				const Entry& b = objects[j];
+
+				// bounds must overlap
+				if (a.minX > b.maxX || a.maxX < b.minX || a.minY > b.maxY || a.maxY < b.minY)
+					continue;
+
+				// only the cell holding the corner of the overlap reports the pair
+				if (this->ToCell(std::max(a.minX, b.minX)) != cell.x || this->ToCell(std::max(a.minY, b.minY)) != cell.y)
+					continue;
+
+				pairs.push_back({ a.sprite, b.sprite });
+			}
+		}
+	}
+}
+
+/* void Query
+* Brief:
+*	finds all sprites whose bounds intersect the given range. Sprites
+*	spanning several cells may be output more than once.
+* Params:
+*	<FloatRect>					range	-	query range
+*	<vector<wireframesprite*>&> sprites	-	vector to store result to
+*/
+void SpatialHashGrid::Query(sf::FloatRect range, std::vector<WireframeSprite*>& sprites)
+{
+	float maxX = range.left + range.width;
+	float maxY = range.top + range.height;
+
+	for (int y = this->ToCell(range.top); y <= this->ToCell(maxY); y++)
+	{
+		for (int x = this->ToCell(range.left); x <= this->ToCell(maxX); x++)
+		{
+			int cell = this->FindCell(x, y);
+			if (cell < 0)
+				continue;
+
+			const std::vector<Entry>& objects = this->_cells[cell].objects;
+			for (unsigned int i = 0; i < objects.size(); i++)
+			{
+				const Entry& entry = objects[i];
+				if (!(range.left > entry.maxX || maxX < entry.minX || range.top > entry.maxY || maxY < entry.minY))
+					sprites.push_back(entry.sprite);
+			}
+		}
+	}
+}
+
+/* void Draw
+* Brief:
+*	Draws the outline of every occupied cell
+* Params:
+*	<sf::RenderWindow* window>	-	window to draw the structure to
+*/
+void SpatialHashGrid::Draw(sf::RenderWindow* window)
+{
+	sf::VertexArray lines(sf::Lines);
+
+	for (unsigned int c = 0; c < this->_nUsedCells; c++)
+	{
+		float left = this->_cells[c].x * this->_cellSize;
+		float top = this->_cells[c].y * this->_cellSize;
+		sf::Vector2f topLeft(left, top);
+		sf::Vector2f topRight(left + this->_cellSize, top);
+		sf::Vector2f bottomLeft(left, top + this->_cellSize);
+		sf::Vector2f bottomRight(left + this->_cellSize, top + this->_cellSize);
+
+		lines.append(sf::Vertex(topLeft, this->_gridColor));
+		lines.append(sf::Vertex(topRight, this->_gridColor));
+		lines.append(sf::Vertex(topRight, this->_gridColor));
+		lines.append(sf::Vertex(bottomRight, this->_gridColor));
+		lines.append(sf::Vertex(bottomRight, this->_gridColor));
+		lines.append(sf::Vertex(bottomLeft, this->_gridColor));
+		lines.append(sf::Vertex(bottomLeft, this->_gridColor));
+		lines.append(sf::Vertex(topLeft, this->_gridColor));
+	}
+
+	window->draw(lines);
+}
+
+// Hashes the cell coordinates into a slot index
+uint32_t SpatialHashGrid::Hash(int x, int y) const
+{
+	// multiply by large primes and mix so neighbouring cells spread across the table
+	uint32_t hash = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u;
+	hash ^= hash >> 16;
+	return hash & static_cast<uint32_t>(this->_slots.size() - 1);
+}
+
+// Returns the cell with the given coordinates, claiming one if it's not in use this frame
+SpatialHashGrid::HashCell& SpatialHashGrid::GetOrCreateCell(int x, int y)
+{
+	// keep the load under a half so probe sequences stay short
+	if ((this->_nUsedCells + 1) * 2 > this->_slots.size())
+		this->Grow();
+
+	uint32_t mask = static_cast<uint32_t>(this->_slots.size() - 1);
+	uint32_t index = this->Hash(x, y);
+
+	// linear probe until the cell or a slot that's empty this frame is found
+	while (this->_slots[index].stamp == this->_stamp)
+	{
+		Slot& slot = this->_slots[index];
+		if (slot.x == x && slot.y == y)
+			return this->_cells[slot.cell];
+
+		index = (index + 1) & mask;
+	}
+
+	// claim the next cell, reusing the memory from previous frames
+	if (this->_nUsedCells == this->_cells.size())
+		this->_cells.emplace_back();
+
+	HashCell& cell = this->_cells[this->_nUsedCells];
+	cell.x = x;
+	cell.y = y;
+	cell.objects.clear();
+
+	Slot& slot = this->_slots[index];
+	slot.x = x;
+	slot.y = y;
+	slot.stamp = this->_stamp;
+	slot.cell = this->_nUsedCells++;
+
+	return cell;
+}
+
+// Returns the index of the cell with the given coordinates or -1 if it's empty
+int SpatialHashGrid::FindCell(int x, int y) const
+{
+	uint32_t mask = static_cast<uint32_t>(this->_slots.size() - 1);
+	uint32_t index = this->Hash(x, y);
+
+	while (this->_slots[index].stamp == this->_stamp)
+	{
+		const Slot& slot = this->_slots[index];
+		if (slot.x == x && slot.y == y)
+			return static_cast<int>(slot.cell);
+
+		index = (index + 1) & mask;
+	}
+
+	return -1;
+}
+
+// Doubles the number of slots and re-inserts the cells of the current frame
+void SpatialHashGrid::Grow()
+{
+	this->_slots.assign(this->_slots.size() * 2, Slot());
+	uint32_t mask = static_cast<uint32_t>(this->_slots.size() - 1);
+
+	for (unsigned int c = 0; c < this->_nUsedCells; c++)
+	{
+		uint32_t index = this->Hash(this->_cells[c].x, this->_cells[c].y);
+		while (this->_slots[index].stamp == this->_stamp)
+			index = (index + 1) & mask;
+
+		Slot& slot = this->_slots[index];
+		slot.x = this->_cells[c].x;
+		slot.y = this->_cells[c].y;
+		slot.stamp = this->_stamp;
+		slot.cell = c;
+	}
+}
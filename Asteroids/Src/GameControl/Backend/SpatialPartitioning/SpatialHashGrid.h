@@ -0,0 +1,156 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cmath>
+#include "SFML/Graphics.hpp"
+
+// class pre-definitions to save header space
+class WireframeSprite;
+
+/* class SpatialHashGrid
+ *	Sparse grid with no fixed size. Cells only exist while something overlaps
+ *	them and are found through an open addressing hash table keyed on the
+ *	integer cell coordinates, so memory scales with the number of occupied
+ *	cells rather than the area of the world. Sprites are added to every cell
+ *	their bounds touch, and the grid is rebuilt every frame. Slots from the
+ *	previous frame are invalidated with a frame stamp rather than cleared.
+*/
+class SpatialHashGrid
+{
+	// Public interface
+public:
+	/* Constructor
+	 * Brief:
+	 *	Takes the size in world pixels of each cell (both x and y)
+	 */
+	SpatialHashGrid(float cellSize);
+	~SpatialHashGrid();
+
+	/* void AddObject
+	* Brief:
+	*	Adds the sprite to the list of sprites hashed on the next call to update
+	* Params:
+	*	<WireframeSprite*> sprite	-	the sprite to add to the structure
+	*/
+	void AddObject(WireframeSprite* sprite);
+
+	/* void RemoveObject
+	* Brief:
+	*	Removes the sprite from the list of sprites with a swap delete,
+	*	the cells are rebuilt on the next update.
+	* Params:
+	*	<WireframeSprite*> sprite	-	the sprite to remove from the structure
+	*/
+	void RemoveObject(WireframeSprite* sprite);
+
+	/* void RemoveObjects
+	* Brief:
+	*	Removes every sprite in the list with one pass over the structure
+	*	instead of one search per sprite. The list must be sorted by address.
+	* Params:
+	*	<const vector<WireframeSprite*>&> sprites	-	sorted sprites to remove from the structure
+	*/
+	void RemoveObjects(const std::vector<WireframeSprite*>& sprites);
+
+	/* void Update
+	* Brief:
+	*	Starts a new frame stamp, which empties every slot of the table, then
+	*	adds every sprite to each cell its bounds overlap.
+	*/
+	void Update();
+
+	/* void FindPairs
+	* Brief:
+	*	Tests every pair of sprites sharing a cell. A pair that shares several
+	*	cells is only reported by the cell holding the top left corner of the
+	*	overlap of their bounds, so each pair is found once.
+	* Params:
+	*	<vector<pair<wireframesprite*, wireframesprite*>>&> pairs	-	vector to store result to
+	*/
+	void FindPairs(std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs);
+
+	/* void Query
+	* Brief:
+	*	finds all sprites whose bounds intersect the given range. Sprites
+	*	spanning several cells may be output more than once.
+	* Params:
+	*	<FloatRect>					range	-	query range
+	*	<vector<wireframesprite*>&> sprites	-	vector to store result to
+	*/
+	void Query(sf::FloatRect range, std::vector<WireframeSprite*>& sprites);
+
+	/* void Draw
+	* Brief:
+	*	Draws the outline of every occupied cell
+	* Params:
+	*	<sf::RenderWindow* window>	-	window to draw the structure to
+	*/
+	void Draw(sf::RenderWindow* window);
+
+	// Private structures
+private:
+	/* struct Entry
+	 * Brief:
+	 *	sprite stored in a cell alongside the bounds it was hashed with
+	*/
+	struct Entry
+	{
+		WireframeSprite* sprite;
+		float minX, minY;
+		float maxX, maxY;
+	};
+
+	/* struct Slot
+	 * Brief:
+	 *	slot of the hash table, only holds a cell if the stamp matches the current frame
+	*/
+	struct Slot
+	{
+		int x = 0, y = 0;					// coordinates of the cell
+		uint32_t stamp = 0;					// frame the slot was last written
+		uint32_t cell = 0;					// index of the cell's contents in _cells
+	};
+
+	/* struct HashCell
+	 * Brief:
+	 *	contents of an occupied cell, the vectors are reused between frames
+	*/
+	struct HashCell
+	{
+		int x = 0, y = 0;					// coordinates of the cell
+		std::vector<Entry> objects;			// sprites overlapping the cell
+	};
+
+	// Private methods for internal use
+private:
+	// Hashes the cell coordinates into a slot index
+	uint32_t Hash(int x, int y) const;
+
+	// Returns the cell with the given coordinates, claiming one if it's not in use this frame
+	HashCell& GetOrCreateCell(int x, int y);
+
+	// Returns the index of the cell with the given coordinates or -1 if it's empty
+	int FindCell(int x, int y) const;
+
+	// Doubles the number of slots and re-inserts the cells of the current frame
+	void Grow();
+
+	// Converts a world position to a cell coordinate
+	int ToCell(float value) const { return static_cast<int>(std::floor(value / this->_cellSize)); }
+
+	// Members
+private:
+	float _cellSize;							// Size in world pixels of each cell
+	std::vector<WireframeSprite*> _sprites;		// All sprites in the structure
+
+	std::vector<Slot> _slots;					// Open addressing table, size is always a power of two
+	std::vector<HashCell> _cells;				// Cell contents, only the first _nUsedCells are valid
+	unsigned int _nUsedCells = 0;				// Number of cells occupied this frame
+	uint32_t _stamp = 1;						// Current frame stamp, slots with any other stamp are empty
+
+	sf::Color _gridColor = sf::Color::Blue;		// colour to draw the grid
+
+	// constants
+	static constexpr unsigned int INITIAL_SLOTS = 256;	// Number of slots the table starts with
+};
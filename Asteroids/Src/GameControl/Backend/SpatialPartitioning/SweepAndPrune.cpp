@@ -0,0 +1,208 @@
+#include "SweepAndPrune.h"
+#include "../../../GameObjects/Base/WireframeSprite.h"
+#include <algorithm>
+
+SweepAndPrune::SweepAndPrune(){}
+
+SweepAndPrune::~SweepAndPrune(){}
+
+/* void AddObject
+* Brief:
+*	Creates a proxy for the sprite and appends its min and max endpoints
+*	to the end of the endpoint list. The endpoints are moved into place
+*	by the insertion sort on the next call to update.
+* Params:
+*	<WireframeSprite*> sprite	-	the sprite to add to the structure
+*/
+void SweepAndPrune::AddObject(WireframeSprite* sprite)
+{
+	// Create the proxy with the current bounds of the sprite
+	Proxy proxy;
+	proxy.sprite = sprite;
+	proxy.bounds = sprite->GetBoundingRectangle();
+	this->_proxies.push_back(proxy);
+
+	unsigned int proxyIndex = static_cast<unsigned int>(this->_proxies.size() - 1);
+
+	// Push back both ends of the interval
+	Endpoint minPoint;
+	minPoint.value = proxy.bounds.left;
+	minPoint.proxy = proxyIndex;
+	minPoint.isMin = true;
+
+	Endpoint maxPoint;
+	maxPoint.value = proxy.bounds.left + proxy.bounds.width;
+	maxPoint.proxy = proxyIndex;
+	maxPoint.isMin = false;
+
+	this->_endpoints.push_back(minPoint);
+	this->_endpoints.push_back(maxPoint);
+}
+
+/* void RemoveObject
+* Brief:
+*	Removes the proxy and both endpoints belonging to the sprite. The last
+*	proxy is swapped into the removed slot so any endpoints referencing it
+*	are re-pointed to the new index.
+* Params:
+*	<WireframeSprite*> sprite	-	the sprite to remove from the structure
+*/
+void SweepAndPrune::RemoveObject(WireframeSprite* sprite)
+{
+	// Find the proxy belonging to the sprite
+	unsigned int proxyIndex = 0;
+	while (proxyIndex < this->_proxies.size() && this->_proxies[proxyIndex].sprite != sprite)
+		proxyIndex++;
+
+	// sprite isn't in the structure
+	if (proxyIndex >= this->_proxies.size())
+		return;
+
+	unsigned int lastIndex = static_cast<unsigned int>(this->_proxies.size() - 1);
+
+	// Remove both endpoints while keeping the rest of the list in sorted order,
+	// re-point endpoints of the last proxy as it's about to be swapped into the gap
+	unsigned int writeIndex = 0;
+	for (unsigned int i = 0; i < this->_endpoints.size(); i++)
+	{
+		if (this->_endpoints[i].proxy == proxyIndex)
+			continue;
+
+		if (this->_endpoints[i].proxy == lastIndex)
+			this->_endpoints[i].proxy = proxyIndex;
+
+		this->_endpoints[writeIndex++] = this->_endpoints[i];
+	}
+	this->_endpoints.resize(writeIndex);
+
+	// swap delete the proxy
+	this->_proxies[proxyIndex] = this->_proxies.back();
+	this->_proxies.pop_back();
+}
+
+/* void RemoveObjects
+* Brief:
+*	Removes every sprite in the list with one pass over the structure
+*	instead of one search per sprite. The list must be sorted by address.
+* Params:
+*	<const vector<WireframeSprite*>&> sprites	-	sorted sprites to remove from the structure
+*/
+void SweepAndPrune::RemoveObjects(const std::vector<WireframeSprite*>& sprites)
+{
+	if (sprites.empty())
+		return;
+
+	// compact the proxies, remembering where each one moved to
+	this->_remap.resize(this->_proxies.size());
+	unsigned int writeIndex = 0;
+	for (unsigned int i = 0; i < this->_proxies.size(); i++)
+	{
+		if (std::binary_search(sprites.begin(), sprites.end(), this->_proxies[i].sprite))
+		{
+			this->_remap[i] = REMOVED_PROXY;
+			continue;
+		}
+
+		this->_remap[i] = writeIndex;
+		this->_proxies[writeIndex++] = this->_proxies[i];
+	}
+	this->_proxies.resize(writeIndex);
+
+	// drop the removed endpoints and re-point the rest, the list stays sorted
+	writeIndex = 0;
+	for (unsigned int i = 0; i < this->_endpoints.size(); i++)
+	{
+		unsigned int proxy = this->_remap[this->_endpoints[i].proxy];
+		if (proxy == REMOVED_PROXY)
+			continue;
+
+		this->_endpoints[writeIndex] = this->_endpoints[i];
+		this->_endpoints[writeIndex++].proxy = proxy;
+	}
+	this->_endpoints.resize(writeIndex);
+}
+
+/* void Update
+* Brief:
+*	Refreshes the cached bounds of every proxy, updates the endpoint values
+*	from those bounds and re-sorts the endpoint list using insertion sort.
+*/
+void SweepAndPrune::Update()
+{
+	// Refresh the bounds of all the proxies
+	for (unsigned int i = 0; i < this->_proxies.size(); i++)
+	{
+		this->_proxies[i].bounds = this->_proxies[i].sprite->GetBoundingRectangle();
+	}
+
+	// Update the endpoint values from the new bounds
+	for (unsigned int i = 0; i < this->_endpoints.size(); i++)
+	{
+		const sf::FloatRect& bounds = this->_proxies[this->_endpoints[i].proxy].bounds;
+		this->_endpoints[i].value = this->_endpoints[i].isMin ? bounds.left : bounds.left + bounds.width;
+	}
+
+	// Insertion sort, objects barely move between frames so the list is nearly
+	// sorted already and each endpoint only shifts a couple of places if at all
+	for (unsigned int i = 1; i < this->_endpoints.size(); i++)
+	{
+		Endpoint key = this->_endpoints[i];
+		int j = static_cast<int>(i) - 1;
+
+		while (j >= 0 && this->_endpoints[j].value > key.value)
+		{
+			this->_endpoints[j + 1] = this->_endpoints[j];
+			j--;
+		}
+		this->_endpoints[j + 1] = key;
+	}
+}
+
+/* void FindPairs
+* Brief:
+*	Sweeps the sorted endpoint list along the x axis. Each time a min endpoint
+*	is reached the proxy is tested on the y axis against every open interval,
+*	any overlap is pushed to the output container as a possible collision.
+* Params:
+*	<vector<pair<wireframesprite*, wireframesprite*>>&> pairs	-	vector to store result to
+*/
+void SweepAndPrune::FindPairs(std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs)
+{
+	this->_active.clear();
+
+	for (unsigned int i = 0; i < this->_endpoints.size(); i++)
+	{
+		const Endpoint& endpoint = this->_endpoints[i];
+
+		// End of an interval, close it by swap deleting from the active list
+		if (!endpoint.isMin)
+		{
+			for (unsigned int a = 0; a < this->_active.size(); a++)
+			{
+				if (this->_active[a] == endpoint.proxy)
+				{
+					this->_active[a] = this->_active.back();
+					this->_active.pop_back();
+					break;
+				}
+			}
+			continue;
+		}
+
+		// Start of an interval, everything still open overlaps on the x axis
+		const Proxy& proxy = this->_proxies[endpoint.proxy];
+		for (unsigned int a = 0; a < this->_active.size(); a++)
+		{
+			const Proxy& other = this->_proxies[this->_active[a]];
+
+			// prune on the y axis
+			if (proxy.bounds.top > other.bounds.top + other.bounds.height ||
+				other.bounds.top > proxy.bounds.top + proxy.bounds.height)
+				continue;
+
+			pairs.push_back({ proxy.sprite, other.sprite });
+		}
+
+		this->_active.push_back(endpoint.proxy);
+	}
+}
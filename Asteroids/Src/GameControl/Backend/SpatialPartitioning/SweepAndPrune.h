@@ -0,0 +1,101 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include "SFML/Graphics.hpp"
+
+// class pre-definitions to save header space
+class WireframeSprite;
+
+/* class SweepAndPrune
+ *	Broad phase structure that keeps a persistent list of interval endpoints
+ *	sorted along the x axis. Objects only move a small distance between frames
+ *	so the list is almost sorted at the start of every frame, meaning insertion
+ *	sort re-orders it in close to linear time. Overlapping pairs are then found
+ *	by sweeping the list and keeping a set of currently open intervals.
+*/
+class SweepAndPrune
+{
+	// Public interface
+public:
+	SweepAndPrune();
+	~SweepAndPrune();
+
+	/* void AddObject
+	* Brief:
+	*	Creates a proxy for the sprite and appends its min and max endpoints
+	*	to the end of the endpoint list. The endpoints are moved into place
+	*	by the insertion sort on the next call to update.
+	* Params:
+	*	<WireframeSprite*> sprite	-	the sprite to add to the structure
+	*/
+	void AddObject(WireframeSprite* sprite);
+
+	/* void RemoveObject
+	* Brief:
+	*	Removes the proxy and both endpoints belonging to the sprite. The last
+	*	proxy is swapped into the removed slot so any endpoints referencing it
+	*	are re-pointed to the new index.
+	* Params:
+	*	<WireframeSprite*> sprite	-	the sprite to remove from the structure
+	*/
+	void RemoveObject(WireframeSprite* sprite);
+
+	/* void RemoveObjects
+	* Brief:
+	*	Removes every sprite in the list with one pass over the structure
+	*	instead of one search per sprite. The list must be sorted by address.
+	* Params:
+	*	<const vector<WireframeSprite*>&> sprites	-	sorted sprites to remove from the structure
+	*/
+	void RemoveObjects(const std::vector<WireframeSprite*>& sprites);
+
+	/* void Update
+	* Brief:
+	*	Refreshes the cached bounds of every proxy, updates the endpoint values
+	*	from those bounds and re-sorts the endpoint list using insertion sort.
+	*/
+	void Update();
+
+	/* void FindPairs
+	* Brief:
+	*	Sweeps the sorted endpoint list along the x axis. Each time a min endpoint
+	*	is reached the proxy is tested on the y axis against every open interval,
+	*	any overlap is pushed to the output container as a possible collision.
+	* Params:
+	*	<vector<pair<wireframesprite*, wireframesprite*>>&> pairs	-	vector to store result to
+	*/
+	void FindPairs(std::vector<std::pair<WireframeSprite*, WireframeSprite*>>& pairs);
+
+	// Private structures
+private:
+	/* struct Proxy
+	 * Brief:
+	 *	Sprite stored in the structure alongside the bounds cached on the last update
+	*/
+	struct Proxy
+	{
+		WireframeSprite* sprite = nullptr;	// sprite the proxy represents
+		sf::FloatRect bounds;				// bounds of the sprite at the last update
+	};
+
+	/* struct Endpoint
+	 * Brief:
+	 *	One end of a proxy's interval along the x axis
+	*/
+	struct Endpoint
+	{
+		float value = 0.0f;					// position of the endpoint on the x axis
+		unsigned int proxy = 0;				// index of the proxy the endpoint belongs to
+		bool isMin = true;					// is this the start of the interval
+	};
+
+	// Members
+private:
+	std::vector<Proxy> _proxies;			// All proxies in the structure
+	std::vector<Endpoint> _endpoints;		// Endpoints of every proxy, sorted on the x axis
+	std::vector<unsigned int> _active;		// proxies with open intervals during the sweep
+	std::vector<unsigned int> _remap;		// new index of each proxy during a batched removal
+
+	// constants
+	static constexpr unsigned int REMOVED_PROXY = 0xFFFFFFFF;	// remap entry of a proxy being removed
+};
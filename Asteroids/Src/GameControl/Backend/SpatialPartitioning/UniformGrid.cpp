@@ -1,7 +1,11 @@
 #include "UniformGrid.h"
+#include <algorithm>
+#include <cmath>
 #include "../../../Global/ApplicationDefines.h"
 #include "../../Common/ResourceManager.h"
 
+unsigned int UniformGrid::_queryStamp = 0;
+
 UniformGrid::UniformGrid()
 {
 	// if custom cell size has been given set it
@@ -90,7 +94,8 @@ void UniformGrid::RemoveObject(WireframeSprite* object)
  * Brief:
  * Overloaded GetCell. Returns a reference to a cell based upon
  * window coordinates. Converts window coordinates to cell coordinates and
- * calls upon the base function internally.
+ * calls upon the base function internally. Positions outside the window
+ * are clamped to the edge cells.
  * Params:
  * <const sf::Vector2f& pos> - position contained in target cell
  * Returns:
@@ -98,17 +103,10 @@ void UniformGrid::RemoveObject(WireframeSprite* object)
 */
 Cell& UniformGrid::GetCell(const sf::Vector2f& pos)
 {
-	// Check x position is in range
-	if (pos.x < 0) return _cells[0];
-	if (pos.x >= WINDOW_WIDTH) return _cells[0];
-
-	// Check y position is in range
-	if (pos.y < 0) return _cells[0];
-	if (pos.y >= WINDOW_HEIGHT) return _cells[0];
-
-	// calculate cell x and y positions from window coordinates
-	int cellX = static_cast<int>(pos.x / _cellSize);
-	int cellY = static_cast<int>(pos.y / _cellSize);
+	// calculate cell x and y positions from window coordinates, positions outside
+	// the window (wrap ghosts) are clamped to the edge cells so they stay beside their neighbours
+	int cellX = std::min(std::max(static_cast<int>(std::floor(pos.x / _cellSize)), 0), this->_numXCells - 1);
+	int cellY = std::min(std::max(static_cast<int>(std::floor(pos.y / _cellSize)), 0), this->_numYCells - 1);
 
 	// return the corresponding cell
 	return GetCell(cellX, cellY);
@@ -141,6 +139,286 @@ Cell& UniformGrid::GetCell(int x, int y)
 	return _cells[y * _numXCells + x];
 }
 
+/* void RebuildCSR
+* Brief:
+* Rebuilds the compressed (CSR) copy of the grid from scratch. The first pass
+* counts the sprites landing in each cell, the counts are turned into offsets
+* and the second pass writes every sprite into one contiguous array ordered
+* by cell. Positions outside the window are clamped to the edge cells.
+* Params:
+*	<const std::vector<WireframeSprite*>&> sprites	-	every sprite to put in the grid
+*/
+void UniformGrid::RebuildCSR(const std::vector<WireframeSprite*>& sprites)
+{
+	unsigned int nCells = static_cast<unsigned int>(this->_numXCells * this->_numYCells);
+	unsigned int nSprites = static_cast<unsigned int>(sprites.size());
+
+	// resize only grows the containers the first time, memory is kept between frames
+	this->_csrCellStart.assign(nCells + 1, 0);
+	this->_csrObjects.resize(nSprites);
+	this->_csrSpriteCell.resize(nSprites);
+
+	float cellSize = static_cast<float>(this->_cellSize);
+
+	// first pass, work out each sprite's cell and count the cells
+	for (unsigned int i = 0; i < nSprites; i++)
+	{
+		sf::Vector2f pos = sprites[i]->GetPosition();
+
+		// clamp rather than branch so off screen sprites land in the edge cells
+		int cellX = std::min(std::max(static_cast<int>(pos.x / cellSize), 0), this->_numXCells - 1);
+		int cellY = std::min(std::max(static_cast<int>(pos.y / cellSize), 0), this->_numYCells - 1);
+		unsigned int cell = static_cast<unsigned int>(cellY * this->_numXCells + cellX);
+
+		this->_csrSpriteCell[i] = cell;
+		this->_csrCellStart[cell + 1]++;
+	}
+
+	// turn the counts into the offset each cell starts at
+	for (unsigned int c = 0; c < nCells; c++)
+		this->_csrCellStart[c + 1] += this->_csrCellStart[c];
+
+	// second pass, scatter the sprites into place. the start offsets are used as
+	// write heads so afterwards each one holds where the next cell starts
+	for (unsigned int i = 0; i < nSprites; i++)
+		this->_csrObjects[this->_csrCellStart[this->_csrSpriteCell[i]]++] = sprites[i];
+
+	// shift the offsets back down so each cell points at its first sprite
+	for (unsigned int c = nCells; c > 0; c--)
+		this->_csrCellStart[c] = this->_csrCellStart[c - 1];
+	this->_csrCellStart[0] = 0;
+}
+
+/* WireframeSprite* const* GetCSRCell
+* Brief:
+* Returns the contiguous range of sprites in a cell of the CSR grid
+* Params:
+*	<int>			x		-	X coordinate of the cell
+*	<int>			y		-	Y coordinate of the cell
+*	<unsigned int&>	count	-	set to the number of sprites in the cell
+* Returns:
+*	<WireframeSprite* const*>	-	first sprite in the cell
+*/
+WireframeSprite* const* UniformGrid::GetCSRCell(int x, int y, unsigned int& count) const
+{
+	unsigned int cell = static_cast<unsigned int>(y * this->_numXCells + x);
+	unsigned int start = this->_csrCellStart[cell];
+
+	count = this->_csrCellStart[cell + 1] - start;
+	return this->_csrObjects.data() + start;
+}
+
+/* void TraverseSegment
+* Brief:
+* Walks the cells a segment passes through from start to end using the
+* Amanatides-Woo DDA, stepping into whichever neighbouring cell boundary
+* the segment crosses first. The segment is clipped to the grid first and
+* the walk stops early if the visitor returns false.
+* Params:
+*	<const sf::Vector2f&>	start	-	start of the segment (t = 0)
+*	<const sf::Vector2f&>	end		-	end of the segment (t = 1)
+*	<CellVisitor>			visitor	-	called for each cell in order
+*	<void*>					context	-	passed through to the visitor
+*/
+void UniformGrid::TraverseSegment(const sf::Vector2f& start, const sf::Vector2f& end, CellVisitor visitor, void* context) const
+{
+	float cellSize = static_cast<float>(this->_cellSize);
+	float direction[2] = { end.x - start.x, end.y - start.y };
+	float origin[2] = { start.x, start.y };
+	float gridMax[2] = { this->_numXCells * cellSize, this->_numYCells * cellSize };
+
+	// clip the segment to the grid one axis at a time
+	float tStart = 0.0f;
+	float tEnd = 1.0f;
+	for (int axis = 0; axis < 2; axis++)
+	{
+		if (direction[axis] == 0.0f)
+		{
+			// parallel to this axis, either always inside or never
+			if (origin[axis] < 0.0f || origin[axis] >= gridMax[axis])
+				return;
+			continue;
+		}
+
+		float tNear = (0.0f - origin[axis]) / direction[axis];
+		float tFar = (gridMax[axis] - origin[axis]) / direction[axis];
+		if (tNear > tFar)
+			std::swap(tNear, tFar);
+
+		tStart = std::max(tStart, tNear);
+		tEnd = std::min(tEnd, tFar);
+	}
+
+	if (tStart > tEnd)
+		return;
+
+	// cell the clipped segment starts in
+	int cell[2];
+	int step[2];
+	float tMax[2];		// t at which the segment crosses the next boundary on each axis
+	float tDelta[2];	// t taken to cross a whole cell on each axis
+	int numCells[2] = { this->_numXCells, this->_numYCells };
+
+	for (int axis = 0; axis < 2; axis++)
+	{
+		float position = origin[axis] + direction[axis] * tStart;
+		cell[axis] = std::min(std::max(static_cast<int>(std::floor(position / cellSize)), 0), numCells[axis] - 1);
+
+		if (direction[axis] > 0.0f)
+		{
+			step[axis] = 1;
+			tMax[axis] = ((cell[axis] + 1) * cellSize - origin[axis]) / direction[axis];
+			tDelta[axis] = cellSize / direction[axis];
+		}
+		else if (direction[axis] < 0.0f)
+		{
+			step[axis] = -1;
+			tMax[axis] = (cell[axis] * cellSize - origin[axis]) / direction[axis];
+			tDelta[axis] = -cellSize / direction[axis];
+		}
+		else
+		{
+			step[axis] = 0;
+			tMax[axis] = INFINITY;
+			tDelta[axis] = INFINITY;
+		}
+	}
+
+	float tEnter = tStart;
+	while (true)
+	{
+		float tExit = std::min(std::min(tMax[0], tMax[1]), tEnd);
+		if (!visitor(context, cell[0], cell[1], tEnter, tExit))
+			return;
+
+		// reached the end of the segment
+		if (tExit >= tEnd)
+			return;
+
+		// step across whichever boundary comes first
+		int axis = tMax[0] < tMax[1] ? 0 : 1;
+		cell[axis] += step[axis];
+		tEnter = tMax[axis];
+		tMax[axis] += tDelta[axis];
+
+		if (cell[axis] < 0 || cell[axis] >= numCells[axis])
+			return;
+	}
+}
+
+/* void RayCast
+* Brief:
+* Reports every sprite hit by the ray to the callback, nearest first, until
+* the callback returns false or max distance is reached. The cells are walked
+* front to back and the sprites around each cell tested. A hit is only reported
+* once the walk has passed it, as sprites are binned by their centre and can
+* reach into the neighbouring cells. Reads the cells, not the CSR copy.
+* Params:
+*	<const sf::Vector2f&>	origin		-	start of the ray
+*	<const sf::Vector2f&>	direction	-	direction of the ray, doesn't need to be unit length
+*	<float>					maxDistance	-	length of the ray
+*	<RayCast::HitCallback>	callback	-	called for each sprite hit with its distance from the origin
+*	<void*>					context		-	passed through to the callback
+*/
+void UniformGrid::RayCast(const sf::Vector2f& origin, const sf::Vector2f& direction, float maxDistance, RayCast::HitCallback callback, void* context)
+{
+	float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+	if (length == 0.0f)
+		return;
+
+	this->SegmentQuery(origin, origin + direction * (maxDistance / length), callback, context);
+}
+
+/* void SegmentQuery
+* Brief:
+* Same as RayCast but for the segment between two points
+* Params:
+*	<const sf::Vector2f&>	start		-	start of the segment
+*	<const sf::Vector2f&>	end			-	end of the segment
+*	<RayCast::HitCallback>	callback	-	called for each sprite hit with its distance from the start
+*	<void*>					context		-	passed through to the callback
+*/
+void UniformGrid::SegmentQuery(const sf::Vector2f& start, const sf::Vector2f& end, RayCast::HitCallback callback, void* context)
+{
+	SegmentWalk walk;
+	walk.grid = this;
+	walk.start = start;
+	walk.end = end;
+	walk.length = std::sqrt((end.x - start.x) * (end.x - start.x) + (end.y - start.y) * (end.y - start.y));
+	walk.callback = callback;
+	walk.context = context;
+
+	this->_queryHits.clear();
+
+	// a new stamp marks every sprite as untested, 0 is kept for sprites no query has seen
+	if (++_queryStamp == 0)
+		_queryStamp = 1;
+
+	this->TraverseSegment(start, end, SegmentQueryVisitor, &walk);
+
+	// the walk can finish before the edge of the last cell, report whatever is left
+	while (!walk.stopped && !this->_queryHits.empty())
+	{
+		std::pop_heap(this->_queryHits.begin(), this->_queryHits.end(), RayCast::FurtherThan);
+		RayCast::Hit hit = this->_queryHits.back();
+		this->_queryHits.pop_back();
+
+		walk.stopped = !callback(context, hit.sprite, hit.distance);
+	}
+}
+
+// Cell visitor for segment queries, tests the sprites around the cell and reports the hits it has passed
+bool UniformGrid::SegmentQueryVisitor(void* context, int x, int y, float /*tEnter*/, float tExit)
+{
+	SegmentWalk& walk = *static_cast<SegmentWalk*>(context);
+	UniformGrid* grid = walk.grid;
+	std::vector<RayCast::Hit>& hits = grid->_queryHits;
+
+	// anything reaching into this cell is binned here or in a neighbour
+	for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, grid->_numYCells - 1); ny++)
+	{
+		for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, grid->_numXCells - 1); nx++)
+		{
+			std::vector<WireframeSprite*>& objects = grid->GetCell(nx, ny)._objects;
+			for (unsigned int i = 0; i < objects.size(); i++)
+			{
+				WireframeSprite* sprite = objects[i];
+				if (!sprite)
+					continue;
+
+				// neighbourhoods of consecutive cells overlap, only test each sprite once
+				if (sprite->GetQueryStamp() == _queryStamp)
+					continue;
+				sprite->SetQueryStamp(_queryStamp);
+
+				float t;
+				if (RayCast::IntersectPolygon(walk.start, walk.end, sprite->GetPoints(), t))
+				{
+					hits.push_back({ sprite, t * walk.length });
+					std::push_heap(hits.begin(), hits.end(), RayCast::FurtherThan);
+				}
+			}
+		}
+	}
+
+	// every hit before this cell's exit has been found, so they can go out in order
+	float reached = tExit * walk.length;
+	while (!hits.empty() && hits.front().distance <= reached)
+	{
+		std::pop_heap(hits.begin(), hits.end(), RayCast::FurtherThan);
+		RayCast::Hit hit = hits.back();
+		hits.pop_back();
+
+		if (!walk.callback(walk.context, hit.sprite, hit.distance))
+		{
+			walk.stopped = true;
+			return false;
+		}
+	}
+
+	return true;
+}
+
 /* void Draw
 * Brief:
 * Loops trough all stored grid lines and prints them to the passed render
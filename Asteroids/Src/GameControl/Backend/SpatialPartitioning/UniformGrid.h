@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include "../../../GameObjects/Base/WireframeSprite.h"
+#include "RayCast.h"
 
 class CollisionHandler;
 
@@ -27,6 +28,10 @@ class UniformGrid
 {
 	friend class CollisionHandler;
 public:
+	// Called for each cell a segment passes through, in order. tEnter and tExit are the
+	// fractions of the segment where it enters and leaves the cell. Return false to stop.
+	typedef bool(*CellVisitor)(void* context, int x, int y, float tEnter, float tExit);
+
 	UniformGrid();
 	~UniformGrid();
 
@@ -73,7 +78,8 @@ public:
 	 * Brief:
 	 * Overloaded GetCell. Returns a reference to a cell based upon
 	 * window coordinates. Converts window coordinates to cell coordinates and
-	 * calls upon the base function internally.
+	 * calls upon the base function internally. Positions outside the window
+	 * are clamped to the edge cells.
 	 * Params:
 	 * <const sf::Vector2f& pos> - position contained in target cell
 	 * Returns:
@@ -97,14 +103,109 @@ public:
 	*/
 	void ConstructDisplayLines();
 
+	/* void RebuildCSR
+	* Brief:
+	* Rebuilds the compressed (CSR) copy of the grid from scratch. The first pass
+	* counts the sprites landing in each cell, the counts are turned into offsets
+	* and the second pass writes every sprite into one contiguous array ordered
+	* by cell. Positions outside the window are clamped to the edge cells.
+	* Params:
+	*	<const std::vector<WireframeSprite*>&> sprites	-	every sprite to put in the grid
+	*/
+	void RebuildCSR(const std::vector<WireframeSprite*>& sprites);
+
+	/* WireframeSprite* const* GetCSRCell
+	* Brief:
+	* Returns the contiguous range of sprites in a cell of the CSR grid
+	* Params:
+	*	<int>			x		-	X coordinate of the cell
+	*	<int>			y		-	Y coordinate of the cell
+	*	<unsigned int&>	count	-	set to the number of sprites in the cell
+	* Returns:
+	*	<WireframeSprite* const*>	-	first sprite in the cell
+	*/
+	WireframeSprite* const* GetCSRCell(int x, int y, unsigned int& count) const;
+
+	/* void TraverseSegment
+	* Brief:
+	* Walks the cells a segment passes through from start to end using the
+	* Amanatides-Woo DDA, stepping into whichever neighbouring cell boundary
+	* the segment crosses first. The segment is clipped to the grid first and
+	* the walk stops early if the visitor returns false.
+	* Params:
+	*	<const sf::Vector2f&>	start	-	start of the segment (t = 0)
+	*	<const sf::Vector2f&>	end		-	end of the segment (t = 1)
+	*	<CellVisitor>			visitor	-	called for each cell in order
+	*	<void*>					context	-	passed through to the visitor
+	*/
+	void TraverseSegment(const sf::Vector2f& start, const sf::Vector2f& end, CellVisitor visitor, void* context) const;
+
+	/* void RayCast
+	* Brief:
+	* Reports every sprite hit by the ray to the callback, nearest first, until
+	* the callback returns false or max distance is reached. The cells are walked
+	* front to back and the sprites around each cell tested. A hit is only reported
+	* once the walk has passed it, as sprites are binned by their centre and can
+	* reach into the neighbouring cells. Reads the cells, not the CSR copy.
+	* Params:
+	*	<const sf::Vector2f&>	origin		-	start of the ray
+	*	<const sf::Vector2f&>	direction	-	direction of the ray, doesn't need to be unit length
+	*	<float>					maxDistance	-	length of the ray
+	*	<RayCast::HitCallback>	callback	-	called for each sprite hit with its distance from the origin
+	*	<void*>					context		-	passed through to the callback
+	*/
+	void RayCast(const sf::Vector2f& origin, const sf::Vector2f& direction, float maxDistance, RayCast::HitCallback callback, void* context);
+
+	/* void SegmentQuery
+	* Brief:
+	* Same as RayCast but for the segment between two points
+	* Params:
+	*	<const sf::Vector2f&>	start		-	start of the segment
+	*	<const sf::Vector2f&>	end			-	end of the segment
+	*	<RayCast::HitCallback>	callback	-	called for each sprite hit with its distance from the start
+	*	<void*>					context		-	passed through to the callback
+	*/
+	void SegmentQuery(const sf::Vector2f& start, const sf::Vector2f& end, RayCast::HitCallback callback, void* context);
+
+	// Getters for the grid dimensions
+	int GetNumXCells() const { return this->_numXCells; }
+	int GetNumYCells() const { return this->_numYCells; }
+
 
 private:
+	/* struct SegmentWalk
+	 * Brief:
+	 *	State of a segment query as it walks through the cells
+	*/
+	struct SegmentWalk
+	{
+		UniformGrid* grid;
+		sf::Vector2f start;
+		sf::Vector2f end;
+		float length;						// length of the segment, converts t to distance
+		RayCast::HitCallback callback;
+		void* context;
+		bool stopped = false;				// set once the callback asks to stop
+	};
+
+	// Cell visitor for segment queries, tests the sprites around the cell and reports the hits it has passed
+	static bool SegmentQueryVisitor(void* context, int x, int y, float tEnter, float tExit);
+
 	// Members
 	int _numXCells;							// Number of cells in the X direction
 	int _numYCells;							// Number of cells in the Y direction
 	std::vector<Cell> _cells;				// Container for all the cells in the grid
 	std::vector<Line> _gridlines;			// Container for the grid lines called by the draw method
 
+	// CSR layout, rebuilt every frame when in use
+	std::vector<unsigned int> _csrCellStart;		// offset of each cell's first sprite, one extra entry holds the total
+	std::vector<WireframeSprite*> _csrObjects;		// every sprite ordered by cell
+	std::vector<unsigned int> _csrSpriteCell;		// cell of each sprite worked out on the counting pass
+
+	// Segment query scratch, kept between queries so they don't allocate
+	std::vector<RayCast::Hit> _queryHits;			// hits waiting to be reported, heap with the nearest on top
+	static unsigned int _queryStamp;				// stamp of the current query, shared so sprites moved between grids never match a stale one
+
 	// constants
 	unsigned int _cellSize = 110;	// Size in window pixels of each cell (both x and y)
 	sf::Color _gridColor = sf::Color::Blue;	// colour to draw the grid
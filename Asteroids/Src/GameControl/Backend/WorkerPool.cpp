@@ -0,0 +1,89 @@
+#include "WorkerPool.h"
+
+/* Constructor
+ * Brief:
+ *	Starts the worker threads. The calling thread counts as a worker, so
+ *	nWorkers - 1 threads are created.
+ * Params:
+ *	<unsigned int> nWorkers	-	total number of workers including the caller
+ */
+WorkerPool::WorkerPool(unsigned int nWorkers)
+{
+	for (unsigned int i = 1; i < nWorkers; i++)
+		this->_threads.emplace_back(&WorkerPool::WorkerLoop, this, i);
+}
+
+/* Destructor
+ * Brief:
+ *	Wakes the workers with the stop flag set and joins them
+ */
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_isStopping = true;
+	}
+	this->_jobReady.notify_all();
+
+	for (unsigned int i = 0; i < this->_threads.size(); i++)
+		this->_threads[i].join();
+}
+
+/* void Run
+* Brief:
+*	Runs the job on every worker and blocks until they have all returned
+* Params:
+*	<Job>	job		-	function run by every worker
+*	<void*>	context	-	passed through to the job
+*/
+void WorkerPool::Run(Job job, void* context)
+{
+	// start a new generation so every thread picks the job up once
+	{
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		this->_job = job;
+		this->_context = context;
+		this->_nBusyWorkers = static_cast<unsigned int>(this->_threads.size());
+		this->_generation++;
+	}
+	this->_jobReady.notify_all();
+
+	// the caller works too rather than sitting idle
+	job(context, 0);
+
+	// wait for the rest
+	std::unique_lock<std::mutex> lock(this->_mutex);
+	this->_jobDone.wait(lock, [this] { return this->_nBusyWorkers == 0; });
+}
+
+// Loop run by each thread, sleeps until a new job generation is started
+void WorkerPool::WorkerLoop(unsigned int workerIndex)
+{
+	unsigned int lastGeneration = 0;
+
+	while (true)
+	{
+		Job job;
+		void* context;
+
+		// sleep until there's a job this thread hasn't run
+		{
+			std::unique_lock<std::mutex> lock(this->_mutex);
+			this->_jobReady.wait(lock, [this, lastGeneration] { return this->_isStopping || this->_generation != lastGeneration; });
+
+			if (this->_isStopping)
+				return;
+
+			lastGeneration = this->_generation;
+			job = this->_job;
+			context = this->_context;
+		}
+
+		job(context, workerIndex);
+
+		// the last worker to finish wakes the caller
+		std::lock_guard<std::mutex> lock(this->_mutex);
+		if (--this->_nBusyWorkers == 0)
+			this->_jobDone.notify_one();
+	}
+}
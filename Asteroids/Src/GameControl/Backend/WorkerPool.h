@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/* class WorkerPool
+ *	Fixed set of threads that sleep until a job is run. Run hands the same job
+ *	to every worker, the calling thread takes part as worker 0, and returns once
+ *	all of them have finished. Jobs are plain function pointers with a context
+ *	so running one never allocates. The workers split the work between
+ *	themselves, usually by claiming tasks from an atomic counter.
+*/
+class WorkerPool
+{
+	// Public structures
+public:
+	// Job run by every worker, workerIndex is in the range [0, GetWorkerCount())
+	typedef void(*Job)(void* context, unsigned int workerIndex);
+
+	// Public interface
+public:
+	/* Constructor
+	 * Brief:
+	 *	Starts the worker threads. The calling thread counts as a worker, so
+	 *	nWorkers - 1 threads are created.
+	 * Params:
+	 *	<unsigned int> nWorkers	-	total number of workers including the caller
+	 */
+	WorkerPool(unsigned int nWorkers);
+
+	/* Destructor
+	 * Brief:
+	 *	Wakes the workers with the stop flag set and joins them
+	 */
+	~WorkerPool();
+
+	/* void Run
+	* Brief:
+	*	Runs the job on every worker and blocks until they have all returned
+	* Params:
+	*	<Job>	job		-	function run by every worker
+	*	<void*>	context	-	passed through to the job
+	*/
+	void Run(Job job, void* context);
+
+	// Getter for the number of workers, including the calling thread
+	unsigned int GetWorkerCount() const { return static_cast<unsigned int>(this->_threads.size()) + 1; }
+
+	// Private methods for internal use
+private:
+	// Loop run by each thread, sleeps until a new job generation is started
+	void WorkerLoop(unsigned int workerIndex);
+
+	// Members
+private:
+	std::vector<std::thread> _threads;		// Worker threads, worker 0 is the caller of Run
+	std::mutex _mutex;						// Guards every member below
+	std::condition_variable _jobReady;		// Signalled when a job is started or the pool stops
+	std::condition_variable _jobDone;		// Signalled when the last worker finishes a job
+
+	Job _job = nullptr;						// Job currently being run
+	void* _context = nullptr;				// Context of the current job
+	unsigned int _generation = 0;			// Incremented for every job so workers run each one once
+	unsigned int _nBusyWorkers = 0;			// Threads still running the current job
+	bool _isStopping = false;				// Set by the destructor to end the worker loops
+};
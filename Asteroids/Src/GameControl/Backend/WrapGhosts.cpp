@@ -0,0 +1,46 @@
+#include "WrapGhosts.h"
+#include "../../GameObjects/Base/WireframeSprite.h"
+
+WrapGhosts::WrapGhosts(){}
+
+// Deletes the pooled ghosts
+WrapGhosts::~WrapGhosts()
+{
+	for (unsigned int i = 0; i < this->_pool.size(); i++)
+		delete this->_pool[i];
+}
+
+/* void Clear
+* Brief:
+*	Releases every ghost back to the pool. They must have been taken out
+*	of any structure they were added to first.
+*/
+void WrapGhosts::Clear()
+{
+	this->_nGhosts = 0;
+}
+
+/* void AddGhostsOf
+* Brief:
+*	Gives the sprite a ghost for each edge it's over, up to three at a corner.
+*	Does nothing if the sprite doesn't wrap or is inside the screen.
+* Params:
+*	<WireframeSprite*> sprite	-	sprite to make ghosts of
+*/
+void WrapGhosts::AddGhostsOf(WireframeSprite* sprite)
+{
+	if (!sprite->WrapsAround())
+		return;
+
+	sf::Vector2f offsets[3];
+	unsigned int nOffsets = WireframeSprite::GetWrapOffsets(sprite->GetBoundingRectangle(), offsets);
+
+	for (unsigned int i = 0; i < nOffsets; i++)
+	{
+		// the category and mask are replaced by the owner's when copied
+		if (this->_nGhosts == this->_pool.size())
+			this->_pool.push_back(new WireframeSprite(0, sprite->GetCategory(), 0));
+
+		this->_pool[this->_nGhosts++]->CopyAsGhost(*sprite, offsets[i]);
+	}
+}
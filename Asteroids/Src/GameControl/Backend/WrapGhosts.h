@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+
+// class pre-definitions to save header space
+class WireframeSprite;
+
+/* class WrapGhosts
+ *	The screen wraps, so a sprite over an edge also pokes out of the opposite
+ *	edge. The broad phase structures only know where a sprite's centre is, so
+ *	each sprite straddling an edge is given a ghost: a copy shifted a whole
+ *	window to where the rest of it is drawn. Ghosts go into the structures like
+ *	any other sprite and collisions found with them are passed to their owner.
+ *	Only the few sprites over an edge get ghosts, so this costs far less than
+ *	querying every sprite four times with shifted bounds.
+ *	Ghost sprites are pooled and rebuilt every frame.
+*/
+class WrapGhosts
+{
+	// Public interface
+public:
+	WrapGhosts();
+
+	// Deletes the pooled ghosts
+	~WrapGhosts();
+
+	/* void Clear
+	* Brief:
+	*	Releases every ghost back to the pool. They must have been taken out
+	*	of any structure they were added to first.
+	*/
+	void Clear();
+
+	/* void AddGhostsOf
+	* Brief:
+	*	Gives the sprite a ghost for each edge it's over, up to three at a corner.
+	*	Does nothing if the sprite doesn't wrap or is inside the screen.
+	* Params:
+	*	<WireframeSprite*> sprite	-	sprite to make ghosts of
+	*/
+	void AddGhostsOf(WireframeSprite* sprite);
+
+	// Returns the number of ghosts made this frame
+	unsigned int GetCount() const { return this->_nGhosts; }
+
+	// Returns a ghost made this frame
+	WireframeSprite* GetGhost(unsigned int index) const { return this->_pool[index]; }
+
+	// Members
+private:
+	std::vector<WireframeSprite*> _pool;		// every ghost created, the first _nGhosts are in use
+	unsigned int _nGhosts = 0;					// ghosts in use this frame
+};
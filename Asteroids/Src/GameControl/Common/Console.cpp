@@ -206,6 +206,30 @@ Console::ParsedCommandData Console::ParseSet(std::deque<std::string>& parameters
 		// set broad phase to quadtree
 		else if (parameters[1] == "quadtree")
 			output.commandType = CommandType::SET_BROAD_COLLISION_QUADTREE;
+		// set broad phase to sweep and prune
+		else if (parameters[1] == "sap")
+			output.commandType = CommandType::SET_BROAD_COLLISION_SWEEP_AND_PRUNE;
+		// set broad phase to dynamic aabb tree
+		else if (parameters[1] == "aabbtree")
+			output.commandType = CommandType::SET_BROAD_COLLISION_AABB_TREE;
+		// set broad phase to linear quadtree
+		else if (parameters[1] == "linearquadtree")
+			output.commandType = CommandType::SET_BROAD_COLLISION_LINEAR_QUADTREE;
+		// set broad phase to spatial hash grid
+		else if (parameters[1] == "spatialhash")
+			output.commandType = CommandType::SET_BROAD_COLLISION_SPATIAL_HASH;
+		// set broad phase to uniform grid rebuilt in csr layout
+		else if (parameters[1] == "uniformgridcsr")
+			output.commandType = CommandType::SET_BROAD_COLLISION_UNIFORM_GRID_CSR;
+		// set broad phase to uniform grid split across worker threads
+		else if (parameters[1] == "uniformgridparallel")
+			output.commandType = CommandType::SET_BROAD_COLLISION_UNIFORM_GRID_PARALLEL;
+		// set broad phase to grid with a level per sprite size
+		else if (parameters[1] == "hierarchicalgrid")
+			output.commandType = CommandType::SET_BROAD_COLLISION_HIERARCHICAL_GRID;
+		// let the collision handler pick the cheapest broad phase
+		else if (parameters[1] == "auto")
+			output.commandType = CommandType::SET_BROAD_COLLISION_AUTO;
 		// invalid mode type given
 		else
 		{
@@ -226,6 +250,15 @@ Console::ParsedCommandData Console::ParseSet(std::deque<std::string>& parameters
 		// Set narrow phase collision to separated axis theorem
 		else if (parameters[1] == "sat")
 			output.commandType = CommandType::SET_NARROW_COLLISION_SAT;
+		// Set narrow phase collision to the vectorised separated axis theorem
+		else if (parameters[1] == "sat-simd")
+			output.commandType = CommandType::SET_NARROW_COLLISION_SAT_SIMD;
+		// Set narrow phase collision to the separated axis theorem specialised on vertex counts
+		else if (parameters[1] == "sat-template")
+			output.commandType = CommandType::SET_NARROW_COLLISION_SAT_SPECIALISED;
+		// Set narrow phase collision to GJK
+		else if (parameters[1] == "gjk")
+			output.commandType = CommandType::SET_NARROW_COLLISION_GJK;
 		// Invalid narrow mode given
 		else
 		{
@@ -290,6 +323,20 @@ Console::ParsedCommandData Console::ParseToggle(std::deque<std::string>& paramet
 		outputMessage += "collision info.";
 	}
 
+	// toggle the narrow phase pair cache
+	else if (parameters[0] == "col-cache")
+	{
+		output.commandType = CommandType::TOGGLE_PAIR_CACHE;
+		outputMessage += "Pair cache";
+	}
+
+	// toggle the EPA contact pass of the GJK narrow phase
+	else if (parameters[0] == "col-epa")
+	{
+		output.commandType = CommandType::TOGGLE_EPA;
+		outputMessage += "EPA contacts";
+	}
+
 
 	// not a valid toggle target, print error return invalid command
 	else
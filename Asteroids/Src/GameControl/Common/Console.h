@@ -29,11 +29,24 @@ public:
 		TOGGLE_BULLET_COLLISION,
 		TOGGLE_DRAW_GRID,
 		TOGGLE_COLLISION_INFO,
+		TOGGLE_PAIR_CACHE,
+		TOGGLE_EPA,
 		SET_BROAD_COLLISION_BRUTE_FORCE,
 		SET_BROAD_COLLISION_UNIFORM_GRID,
 		SET_BROAD_COLLISION_QUADTREE,
+		SET_BROAD_COLLISION_SWEEP_AND_PRUNE,
+		SET_BROAD_COLLISION_AABB_TREE,
+		SET_BROAD_COLLISION_LINEAR_QUADTREE,
+		SET_BROAD_COLLISION_SPATIAL_HASH,
+		SET_BROAD_COLLISION_UNIFORM_GRID_CSR,
+		SET_BROAD_COLLISION_UNIFORM_GRID_PARALLEL,
+		SET_BROAD_COLLISION_HIERARCHICAL_GRID,
+		SET_BROAD_COLLISION_AUTO,
 		SET_NARROW_COLLISION_AABB,
 		SET_NARROW_COLLISION_SAT,
+		SET_NARROW_COLLISION_SAT_SIMD,
+		SET_NARROW_COLLISION_SAT_SPECIALISED,
+		SET_NARROW_COLLISION_GJK,
 		SPAWN_ASTEROID
 	};
 
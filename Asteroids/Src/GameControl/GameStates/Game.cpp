@@ -27,38 +27,57 @@ Game::Game(sf::RenderWindow* window)
 	// Create uniform grid
 	this->_uniformGrid = new UniformGrid();
 
-	// Create uniform grid
-	this->_quadTree = new QuadTree(sf::FloatRect(WINDOW_WIDTH/2, WINDOW_HEIGHT/2, WINDOW_WIDTH/2, WINDOW_HEIGHT/2), QUADTREE_CELL_LIMIT);
+	// Create loose quadtree
+	this->_quadTree = new QuadTree(sf::FloatRect(WINDOW_WIDTH/2, WINDOW_HEIGHT/2, WINDOW_WIDTH/2, WINDOW_HEIGHT/2), QUADTREE_CELL_LIMIT, QUADTREE_LOOSENESS);
+
+	// Create sweep and prune
+	this->_sweepAndPrune = new SweepAndPrune();
+
+	// Create dynamic aabb tree
+	this->_aabbTree = new DynamicAABBTree();
+
+	// Create linear quadtree
+	this->_linearQuadTree = new LinearQuadTree(sf::FloatRect(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT));
+
+	// Create spatial hash grid
+	this->_spatialHashGrid = new SpatialHashGrid(SPATIAL_HASH_CELL_SIZE);
+
+	// Create hierarchical grid
+	this->_hierarchicalGrid = new HierarchicalGrid(HIERARCHICAL_GRID_MIN_CELL_SIZE);
+
+	// Create bullet pool
+	this->_bulletPool = new BulletPool(BULLET_POOL_CAPACITY);
 
 	// Generate player
 	this->_player = new Player;
-	_uniformGrid->AddObject(this->_player);
-	_quadTree->AddObject(this->_player);
+
+	// Create collision handler, only the structure its broad phase reads is filled
+	this->_collisionHandler = new CollisionHandler(*_uniformGrid, _asteroids, _bulletPool->GetLive(), *_player, _quadTree, *_sweepAndPrune, *_aabbTree, *_linearQuadTree, *_spatialHashGrid, *_hierarchicalGrid);
+	this->_collisionHandler->SetWrapGhosts(&this->_wrapGhosts);
+	this->_maintainedBroadPhase = this->_collisionHandler->GetBroadCollisionMode();
+	AddToBroadPhase(this->_player);
 
 	// Generate asteroids
 	for (unsigned int i = 0; i < NUMBER_ASTEROIDS; i++)
 	{
 		this->_asteroids.push_back(new Asteroid(i));
-		_uniformGrid->AddObject(_asteroids.back());
-		_quadTree->AddObject(_asteroids.back());
+		AddToBroadPhase(_asteroids.back());
+		_asteroidStore.Add(_asteroids.back(), Asteroid::ROTATION_SPEED);
 	}
 	// Small and medium asteroids only generated at start given testing parameters
 	for (unsigned int i = 0; i < nMediumAsteroids; i++)
 	{
 		this->_asteroids.push_back(new Asteroid(i, Asteroid::Size::MEDIUM));
-		_uniformGrid->AddObject(_asteroids.back());
-		_quadTree->AddObject(_asteroids.back());
+		AddToBroadPhase(_asteroids.back());
+		_asteroidStore.Add(_asteroids.back(), Asteroid::ROTATION_SPEED);
 	}
 	for (unsigned int i = 0; i < nSmallAsteroids; i++)
 	{
 		this->_asteroids.push_back(new Asteroid(i, Asteroid::Size::SMALL));
-		_uniformGrid->AddObject(_asteroids.back());
-		_quadTree->AddObject(_asteroids.back());
+		AddToBroadPhase(_asteroids.back());
+		_asteroidStore.Add(_asteroids.back(), Asteroid::ROTATION_SPEED);
 	}
 
-	// Create collision handler
-	this->_collisionHandler = new CollisionHandler(*_uniformGrid, _asteroids, _bullets, *_player, _quadTree);
-
 	// Create console
 	this->_console = new Console();
 }
@@ -77,6 +96,26 @@ Game::~Game()
 	if (this->_quadTree)
 		delete this->_quadTree;
 
+	// Cleanup sweep and prune
+	if (this->_sweepAndPrune)
+		delete this->_sweepAndPrune;
+
+	// Cleanup aabb tree
+	if (this->_aabbTree)
+		delete this->_aabbTree;
+
+	// Cleanup linear quadtree
+	if (this->_linearQuadTree)
+		delete this->_linearQuadTree;
+
+	// Cleanup spatial hash grid
+	if (this->_spatialHashGrid)
+		delete this->_spatialHashGrid;
+
+	// Cleanup hierarchical grid
+	if (this->_hierarchicalGrid)
+		delete this->_hierarchicalGrid;
+
 	// Cleanup collisionHandler
 	if (this->_collisionHandler)
 		delete this->_collisionHandler;
@@ -87,11 +126,9 @@ Game::~Game()
 		delete* it;
 	}
 
-	// clean up any bullets
-	for (auto it = this->_bullets.begin(); it != this->_bullets.end(); it++)
-	{
-		delete* it;
-	}
+	// clean up the bullets, live ones included
+	if (this->_bulletPool)
+		delete this->_bulletPool;
 }
 
 
@@ -115,7 +152,7 @@ void Game::ComposeFrame()
 	}
 
 	// Draw bullets
-	for (auto it = this->_bullets.begin(); it != this->_bullets.end(); it++)
+	for (auto it = this->_bulletPool->GetLive().begin(); it != this->_bulletPool->GetLive().end(); it++)
 	{
 		(*it)->Draw(_window);
 	}
@@ -162,14 +199,23 @@ void Game::UpdateModel()
 	// Update Bullets
 	this->UpdateBullets();
 
-	// Update grid systems
+	// Give sprites over a screen edge a ghost on the other side
+	this->UpdateWrapGhosts();
+
+	// Update grid systems, timed so the auto broad phase can weigh upkeep against testing
+	sf::Clock maintenanceClock;
 	this->UpdateGrid();
+	float maintenanceTime = maintenanceClock.getElapsedTime().asSeconds();
 
 	// Handle all collision logic
 	CollisionPhaseData data = this->_collisionHandler->HandleCollision();
 
+	// Let the auto broad phase pick the mode for the next frame
+	this->_collisionHandler->UpdateAutoBroadPhase(maintenanceTime, data);
+	this->SwitchBroadPhase();
+
 	// Update collision text
-	this->UpdateCollisionText(data.nCollisionTests, data.nCollisions);
+	this->UpdateCollisionText(data);
 
 	// temp player collision demonstration
 	if (data.isPlayerColliding)
@@ -187,6 +233,10 @@ void Game::UpdateModel()
 */
 void Game::UpdateAsteroids()
 {
+	// Move, spin and wrap every asteroid in one pass over the store,
+	// each asteroid's update then reads its transform back
+	this->_asteroidStore.Integrate();
+
 	// Update Asteroids
 	for (auto it = this->_asteroids.begin(); it != this->_asteroids.end(); it++)
 	{
@@ -205,10 +255,6 @@ void Game::UpdateAsteroids()
 		}
 
 		(*it)->Update(); // Call update on the asteroid
-
-		// Check to see if the ball has changed cells
-		if (this->_collisionHandler->GetBroadCollisionMode() == BroadCollisionMode::UNIFORM_GRID)
-			UpdateSpriteGrid(*it);
 	}
 }
 
@@ -221,14 +267,11 @@ void Game::UpdateAsteroids()
 void Game::UpdateBullets()
 {
 	// Update bullets
-	for (auto it = this->_bullets.begin(); it != this->_bullets.end(); it++)
+	for (auto it = this->_bulletPool->GetLive().begin(); it != this->_bulletPool->GetLive().end(); it++)
 	{
 		(*it)->Update(); // call update on the bullet
 
-
-		// Check to see if the ball has changed cells
-		if (this->_collisionHandler->GetBroadCollisionMode() == BroadCollisionMode::UNIFORM_GRID)
-			UpdateSpriteGrid(*it);
+		// bullets aren't kept in the uniform grid, the grid modes sweep them through it instead
 	}
 }
 
@@ -262,19 +305,19 @@ void Game::SplitAsteroid(unsigned int asteroidIndex)
 		this->_asteroids.push_back(new Asteroid(this->_asteroids.size(), Asteroid::Size((int)asteroid->GetSize() + 1), pos, vel));
 		this->_asteroids.push_back(new Asteroid(this->_asteroids.size(), Asteroid::Size((int)asteroid->GetSize() + 1), pos, -vel));
 
-		// Add the new asteroids to their correct cells
-		this->_uniformGrid->AddObject(_asteroids[_asteroids.size()- 1]);
-		this->_uniformGrid->AddObject(_asteroids[_asteroids.size() - 2]);
+		// Add the new asteroids to the structure of the running broad phase
+		this->AddToBroadPhase(_asteroids[_asteroids.size() - 1]);
+		this->AddToBroadPhase(_asteroids[_asteroids.size() - 2]);
 
-		// Add the objects to their correct quadtree
-		this->_quadTree->AddObject(_asteroids[_asteroids.size() - 1]);
-		this->_quadTree->AddObject(_asteroids[_asteroids.size() - 2]);
+		// Add the new asteroids to the entity store that moves them
+		this->_asteroidStore.Add(_asteroids[_asteroids.size() - 1], Asteroid::ROTATION_SPEED);
+		this->_asteroidStore.Add(_asteroids[_asteroids.size() - 2], Asteroid::ROTATION_SPEED);
 	}
 
 	// clean up old asteroid
-	this->_uniformGrid->RemoveObject(asteroid);	// Remove from the corresponding cell
+	this->RemoveFromBroadPhase(asteroid);	// Remove from the structure of the running broad phase
 
-	// Delete asteroid from memory
+	// Delete asteroid from memory, this also removes it from the entity store
 	delete asteroid;
 	// Delete asteroid from the vector by copying then popping
 	this->_asteroids[asteroidIndex] = this->_asteroids.back();
@@ -287,24 +330,21 @@ void Game::SplitAsteroid(unsigned int asteroidIndex)
  * Brief:
  * Deletes any bullets marked invisible internally. isVisible = false indicates
  * the bullet has either collided with an asteroid or has escaped the bounds of the
- * window.
+ * window. Dead bullets are taken out of the running broad phase's structure as
+ * one batch and their slots returned to the bullet pool.
 */
 void Game::CleanupBullets()
 {
-for (unsigned int i = 0; i < this->_bullets.size(); i++)
-{
-	// Check if bullet has disappeared from screen
-	if (!this->_bullets[i]->IsVisible())
-	{
-		// Remove bullet from grid system
-		this->_uniformGrid->RemoveObject(this->_bullets[i]);
-		this->_quadTree->RemoveObject(this->_bullets[i]);
+	// Find every bullet that has hit something or left the screen
+	const std::vector<WireframeSprite*>& deadBullets = this->_bulletPool->CollectDead();
+	if (deadBullets.empty())
+		return;
 
-		// Delete bullet and remove entry from vector
-		delete this->_bullets[i];
-		this->_bullets.erase(this->_bullets.begin() + i);
-	}
-}
+	// take them out of the structure as one batch
+	this->RemoveFromBroadPhase(deadBullets);
+
+	// hand the slots back to the pool
+	this->_bulletPool->ReleaseDead();
 }
 
 /*void HandleInput
@@ -343,10 +383,11 @@ void Game::HandleInput()
 		// Input for firing bullets 
 		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space))
 		{
-			// create a new bullet and add it to the grid systems
-			this->_bullets.push_back(new Bullet(this->_player->GetPosition(), this->_player->GetRotation()));
-			_uniformGrid->AddObject(this->_bullets.back());
-			_quadTree->AddObject(this->_bullets.back());
+			// fire a bullet from the pool and add it to the running broad phase's
+			// structure, if every bullet is already in flight the shot is dropped
+			Bullet* bullet = this->_bulletPool->Spawn(this->_player->GetPosition(), this->_player->GetRotation());
+			if (bullet)
+				this->AddToBroadPhase(bullet);
 			// to see if the clock should be reset
 			hasKeyBeenPressed = true;
 		}
@@ -357,6 +398,48 @@ void Game::HandleInput()
 		_lastInputClock.restart();
 }
 
+/* void UpdateWrapGhosts
+ * Brief:
+ *	Takes last frame's wrap ghosts out of the uniform grid and quadtree and
+ *	makes new ones for the player and asteroids over a screen edge. The ghosts
+ *	are only added to the structure the active broad phase reads, brute force
+ *	reads them straight from the list.
+ */
+void Game::UpdateWrapGhosts()
+{
+	// the ghosts know which structures they're in
+	for (unsigned int i = 0; i < this->_wrapGhosts.GetCount(); i++)
+	{
+		WireframeSprite* ghost = this->_wrapGhosts.GetGhost(i);
+		if (ghost->GetOwnerCell())
+			this->_uniformGrid->RemoveObject(ghost);
+		this->_quadTree->RemoveObject(ghost);
+	}
+	this->_wrapGhosts.Clear();
+
+	BroadCollisionMode mode = this->_collisionHandler->GetBroadCollisionMode();
+	bool useGrid = this->UsesIncrementalUniformGrid();
+	bool useQuadTree = mode == BroadCollisionMode::QUADTREE;
+
+	// only the uniform grids, the quadtree and brute force know about the ghosts
+	if (!useGrid && !useQuadTree && mode != BroadCollisionMode::UNIFORM_GRID_CSR && mode != BroadCollisionMode::BRUTE_FORCE)
+		return;
+
+	this->_wrapGhosts.AddGhostsOf(this->_player);
+	for (unsigned int i = 0; i < this->_asteroids.size(); i++)
+		this->_wrapGhosts.AddGhostsOf(this->_asteroids[i]);
+
+	// the csr grid picks the ghosts up when it's rebuilt
+	for (unsigned int i = 0; i < this->_wrapGhosts.GetCount(); i++)
+	{
+		WireframeSprite* ghost = this->_wrapGhosts.GetGhost(i);
+		if (useGrid)
+			this->_uniformGrid->AddObject(ghost);
+		if (useQuadTree)
+			this->_quadTree->AddObject(ghost);
+	}
+}
+
 /* void DrawGrid
  * Brief:
  * Checks if the user wishes to draw the spatial grid to the screen.
@@ -376,8 +459,34 @@ void Game::DrawGrid()
 
 			// draw the uniformgrid
 		case(BroadCollisionMode::UNIFORM_GRID):
+		case(BroadCollisionMode::UNIFORM_GRID_CSR):
+		case(BroadCollisionMode::UNIFORM_GRID_PARALLEL):
 			this->_uniformGrid->Draw(_window);
 			break;
+
+			// draw the aabb tree
+		case(BroadCollisionMode::AABB_TREE):
+			this->_aabbTree->Draw(_window);
+			break;
+
+			// draw the linear quadtree
+		case(BroadCollisionMode::LINEAR_QUADTREE):
+			this->_linearQuadTree->Draw(_window);
+			break;
+
+			// draw the spatial hash grid
+		case(BroadCollisionMode::SPATIAL_HASH):
+			this->_spatialHashGrid->Draw(_window);
+			break;
+
+			// draw the occupied cells of every hierarchical grid level
+		case(BroadCollisionMode::HIERARCHICAL_GRID):
+			this->_hierarchicalGrid->Draw(_window);
+			break;
+
+			// brute force and sweep and prune have nothing to draw, AUTO is never the running mode
+		default:
+			break;
 		}
 }
 
@@ -393,16 +502,216 @@ void Game::UpdateGrid()
 	{
 		// update uniform grid
 	case BroadCollisionMode::UNIFORM_GRID:
-		UpdateSpriteGrid(_player);
+	case BroadCollisionMode::UNIFORM_GRID_PARALLEL:
+		this->UpdateUniformGrid();
 		break;
 
 		// update quadtree
 	case BroadCollisionMode::QUADTREE:
 		this->UpdateQuadTree();
 		break;
+
+		// update sweep and prune endpoints
+	case BroadCollisionMode::SWEEP_AND_PRUNE:
+		this->_sweepAndPrune->Update();
+		break;
+
+		// update aabb tree proxies
+	case BroadCollisionMode::AABB_TREE:
+		this->UpdateAABBTree();
+		break;
+
+		// re-sort the linear quadtree
+	case BroadCollisionMode::LINEAR_QUADTREE:
+		this->_linearQuadTree->Update();
+		break;
+
+		// update the spatial hash grid
+	case BroadCollisionMode::SPATIAL_HASH:
+		this->_spatialHashGrid->Update();
+		break;
+
+		// rebuild the hierarchical grid
+	case BroadCollisionMode::HIERARCHICAL_GRID:
+		this->_hierarchicalGrid->Update();
+		break;
+
+		// rebuild the csr uniform grid
+	case BroadCollisionMode::UNIFORM_GRID_CSR:
+		this->RebuildUniformGridCSR();
+		break;
+
+		// brute force has no structure, AUTO is never the running mode
+	default:
+		break;
+	}
+}
+
+/* void AddToBroadPhase
+ * Brief:
+ *	Adds a sprite to the structure the running broad phase reads. The other
+ *	structures are left empty so they cost nothing while they're idle.
+ * Params:
+ *	<WireframeSprite*> sprite	-	sprite to add
+ */
+void Game::AddToBroadPhase(WireframeSprite* sprite)
+{
+	switch (this->_maintainedBroadPhase)
+	{
+	case BroadCollisionMode::UNIFORM_GRID:
+	case BroadCollisionMode::UNIFORM_GRID_PARALLEL:
+		// bullets are swept through the grid rather than stored in it
+		if (sprite->GetCategory() != CollisionCategory::BULLET)
+			this->_uniformGrid->AddObject(sprite);
+		break;
+
+	case BroadCollisionMode::QUADTREE:
+		this->_quadTree->AddObject(sprite);
+		break;
+
+	case BroadCollisionMode::SWEEP_AND_PRUNE:
+		this->_sweepAndPrune->AddObject(sprite);
+		break;
+
+	case BroadCollisionMode::AABB_TREE:
+		this->_aabbTree->AddObject(sprite);
+		break;
+
+	case BroadCollisionMode::LINEAR_QUADTREE:
+		this->_linearQuadTree->AddObject(sprite);
+		break;
+
+	case BroadCollisionMode::SPATIAL_HASH:
+		this->_spatialHashGrid->AddObject(sprite);
+		break;
+
+	case BroadCollisionMode::HIERARCHICAL_GRID:
+		this->_hierarchicalGrid->AddObject(sprite);
+		break;
+
+		// brute force has no structure and the csr grid is rebuilt from the sprite lists
+	default:
+		break;
+	}
+}
+
+/* void RemoveFromBroadPhase
+ * Brief:
+ *	Removes a sprite from the structure the running broad phase reads
+ * Params:
+ *	<WireframeSprite*> sprite	-	sprite to remove
+ */
+void Game::RemoveFromBroadPhase(WireframeSprite* sprite)
+{
+	switch (this->_maintainedBroadPhase)
+	{
+	case BroadCollisionMode::UNIFORM_GRID:
+	case BroadCollisionMode::UNIFORM_GRID_PARALLEL:
+		if (sprite->GetOwnerCell())
+			this->_uniformGrid->RemoveObject(sprite);
+		break;
+
+	case BroadCollisionMode::QUADTREE:
+		this->_quadTree->RemoveObject(sprite);
+		break;
+
+	case BroadCollisionMode::SWEEP_AND_PRUNE:
+		this->_sweepAndPrune->RemoveObject(sprite);
+		break;
+
+	case BroadCollisionMode::AABB_TREE:
+		this->_aabbTree->RemoveObject(sprite);
+		break;
+
+	case BroadCollisionMode::LINEAR_QUADTREE:
+		this->_linearQuadTree->RemoveObject(sprite);
+		break;
+
+	case BroadCollisionMode::SPATIAL_HASH:
+		this->_spatialHashGrid->RemoveObject(sprite);
+		break;
+
+	case BroadCollisionMode::HIERARCHICAL_GRID:
+		this->_hierarchicalGrid->RemoveObject(sprite);
+		break;
+
+	default:
+		break;
+	}
+}
+
+/* void RemoveFromBroadPhase
+ * Brief:
+ *	Removes a batch of sprites from the structure the running broad phase
+ *	reads. The list based structures drop the whole batch in one pass.
+ * Params:
+ *	<const vector<WireframeSprite*>&> sprites	-	sprites to remove, sorted by address
+ */
+void Game::RemoveFromBroadPhase(const std::vector<WireframeSprite*>& sprites)
+{
+	switch (this->_maintainedBroadPhase)
+	{
+	case BroadCollisionMode::SWEEP_AND_PRUNE:
+		this->_sweepAndPrune->RemoveObjects(sprites);
+		break;
+
+	case BroadCollisionMode::LINEAR_QUADTREE:
+		this->_linearQuadTree->RemoveObjects(sprites);
+		break;
+
+	case BroadCollisionMode::SPATIAL_HASH:
+		this->_spatialHashGrid->RemoveObjects(sprites);
+		break;
+
+	case BroadCollisionMode::HIERARCHICAL_GRID:
+		this->_hierarchicalGrid->RemoveObjects(sprites);
+		break;
+
+		// the grid and trees unlink each sprite through its own link
+	default:
+		for (unsigned int i = 0; i < sprites.size(); i++)
+			this->RemoveFromBroadPhase(sprites[i]);
+		break;
 	}
 }
 
+/* void SwitchBroadPhase
+ * Brief:
+ *	Called whenever the broad phase may have changed, from the console or by
+ *	the auto broad phase. If it has, every sprite is taken out of the old
+ *	mode's structure and added to the new one's.
+ */
+void Game::SwitchBroadPhase()
+{
+	BroadCollisionMode mode = this->_collisionHandler->GetBroadCollisionMode();
+	if (mode == this->_maintainedBroadPhase)
+		return;
+
+	// gather every live sprite, sorted so the list based structures can drop them in one pass
+	this->_gatheredSprites.clear();
+	this->_gatheredSprites.push_back(this->_player);
+	this->_gatheredSprites.insert(this->_gatheredSprites.end(), this->_asteroids.begin(), this->_asteroids.end());
+	this->_gatheredSprites.insert(this->_gatheredSprites.end(), this->_bulletPool->GetLive().begin(), this->_bulletPool->GetLive().end());
+	std::sort(this->_gatheredSprites.begin(), this->_gatheredSprites.end());
+
+	// empty the old structure then fill the new one, the wrap ghosts are moved by UpdateWrapGhosts
+	this->RemoveFromBroadPhase(this->_gatheredSprites);
+	this->_maintainedBroadPhase = mode;
+	for (unsigned int i = 0; i < this->_gatheredSprites.size(); i++)
+		this->AddToBroadPhase(this->_gatheredSprites[i]);
+}
+
+/* bool UsesIncrementalUniformGrid
+ * Brief:
+ *	Returns true if the active broad phase reads the uniform grid that's
+ *	updated as sprites move between cells
+ */
+bool Game::UsesIncrementalUniformGrid() const
+{
+	BroadCollisionMode mode = this->_collisionHandler->GetBroadCollisionMode();
+	return mode == BroadCollisionMode::UNIFORM_GRID || mode == BroadCollisionMode::UNIFORM_GRID_PARALLEL;
+}
+
 /* void UpdateSpriteGrid
  * Brief:
  *	Takes a sprite and calculates which grid in the uniform grid
@@ -416,7 +725,7 @@ void Game::UpdateSpriteGrid(WireframeSprite* sprite)
 {
 
 	// do nothing if not the right collision mode
-	if (this->_collisionHandler->GetBroadCollisionMode() != BroadCollisionMode::UNIFORM_GRID)
+	if (!this->UsesIncrementalUniformGrid())
 		return;
 
 	// Check to see if the ball has changed cells
@@ -429,11 +738,29 @@ void Game::UpdateSpriteGrid(WireframeSprite* sprite)
 	}
 }
 
+/* void UpdateUniformGrid
+ * Brief:
+ *	Moves the player and every asteroid that has changed cell into its new
+ *	cell. Done with the other structures' upkeep so the auto broad phase
+ *	times it along with theirs.
+ */
+void Game::UpdateUniformGrid()
+{
+	// relocate player in grid
+	UpdateSpriteGrid(_player);
+
+	// relocate asteroids in grid
+	for (auto it = this->_asteroids.begin(); it != this->_asteroids.end(); it++)
+	{
+		UpdateSpriteGrid(*it);
+	}
+}
+
 /* void UpdateQuadTree
  * Brief:
- *	Updates the objects in the quadtree by first clearing it
- *  then reconstructing it. This seems to be a reasonably efficient
- *  solution to updating the positions of sprites within the system.
+ *	Updates the objects in the quadtree in place. The tree is loose so
+ *  sprites are only relocated once they leave the loose bounds of the
+ *  node that owns them, the tree is never cleared and rebuilt.
  */
 void Game::UpdateQuadTree()
 {
@@ -441,31 +768,70 @@ void Game::UpdateQuadTree()
 	if (this->_collisionHandler->GetBroadCollisionMode() != BroadCollisionMode::QUADTREE)
 		return;
 
-	// Delete the old tree
-	this->_quadTree->Clear();
+	// relocate player in tree
+	this->_quadTree->UpdateObject(_player);
 
-	// add player to tree
-	this->_quadTree->AddObject(_player);
+	// relocate asteroids in tree
+	for (auto it = this->_asteroids.begin(); it != this->_asteroids.end(); it++)
+	{
+		this->_quadTree->UpdateObject(*it);
+	}
 
-	// add asteroids to tree
+	// relocate bullets in tree
+	for (auto it = this->_bulletPool->GetLive().begin(); it != this->_bulletPool->GetLive().end(); it++)
+	{
+		this->_quadTree->UpdateObject(*it);
+	}
+}
+
+/* void UpdateAABBTree
+ * Brief:
+ *	Updates every proxy in the dynamic aabb tree. Sprites that are still
+ *	inside their fat bounds don't change the tree, only the ones that have
+ *	escaped are reinserted.
+ */
+void Game::UpdateAABBTree()
+{
+	// update player proxy
+	this->_aabbTree->UpdateObject(_player);
+
+	// update asteroid proxies
 	for (auto it = this->_asteroids.begin(); it != this->_asteroids.end(); it++)
 	{
-		this->_quadTree->AddObject(*it);
+		this->_aabbTree->UpdateObject(*it);
 	}
 
-	// add bullets to tree
-	for (auto it = this->_bullets.begin(); it != this->_bullets.end(); it++)
+	// update bullet proxies
+	for (auto it = this->_bulletPool->GetLive().begin(); it != this->_bulletPool->GetLive().end(); it++)
 	{
-		this->_quadTree->AddObject(*it);
+		this->_aabbTree->UpdateObject(*it);
 	}
 }
 
+/* void RebuildUniformGridCSR
+ * Brief:
+ *	Gathers every sprite into one list and rebuilds the csr copy of the
+ *	uniform grid from it. The list is kept between frames so it doesn't allocate.
+ *	Bullets are left out as they're swept through the grid, wrap ghosts are included.
+ */
+void Game::RebuildUniformGridCSR()
+{
+	this->_gatheredSprites.clear();
+	this->_gatheredSprites.push_back(this->_player);
+	this->_gatheredSprites.insert(this->_gatheredSprites.end(), this->_asteroids.begin(), this->_asteroids.end());
+
+	for (unsigned int i = 0; i < this->_wrapGhosts.GetCount(); i++)
+		this->_gatheredSprites.push_back(this->_wrapGhosts.GetGhost(i));
+
+	this->_uniformGrid->RebuildCSR(this->_gatheredSprites);
+}
+
 /* void UpdateCollisionText
  * Brief:
  * Updates the collision text with the number of collision and
  * collision tests.
  */
-void Game::UpdateCollisionText(unsigned int nCollisionTests, unsigned int nCollisions)
+void Game::UpdateCollisionText(const CollisionPhaseData& data)
 {
 	// only update collisions if flag is set
 	if (!this->_drawCollisionInfo)
@@ -473,19 +839,29 @@ void Game::UpdateCollisionText(unsigned int nCollisionTests, unsigned int nColli
 
 
 	// Update max col tests
-	if (nCollisionTests > _maxColTests)
-		_maxColTests = nCollisionTests;
+	if (data.nCollisionTests > _maxColTests)
+		_maxColTests = data.nCollisionTests;
 
 	// update min col tests
-	if (nCollisionTests < _minColTests)
-		_minColTests = nCollisionTests;
+	if (data.nCollisionTests < _minColTests)
+		_minColTests = data.nCollisionTests;
+
+	// collision tests per second over the whole collision pass, compare with the same broad phase
+	unsigned long long testsPerSecond = data.collisionTime > 0.0f ?
+		static_cast<unsigned long long>(data.nCollisionTests / data.collisionTime) : 0;
 
 	// set collision string
 	this->_collisionInfo.setString(
-	"Collision Tests: " + std::to_string(nCollisionTests) +
-	"\nCollisions: "	+ std::to_string(nCollisions) +
+	"Collision Tests: " + std::to_string(data.nCollisionTests) +
+	"\nCollisions: "	+ std::to_string(data.nCollisions) +
 	"\nMax Tests: "		+ std::to_string(_maxColTests) + 
-	"\nMin Tests: "		+ std::to_string(_minColTests));
+	"\nMin Tests: "		+ std::to_string(_minColTests) +
+	"\nBroad Phase: "	+ this->_collisionHandler->GetBroadCollisionModeName() +
+	"\nNarrow Phase: "	+ this->_collisionHandler->GetNarrowCollisionModeName() +
+	"\nTests/sec: "		+ std::to_string(testsPerSecond) +
+	"\nContacts: "		+ std::to_string(data.contacts ? data.contacts->size() : 0) +
+	"\nAllocations: "	+ std::to_string(data.nAllocations) +
+	"\nCache Skips: "	+ std::to_string(data.nCacheSkips));
 }
 
 /* void HandleConsoleCommands
@@ -518,6 +894,18 @@ void Game::HandleConsoleCommands(Console::ParsedCommandData& data)
 		this->_collisionHandler->ToggleBulletCollision();
 		break;
 
+		// Toggle pair cache
+	case (Console::CommandType::TOGGLE_PAIR_CACHE):
+		this->_collisionHandler->TogglePairCache();
+		resetColVariables = true;
+		break;
+
+		// Toggle EPA contacts
+	case (Console::CommandType::TOGGLE_EPA):
+		this->_collisionHandler->ToggleEPA();
+		resetColVariables = true;
+		break;
+
 		// Toggle Draw grid
 	case (Console::CommandType::TOGGLE_DRAW_GRID):
 		this->_drawGrid = !this->_drawGrid;
@@ -546,6 +934,54 @@ void Game::HandleConsoleCommands(Console::ParsedCommandData& data)
 		resetColVariables = true;
 		break;
 
+		// Set col-broad sap
+	case (Console::CommandType::SET_BROAD_COLLISION_SWEEP_AND_PRUNE):
+		this->_collisionHandler->SetBroadCollisionMode(BroadCollisionMode::SWEEP_AND_PRUNE);
+		resetColVariables = true;
+		break;
+
+		// Set col-broad aabbtree
+	case (Console::CommandType::SET_BROAD_COLLISION_AABB_TREE):
+		this->_collisionHandler->SetBroadCollisionMode(BroadCollisionMode::AABB_TREE);
+		resetColVariables = true;
+		break;
+
+		// Set col-broad linearquadtree
+	case (Console::CommandType::SET_BROAD_COLLISION_LINEAR_QUADTREE):
+		this->_collisionHandler->SetBroadCollisionMode(BroadCollisionMode::LINEAR_QUADTREE);
+		resetColVariables = true;
+		break;
+
+		// Set col-broad spatialhash
+	case (Console::CommandType::SET_BROAD_COLLISION_SPATIAL_HASH):
+		this->_collisionHandler->SetBroadCollisionMode(BroadCollisionMode::SPATIAL_HASH);
+		resetColVariables = true;
+		break;
+
+		// Set col-broad uniformgridcsr
+	case (Console::CommandType::SET_BROAD_COLLISION_UNIFORM_GRID_CSR):
+		this->_collisionHandler->SetBroadCollisionMode(BroadCollisionMode::UNIFORM_GRID_CSR);
+		resetColVariables = true;
+		break;
+
+		// Set col-broad uniformgridparallel
+	case (Console::CommandType::SET_BROAD_COLLISION_UNIFORM_GRID_PARALLEL):
+		this->_collisionHandler->SetBroadCollisionMode(BroadCollisionMode::UNIFORM_GRID_PARALLEL);
+		resetColVariables = true;
+		break;
+
+		// Set col-broad hierarchicalgrid
+	case (Console::CommandType::SET_BROAD_COLLISION_HIERARCHICAL_GRID):
+		this->_collisionHandler->SetBroadCollisionMode(BroadCollisionMode::HIERARCHICAL_GRID);
+		resetColVariables = true;
+		break;
+
+		// Set col-broad auto
+	case (Console::CommandType::SET_BROAD_COLLISION_AUTO):
+		this->_collisionHandler->SetBroadCollisionMode(BroadCollisionMode::AUTO);
+		resetColVariables = true;
+		break;
+
 		// Set col-narrow AABB
 	case (Console::CommandType::SET_NARROW_COLLISION_AABB):
 		this->_collisionHandler->SetNarrowCollisionMode(NarrowCollisionMode::AABB);
@@ -558,6 +994,24 @@ void Game::HandleConsoleCommands(Console::ParsedCommandData& data)
 		resetColVariables = true;
 		break;
 
+		// Set col-narrow SAT SIMD
+	case (Console::CommandType::SET_NARROW_COLLISION_SAT_SIMD):
+		this->_collisionHandler->SetNarrowCollisionMode(NarrowCollisionMode::SEPERATED_AXIS_THEOREM_SIMD);
+		resetColVariables = true;
+		break;
+
+		// Set col-narrow SAT specialised
+	case (Console::CommandType::SET_NARROW_COLLISION_SAT_SPECIALISED):
+		this->_collisionHandler->SetNarrowCollisionMode(NarrowCollisionMode::SEPERATED_AXIS_THEOREM_SPECIALISED);
+		resetColVariables = true;
+		break;
+
+		// Set col-narrow GJK
+	case (Console::CommandType::SET_NARROW_COLLISION_GJK):
+		this->_collisionHandler->SetNarrowCollisionMode(NarrowCollisionMode::GJK);
+		resetColVariables = true;
+		break;
+
 		// Spawn asteroids
 	case (Console::CommandType::SPAWN_ASTEROID):
 		this->SpawnAsteroids(static_cast<unsigned int>(data.additionalValue));
@@ -578,12 +1032,15 @@ void Game::HandleConsoleCommands(Console::ParsedCommandData& data)
 		this->_maxColTests = 0;
 		this->_minColTests = INT_MAX;
 	}
+
+	// move the sprites over if the broad phase changed
+	this->SwitchBroadPhase();
 }
 
 /* void SpawnAsteroids
  * Brief:
  *	takes in n asteroids and spawns them into the game. firstly adds them to the
- *  asteroid container followed by adding them to any present grid systems.
+ *  asteroid container followed by adding them to the running broad phase's structure.
  * Params:
  *	<unsigned int> nAsteroidsToSpawn	-	number of asteroids to spawn
  */
@@ -592,10 +1049,10 @@ void Game::SpawnAsteroids(const unsigned int nAsteroidsToSpawn)
 	// Loop through n asteroids to spawn for asteroid spawning
 	for (unsigned int i = 0; i < nAsteroidsToSpawn; i++)
 	{
-		// add the new asteroid to the container and add to the grid systems
+		// add the new asteroid to the container and add to the running broad phase's structure
 		this->_asteroids.push_back(new Asteroid(this->_asteroids.size()));
-		this->_uniformGrid->AddObject(this->_asteroids.back());
-		this->_quadTree->AddObject(this->_asteroids.back());
+		this->AddToBroadPhase(this->_asteroids.back());
+		this->_asteroidStore.Add(this->_asteroids.back(), Asteroid::ROTATION_SPEED);
 	}
 }
 
@@ -611,7 +1068,7 @@ void Game::SetupCollisionInfoDisplay()
 	this->_collisionInfo.setFillColor(sf::Color::Cyan);
 
 	// setup background for collision info text
-	this->_collisionInfoBackground.setSize({ tempSize, 100.0f});
+	this->_collisionInfoBackground.setSize({ tempSize, 200.0f});
 	this->_collisionInfoBackground.setFillColor(sf::Color::Black);
 	this->_collisionInfoBackground.setOutlineColor(sf::Color::Red);
 	this->_collisionInfoBackground.setPosition({ tempSize, 0 });
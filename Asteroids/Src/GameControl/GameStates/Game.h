@@ -1,11 +1,19 @@
 #pragma once
 #include "../../GameObjects/Player/Player.h"
 #include "../../GameObjects/Other/Asteroid.h"
+#include "../../GameObjects/Other/BulletPool.h"
 #include "../Common/Console.h"
 #include "State.h"
 #include "../Backend/CollisionHandler.h"
+#include "../Backend/WrapGhosts.h"
+#include "../../GameObjects/Base/EntityStore.h"
 #include "../Backend/SpatialPartitioning/UniformGrid.h"
 #include "../Backend/SpatialPartitioning/QuadTree.h"
+#include "../Backend/SpatialPartitioning/SweepAndPrune.h"
+#include "../Backend/SpatialPartitioning/DynamicAABBTree.h"
+#include "../Backend/SpatialPartitioning/LinearQuadTree.h"
+#include "../Backend/SpatialPartitioning/SpatialHashGrid.h"
+#include "../Backend/SpatialPartitioning/HierarchicalGrid.h"
 #include "../../Global/ApplicationDefines.h"
 #include <functional>
 #include <vector>
@@ -52,7 +60,8 @@ private:
 	 * Brief:
 	 * Deletes any bullets marked invisible internally. isVisible = false indicates
 	 * the bullet has either collided with an asteroid or has escaped the bounds of the
-	 * window.
+	 * window. Dead bullets are taken out of the structures as one batch and their
+	 * slots returned to the bullet pool.
 	*/
 	void CleanupBullets();
 
@@ -73,6 +82,15 @@ private:
 	*/
 	void HandleInput();
 
+	/* void UpdateWrapGhosts
+	 * Brief:
+	 *	Takes last frame's wrap ghosts out of the uniform grid and quadtree and
+	 *	makes new ones for the player and asteroids over a screen edge. The ghosts
+	 *	are only added to the structure the active broad phase reads, brute force
+	 *	reads them straight from the list.
+	 */
+	void UpdateWrapGhosts();
+
 	/* void DrawGrid
 	 * Brief:
 	 * Checks if the user wishes to draw the spatial grid to the screen.
@@ -87,6 +105,47 @@ private:
 	 */
 	void UpdateGrid();
 
+	/* void AddToBroadPhase
+	 * Brief:
+	 *	Adds a sprite to the structure the running broad phase reads. The other
+	 *	structures are left empty so they cost nothing while they're idle.
+	 * Params:
+	 *	<WireframeSprite*> sprite	-	sprite to add
+	 */
+	void AddToBroadPhase(WireframeSprite* sprite);
+
+	/* void RemoveFromBroadPhase
+	 * Brief:
+	 *	Removes a sprite from the structure the running broad phase reads
+	 * Params:
+	 *	<WireframeSprite*> sprite	-	sprite to remove
+	 */
+	void RemoveFromBroadPhase(WireframeSprite* sprite);
+
+	/* void RemoveFromBroadPhase
+	 * Brief:
+	 *	Removes a batch of sprites from the structure the running broad phase
+	 *	reads. The list based structures drop the whole batch in one pass.
+	 * Params:
+	 *	<const vector<WireframeSprite*>&> sprites	-	sprites to remove, sorted by address
+	 */
+	void RemoveFromBroadPhase(const std::vector<WireframeSprite*>& sprites);
+
+	/* void SwitchBroadPhase
+	 * Brief:
+	 *	Called whenever the broad phase may have changed, from the console or by
+	 *	the auto broad phase. If it has, every sprite is taken out of the old
+	 *	mode's structure and added to the new one's.
+	 */
+	void SwitchBroadPhase();
+
+	/* bool UsesIncrementalUniformGrid
+	 * Brief:
+	 *	Returns true if the active broad phase reads the uniform grid that's
+	 *	updated as sprites move between cells
+	 */
+	bool UsesIncrementalUniformGrid() const;
+
 	/* void UpdateSpriteGrid
 	 * Brief:
 	 *	Takes a sprite and calculates which grid in the uniform grid
@@ -98,23 +157,46 @@ private:
 	 */
 	void UpdateSpriteGrid(WireframeSprite*sprite );
 
+	/* void UpdateUniformGrid
+	 * Brief:
+	 *	Moves the player and every asteroid that has changed cell into its new
+	 *	cell. Done with the other structures' upkeep so the auto broad phase
+	 *	times it along with theirs.
+	 */
+	void UpdateUniformGrid();
+
 	/* void UpdateQuadTree
 	 * Brief:
-	 *	Updates the objects in the quadtree by first clearing it
-	 *  then reconstructing it. This seems to be a reasonably efficient
-	 *  solution to updating the positions of sprites within the system.
+	 *	Updates the objects in the quadtree in place. The tree is loose so
+	 *  sprites are only relocated once they leave the loose bounds of the
+	 *  node that owns them, the tree is never cleared and rebuilt.
 	 */
 	void UpdateQuadTree();
 
+	/* void UpdateAABBTree
+	 * Brief:
+	 *	Updates every proxy in the dynamic aabb tree. Sprites that are still
+	 *	inside their fat bounds don't change the tree, only the ones that have
+	 *	escaped are reinserted.
+	 */
+	void UpdateAABBTree();
+
+	/* void RebuildUniformGridCSR
+	 * Brief:
+	 *	Gathers every sprite into one list and rebuilds the csr copy of the
+	 *	uniform grid from it. The list is kept between frames so it doesn't allocate.
+	 *	Bullets are left out as they're swept through the grid, wrap ghosts are included.
+	 */
+	void RebuildUniformGridCSR();
+
 	/* void UpdateCollisionText
 	 * Brief:
 	 * Updates the collision text with the number of collision and 
 	 * collision tests.
 	 * Params:
-	 * <uint> nCollisiontests	-	number of collision tests performed
-	 * <uint> nCollisions		-	number of collisions detected
+	 * <CollisionPhaseData> data	-	results of this frame's collision pass
 	 */
-	void UpdateCollisionText(unsigned int nCollisionTests, unsigned int nCollisions);
+	void UpdateCollisionText(const CollisionPhaseData& data);
 
 	/* void HandleConsoleCommands
 	 * Brief:
@@ -142,13 +224,22 @@ private:
 	// Game Variables
 	Player* _player = nullptr;						// player triangle object
 	std::vector<Asteroid*> _asteroids;				// container for the asteroids
-	std::vector<Bullet*> _bullets;					// container for the bullet objects
+	BulletPool* _bulletPool = nullptr;				// owns every bullet, keeps the live ones packed
+	std::vector<WireframeSprite*> _gatheredSprites;	// every sprite gathered for structures rebuilt from scratch
+	WrapGhosts _wrapGhosts;							// copies of sprites over a screen edge for the broad phase
+	EntityStore _asteroidStore;						// motion of every asteroid as a structure of arrays
 	size_t NUMBER_ASTEROIDS = 10;					// Number of asteroids on the screen
 
 	sf::Clock _lastInputClock;						// Timer to limit spam of bullet firing			
 	UniformGrid* _uniformGrid = nullptr;			// Grid for uniform spatial partitioning
 	QuadTree* _quadTree = nullptr;
+	SweepAndPrune* _sweepAndPrune = nullptr;		// Sorted endpoint list for sweep and prune
+	DynamicAABBTree* _aabbTree = nullptr;			// Bounding volume tree with fat bounds
+	LinearQuadTree* _linearQuadTree = nullptr;		// Morton ordered quadtree rebuilt every frame
+	SpatialHashGrid* _spatialHashGrid = nullptr;	// Sparse grid hashed on cell coordinates
+	HierarchicalGrid* _hierarchicalGrid = nullptr;	// Grid with a level for each sprite size
 	CollisionHandler* _collisionHandler = nullptr;	// Handles all application collision logic
+	BroadCollisionMode _maintainedBroadPhase = BroadCollisionMode::BRUTE_FORCE;	// Broad phase whose structure holds the sprites
 	Console* _console = nullptr;					// The internal console to the app
 
 	bool _drawGrid = false;							// Should the spatial grid be drawn to the screen
@@ -163,7 +254,11 @@ private:
 
 	// Constants
 	static constexpr float SHOOT_INTERVAL = 0.2f;	// interval in seconds between each bullet firing
+	static constexpr unsigned int BULLET_POOL_CAPACITY = 4096;	// Most bullets alive at once, shots are dropped past this
 	static constexpr int QUADTREE_CELL_LIMIT = 5;	// How many sprites can exist in a quad tree cell
 													// Before it subdivides
+	static constexpr float QUADTREE_LOOSENESS = 2.0f;	// Scale of each quad tree node's loose bounds
+	static constexpr float SPATIAL_HASH_CELL_SIZE = 110.0f;	// Size in world pixels of each spatial hash cell
+	static constexpr float HIERARCHICAL_GRID_MIN_CELL_SIZE = 16.0f;	// Size in world pixels of the finest hierarchical grid cells
 };
 
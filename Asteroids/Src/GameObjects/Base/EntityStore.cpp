@@ -0,0 +1,193 @@
+#include "EntityStore.h"
+#include "WireframeSprite.h"
+#include "../../Global/ApplicationDefines.h"
+
+// pick the widest instruction set the compiler is targeting
+#if defined(__AVX2__)
+#define ENTITY_STORE_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENTITY_STORE_SSE
+#include <emmintrin.h>
+#endif
+
+EntityStore::EntityStore(){}
+
+// Unlinks any sprites still in the store
+EntityStore::~EntityStore()
+{
+	for (unsigned int i = 0; i < this->_views.size(); i++)
+		this->_views[i]->SetStore(nullptr, -1);
+}
+
+/* void Add
+* Brief:
+*	Copies the sprite's position, velocity and rotation into the store and
+*	links the sprite to its entry
+* Params:
+*	<WireframeSprite*>	sprite	-	the sprite to add
+*	<float>				spin	-	degrees the sprite rotates by each frame
+*/
+void EntityStore::Add(WireframeSprite* sprite, float spin)
+{
+	unsigned int index = this->_count++;
+
+	// grow a whole block at a time, new lanes are zero
+	if (this->_count > this->_positionX.size())
+	{
+		size_t size = this->_positionX.size() + BLOCK_SIZE;
+		this->_positionX.resize(size, 0.0f);
+		this->_positionY.resize(size, 0.0f);
+		this->_velocityX.resize(size, 0.0f);
+		this->_velocityY.resize(size, 0.0f);
+		this->_rotation.resize(size, 0.0f);
+		this->_spin.resize(size, 0.0f);
+	}
+
+	this->_positionX[index] = sprite->GetPosition().x;
+	this->_positionY[index] = sprite->GetPosition().y;
+	this->_velocityX[index] = sprite->GetVelocity().x;
+	this->_velocityY[index] = sprite->GetVelocity().y;
+	this->_rotation[index] = sprite->GetRotation();
+	this->_spin[index] = spin;
+
+	this->_views.push_back(sprite);
+	sprite->SetStore(this, static_cast<int>(index));
+}
+
+/* void Remove
+* Brief:
+*	Removes the sprite's entry by moving the last entry into its place.
+*	Called by the sprite's destructor, so deleting a sprite is enough.
+* Params:
+*	<WireframeSprite*>	sprite	-	the sprite to remove
+*/
+void EntityStore::Remove(WireframeSprite* sprite)
+{
+	if (sprite->GetStore() != this)
+		return;
+
+	unsigned int index = static_cast<unsigned int>(sprite->GetStoreIndex());
+	unsigned int last = --this->_count;
+
+	// move the last entry into the gap and tell its view where it went
+	this->_positionX[index] = this->_positionX[last];
+	this->_positionY[index] = this->_positionY[last];
+	this->_velocityX[index] = this->_velocityX[last];
+	this->_velocityY[index] = this->_velocityY[last];
+	this->_rotation[index] = this->_rotation[last];
+	this->_spin[index] = this->_spin[last];
+	this->_views[index] = this->_views[last];
+	this->_views[index]->SetStore(this, static_cast<int>(index));
+
+	// the freed lane goes back to being padding
+	this->_positionX[last] = 0.0f;
+	this->_positionY[last] = 0.0f;
+	this->_velocityX[last] = 0.0f;
+	this->_velocityY[last] = 0.0f;
+	this->_rotation[last] = 0.0f;
+	this->_spin[last] = 0.0f;
+	this->_views.pop_back();
+
+	sprite->SetStore(nullptr, -1);
+}
+
+/* void Integrate
+* Brief:
+*	Adds the velocity to the position and the spin to the rotation of every
+*	entity, then wraps positions to the window and rotations to a full turn.
+*	AVX2 is used when the compiler targets it, then SSE, then a scalar fallback.
+*/
+void EntityStore::Integrate()
+{
+	float* positionX = this->_positionX.data();
+	float* positionY = this->_positionY.data();
+	float* rotation = this->_rotation.data();
+	const float* velocityX = this->_velocityX.data();
+	const float* velocityY = this->_velocityY.data();
+	const float* spin = this->_spin.data();
+
+	// the arrays are padded so every block is whole, the padding stays at zero
+	unsigned int size = static_cast<unsigned int>(this->_positionX.size());
+
+#if defined(ENTITY_STORE_AVX2)
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 width = _mm256_set1_ps(static_cast<float>(WINDOW_WIDTH));
+	const __m256 height = _mm256_set1_ps(static_cast<float>(WINDOW_HEIGHT));
+	const __m256 fullTurn = _mm256_set1_ps(360.0f);
+
+	for (unsigned int i = 0; i < size; i += 8)
+	{
+		__m256 x = _mm256_add_ps(_mm256_loadu_ps(positionX + i), _mm256_loadu_ps(velocityX + i));
+		__m256 y = _mm256_add_ps(_mm256_loadu_ps(positionY + i), _mm256_loadu_ps(velocityY + i));
+		__m256 r = _mm256_add_ps(_mm256_loadu_ps(rotation + i), _mm256_loadu_ps(spin + i));
+
+		// a lane past an edge moves a whole window (or turn) back, masks pick the lanes
+		x = _mm256_add_ps(x, _mm256_and_ps(_mm256_cmp_ps(x, zero, _CMP_LT_OQ), width));
+		x = _mm256_sub_ps(x, _mm256_and_ps(_mm256_cmp_ps(x, width, _CMP_GE_OQ), width));
+		y = _mm256_add_ps(y, _mm256_and_ps(_mm256_cmp_ps(y, zero, _CMP_LT_OQ), height));
+		y = _mm256_sub_ps(y, _mm256_and_ps(_mm256_cmp_ps(y, height, _CMP_GE_OQ), height));
+		r = _mm256_add_ps(r, _mm256_and_ps(_mm256_cmp_ps(r, zero, _CMP_LT_OQ), fullTurn));
+		r = _mm256_sub_ps(r, _mm256_and_ps(_mm256_cmp_ps(r, fullTurn, _CMP_GE_OQ), fullTurn));
+
+		_mm256_storeu_ps(positionX + i, x);
+		_mm256_storeu_ps(positionY + i, y);
+		_mm256_storeu_ps(rotation + i, r);
+	}
+#elif defined(ENTITY_STORE_SSE)
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 width = _mm_set1_ps(static_cast<float>(WINDOW_WIDTH));
+	const __m128 height = _mm_set1_ps(static_cast<float>(WINDOW_HEIGHT));
+	const __m128 fullTurn = _mm_set1_ps(360.0f);
+
+	for (unsigned int i = 0; i < size; i += 4)
+	{
+		__m128 x = _mm_add_ps(_mm_loadu_ps(positionX + i), _mm_loadu_ps(velocityX + i));
+		__m128 y = _mm_add_ps(_mm_loadu_ps(positionY + i), _mm_loadu_ps(velocityY + i));
+		__m128 r = _mm_add_ps(_mm_loadu_ps(rotation + i), _mm_loadu_ps(spin + i));
+
+		// a lane past an edge moves a whole window (or turn) back, masks pick the lanes
+		x = _mm_add_ps(x, _mm_and_ps(_mm_cmplt_ps(x, zero), width));
+		x = _mm_sub_ps(x, _mm_and_ps(_mm_cmpge_ps(x, width), width));
+		y = _mm_add_ps(y, _mm_and_ps(_mm_cmplt_ps(y, zero), height));
+		y = _mm_sub_ps(y, _mm_and_ps(_mm_cmpge_ps(y, height), height));
+		r = _mm_add_ps(r, _mm_and_ps(_mm_cmplt_ps(r, zero), fullTurn));
+		r = _mm_sub_ps(r, _mm_and_ps(_mm_cmpge_ps(r, fullTurn), fullTurn));
+
+		_mm_storeu_ps(positionX + i, x);
+		_mm_storeu_ps(positionY + i, y);
+		_mm_storeu_ps(rotation + i, r);
+	}
+#else
+	// scalar fallback, same steps one entity at a time
+	for (unsigned int i = 0; i < size; i++)
+	{
+		float x = positionX[i] + velocityX[i];
+		float y = positionY[i] + velocityY[i];
+		float r = rotation[i] + spin[i];
+
+		if (x < 0.0f) x += WINDOW_WIDTH;
+		if (x >= WINDOW_WIDTH) x -= WINDOW_WIDTH;
+		if (y < 0.0f) y += WINDOW_HEIGHT;
+		if (y >= WINDOW_HEIGHT) y -= WINDOW_HEIGHT;
+		if (r < 0.0f) r += 360.0f;
+		if (r >= 360.0f) r -= 360.0f;
+
+		positionX[i] = x;
+		positionY[i] = y;
+		rotation[i] = r;
+	}
+#endif
+}
+
+// Returns the name of the instruction set the kernel was compiled with
+const char* EntityStore::GetInstructionSetName()
+{
+#if defined(ENTITY_STORE_AVX2)
+	return "AVX2";
+#elif defined(ENTITY_STORE_SSE)
+	return "SSE";
+#else
+	return "Scalar";
+#endif
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <vector>
+#include "SFML/Graphics.hpp"
+
+// class pre-definitions to save header space
+class WireframeSprite;
+
+/* class EntityStore
+ *	Structure of arrays holding the motion of a group of sprites: position,
+ *	velocity, rotation and spin each live in their own tightly packed array.
+ *	Integrate moves, spins and wraps every entity in one vectorised pass over
+ *	the arrays instead of one virtual update per heap allocated sprite. The
+ *	sprites stay as views used for drawing and collision, and read their
+ *	transform back out of the store when they're updated.
+ *	Entities are removed with a swap delete, the view of the entity moved into
+ *	the gap is told its new index. The arrays are padded to a whole SIMD block
+ *	so the kernel never needs a scalar tail, the padding lanes are all zero.
+*/
+class EntityStore
+{
+	// Public interface
+public:
+	EntityStore();
+
+	// Unlinks any sprites still in the store
+	~EntityStore();
+
+	/* void Add
+	* Brief:
+	*	Copies the sprite's position, velocity and rotation into the store and
+	*	links the sprite to its entry
+	* Params:
+	*	<WireframeSprite*>	sprite	-	the sprite to add
+	*	<float>				spin	-	degrees the sprite rotates by each frame
+	*/
+	void Add(WireframeSprite* sprite, float spin);
+
+	/* void Remove
+	* Brief:
+	*	Removes the sprite's entry by moving the last entry into its place.
+	*	Called by the sprite's destructor, so deleting a sprite is enough.
+	* Params:
+	*	<WireframeSprite*>	sprite	-	the sprite to remove
+	*/
+	void Remove(WireframeSprite* sprite);
+
+	/* void Integrate
+	* Brief:
+	*	Adds the velocity to the position and the spin to the rotation of every
+	*	entity, then wraps positions to the window and rotations to a full turn.
+	*	AVX2 is used when the compiler targets it, then SSE, then a scalar fallback.
+	*/
+	void Integrate();
+
+	// Getters for an entity's state
+	sf::Vector2f GetPosition(unsigned int index) const { return sf::Vector2f(this->_positionX[index], this->_positionY[index]); }
+	sf::Vector2f GetVelocity(unsigned int index) const { return sf::Vector2f(this->_velocityX[index], this->_velocityY[index]); }
+	float GetRotation(unsigned int index) const { return this->_rotation[index]; }
+	unsigned int GetCount() const { return this->_count; }
+
+	// Returns the name of the instruction set the kernel was compiled with
+	static const char* GetInstructionSetName();
+
+	// Members
+private:
+	unsigned int _count = 0;					// entities in the store, the arrays are padded past this
+
+	std::vector<float> _positionX;				// x of each entity's position
+	std::vector<float> _positionY;				// y of each entity's position
+	std::vector<float> _velocityX;				// x of each entity's velocity per frame
+	std::vector<float> _velocityY;				// y of each entity's velocity per frame
+	std::vector<float> _rotation;				// rotation of each entity in degrees, kept in [0, 360)
+	std::vector<float> _spin;					// degrees each entity rotates by per frame
+	std::vector<WireframeSprite*> _views;		// sprite reading each entity, not padded
+
+	// constants
+	static constexpr unsigned int BLOCK_SIZE = 8;	// arrays are padded to a multiple of the widest SIMD block
+};
@@ -1,8 +1,12 @@
 #define _USE_MATH_DEFINES
 #include "WireframeSprite.h"
+#include "EntityStore.h"
 #include "../../Global/ApplicationDefines.h"
 #include <math.h>
 
+// ids start at 1 and are never reused so stale references can't match a new sprite
+unsigned int WireframeSprite::_nextId = 1;
+
 /* Constructor
  * Brief:
  *	assigns the properties to the base convex shape.
@@ -10,9 +14,15 @@
  *	that the hitbox isn't updated or drawn unless it's flagged as
  *	active.
  * Params:
- *	<size_t> pointCount	-	Number of points the convex shape could contain
+ *	<size_t>			pointCount		-	Number of points the convex shape could contain
+ *	<CollisionCategory>	category		-	type tag of the sprite
+ *	<unsigned int>		collisionMask	-	bits of the categories the sprite can collide with
  */
-WireframeSprite::WireframeSprite(size_t pointCount)
+WireframeSprite::WireframeSprite(size_t pointCount, CollisionCategory category, unsigned int collisionMask)
+	:
+	_id(_nextId++),
+	_category(category),
+	_collisionMask(collisionMask)
 {
 	this->_shape.setPointCount(pointCount);
 
@@ -23,7 +33,12 @@ WireframeSprite::WireframeSprite(size_t pointCount)
 	this->hitboxShape.setOutlineColor(sf::Color::Green);
 }
 
-WireframeSprite::~WireframeSprite(){}
+// Removes the sprite from the entity store it's in, if any
+WireframeSprite::~WireframeSprite()
+{
+	if (this->_store)
+		this->_store->Remove(this);
+}
 
 /* virtual void Update
  * Brief:
@@ -38,44 +53,117 @@ void WireframeSprite::Update()
 {
 	// Update position of the convex shape
 	this->_position += this->_velocity;
-	this->_shape.setPosition(this->_position);
+	this->UpdateShape();
+}
 
+/* void UpdateShape
+ * Brief:
+ *	moves the shape and hitbox to the position member and marks the next
+ *	frame points as out of date. Used by Update once the position has moved
+ *	and by SyncFromStore.
+ */
+void WireframeSprite::UpdateShape()
+{
+	this->_shape.setPosition(this->_position);
 
 	//Update position for the hit-box display
 	if (this->isHitboxVisible)
 	{
-		sf::FloatRect rect = this->_shape.getGlobalBounds();
+		sf::FloatRect rect = this->GetBoundingRectangle();
 		this->hitboxShape.setPosition(this->_shape.getPosition().x - rect.width / 2, this->_shape.getPosition().y - rect.height / 2);
 		this->hitboxShape.setSize({ rect.width, rect.height });
 	}
+
+	// the points are only worked out if something reads them
+	this->_pointsDirty = true;
+}
+
+/* void BuildPoints
+ * Brief:
+ *	transforms the shape's points into world space for the next frame and
+ *	packs them. Only called when the points are read after the sprite has
+ *	moved, so sprites that never reach the narrow phase skip the work.
+ */
+void WireframeSprite::BuildPoints() const
+{
 	// Update internal points
 	float s = std::sin(((this->_shape.getRotation() * (float)M_PI) / 180.0f));
 	float c = std::cos(((this->_shape.getRotation() * (float)M_PI) / 180.0f));
-	for (unsigned int i = 0; i < this->_shape.getPointCount(); i++)
+	sf::Vector2f offset = this->_position + this->_velocity;
+
+	this->_pointsNextFrame.resize(this->_sharedShape ? this->_sharedShape->points.size() : this->_shape.getPointCount());
+	for (unsigned int i = 0; i < this->_pointsNextFrame.size(); i++)
 	{
-		_pointsNextFrame[i].x = (this->_shape.getPoint(i).x * c - this->_shape.getPoint(i).y * s) + this->_position.x + this->_velocity.x;
-		_pointsNextFrame[i].y = (this->_shape.getPoint(i).x * s + this->_shape.getPoint(i).y * c) + this->_position.y + this->_velocity.y;
+		sf::Vector2f point = this->_sharedShape ? this->_sharedShape->points[i] : this->_shape.getPoint(i);
+		this->_pointsNextFrame[i].x = (point.x * c - point.y * s) + offset.x;
+		this->_pointsNextFrame[i].y = (point.x * s + point.y * c) + offset.y;
 	}
+
+	// Keep the rotation the points were built with for the narrow phase
+	this->_rotationSin = s;
+	this->_rotationCos = c;
+
+	// Keep the SIMD copy of the points in step
+	this->PackPoints();
+	this->_pointsDirty = false;
 }
 
+/* void SyncFromStore
+ * Brief:
+ *	copies the position, velocity and rotation integrated by the entity
+ *	store back into the sprite then updates the shape. The store wraps the
+ *	position so the sprite is treated as wrapping around the screen.
+ */
+void WireframeSprite::SyncFromStore()
+{
+	unsigned int index = static_cast<unsigned int>(this->_storeIndex);
+	this->_position = this->_store->GetPosition(index);
+	this->_velocity = this->_store->GetVelocity(index);
+	this->_shape.setRotation(this->_store->GetRotation(index));
+	this->_wrapsAround = true;
+
+	this->UpdateShape();
+}
 
 /* virtual void Draw
  * Brief:
- * Draws the convex shape to the given window. Also draws the surrounding
- * hitbox shape if it's enabled
+ * Draws the sprite to the given window through DrawShape, once where it is and
+ * once for each edge it's over. Also draws the surrounding hitbox shape if it's enabled
  * Params:
  * <renderwindow*> window	-	window to draw the shapes to
  */
 void WireframeSprite::Draw(sf::RenderWindow* window)
 {
 	// Draw sprites
-	window->draw(this->_shape);
+	this->DrawShape(window, sf::Transform::Identity);
+
+	// Draw the copies on the other side of any edge the sprite is over
+	if (this->_wrapsAround)
+	{
+		sf::Vector2f offsets[3];
+		unsigned int nOffsets = GetWrapOffsets(this->GetBoundingRectangle(), offsets);
+		for (unsigned int i = 0; i < nOffsets; i++)
+			this->DrawShape(window, sf::Transform().translate(offsets[i]));
+	}
 
 	if (this->isHitboxVisible)// only draw hit-box if intended
 		window->draw(this->hitboxShape);
 
 }
 
+/* virtual void DrawShape
+ * Brief:
+ *	draws the convex shape moved by the given offset. Sprites with a shared
+ *	shape override this to draw the shared outline with their own transform.
+ * Params:
+ *	<renderwindow*>				window	-	window to draw the shape to
+ *	<const sf::Transform&>		offset	-	transform applied on top of the sprite's own
+ */
+void WireframeSprite::DrawShape(sf::RenderWindow* window, const sf::Transform& offset)
+{
+	window->draw(this->_shape, offset);
+}
+
 /* void RotateMesh
  * Brief:
  *	rotates the object's sprite by the passed value in degrees
@@ -89,21 +177,170 @@ void WireframeSprite::RotateMesh(float RotationDegrees)
 
 /* void WrapCoordinates
  * Brief:
- *	if called wraps the object to the screen.
+ *	if called wraps the object to the screen. The screen is a torus, once the
+ *	centre crosses an edge the object moves a whole window to the other side.
+ *	While it straddles an edge it's drawn on both sides.
  */
 void WireframeSprite::WrapCoordinates()
 {
-	sf::FloatRect rect = this->_shape.getGlobalBounds();
+	this->_wrapsAround = true;
+
+	sf::Vector2f wrap(0.0f, 0.0f);
+
+	if (this->_position.x < 0.0f)
+		wrap.x = WINDOW_WIDTH;
+
+	else if (this->_position.x >= WINDOW_WIDTH)
+		wrap.x = -WINDOW_WIDTH;
+
+	if (this->_position.y < 0.0f)
+		wrap.y = WINDOW_HEIGHT;
+
+	else if (this->_position.y >= WINDOW_HEIGHT)
+		wrap.y = -WINDOW_HEIGHT;
+
+	if (wrap.x == 0.0f && wrap.y == 0.0f)
+		return;
+
+	// move the shape along with the position so the structures, which bin
+	// by position, see the sprite where it's drawn. The points follow when rebuilt
+	this->_position += wrap;
+	this->_shape.setPosition(this->_position);
+	this->hitboxShape.move(wrap);
+	this->_pointsDirty = true;
+}
+
+/* void CopyAsGhost
+ * Brief:
+ *	Turns this sprite into a ghost of another, a copy of the owner's shape and
+ *	collision points shifted by a whole window so a sprite straddling an edge
+ *	can be found by the broad phase on the other side of the screen. The ghost
+ *	keeps its own id and structure links, collisions with it are passed to the owner.
+ * Params:
+ *	<const WireframeSprite&>	owner	-	sprite to copy
+ *	<const sf::Vector2f&>		offset	-	amount to shift the copy by
+ */
+void WireframeSprite::CopyAsGhost(const WireframeSprite& owner, const sf::Vector2f& offset)
+{
+	this->_ghostOwner = const_cast<WireframeSprite*>(&owner);
+	this->_category = owner._category;
+	this->_collisionMask = owner._collisionMask;
+
+	this->_shape = owner._shape;
+	this->_shape.setPosition(owner._shape.getPosition() + offset);
+	this->_position = owner._position + offset;
+	this->_velocity = owner._velocity;
+
+	// assigning reuses the vector's memory from the last time the ghost was used
+	this->_localNormals = owner._localNormals;
+	this->_sharedShape = owner._sharedShape;
+
+	// the ghost's points are built from its own position if it's ever tested
+	this->_pointsDirty = true;
+}
+
+/* static unsigned int GetWrapOffsets
+ * Brief:
+ *	Works out where the copies of a sprite with the given bounds appear on a
+ *	wrapping screen. A sprite over one edge has one copy, over a corner three.
+ * Params:
+ *	<const sf::FloatRect&>	bounds	-	bounds of the sprite
+ *	<sf::Vector2f*>			offsets	-	filled with the offset of each copy, room for 3
+ * Returns:
+ *	<unsigned int>	-	number of copies
+ */
+unsigned int WireframeSprite::GetWrapOffsets(const sf::FloatRect& bounds, sf::Vector2f* offsets)
+{
+	float x = 0.0f;
+	float y = 0.0f;
+
+	if (bounds.left < 0.0f)
+		x = WINDOW_WIDTH;
+	else if (bounds.left + bounds.width > WINDOW_WIDTH)
+		x = -WINDOW_WIDTH;
+
+	if (bounds.top < 0.0f)
+		y = WINDOW_HEIGHT;
+	else if (bounds.top + bounds.height > WINDOW_HEIGHT)
+		y = -WINDOW_HEIGHT;
+
+	unsigned int nOffsets = 0;
+	if (x != 0.0f)
+		offsets[nOffsets++] = sf::Vector2f(x, 0.0f);
+	if (y != 0.0f)
+		offsets[nOffsets++] = sf::Vector2f(0.0f, y);
+	if (x != 0.0f && y != 0.0f)
+		offsets[nOffsets++] = sf::Vector2f(x, y);
+
+	return nOffsets;
+}
+
+/* void PackPoints
+ * Brief:
+ *	copies the next frame points into the structure of arrays used by the
+ *	SIMD narrow phase. The arrays are padded to PACKED_CAPACITY by repeating the
+ *	first point, which closes the last edge and leaves the padding as zero
+ *	length edges. Must be called whenever _pointsNextFrame changes.
+ */
+void WireframeSprite::PackPoints() const
+{
+	if (this->_pointsNextFrame.size() > MAX_PACKED_POINTS)
+		throw std::exception("sprite has too many points to pack!");
 
-	if (rect.left + rect.width < 0.0f)
-		this->_position += sf::Vector2f(rect.width + WINDOW_WIDTH, 0.0f);
+	this->_nPackedPoints = static_cast<unsigned int>(this->_pointsNextFrame.size());
 
-	else if (rect.left >= WINDOW_WIDTH)
-		this->_position += sf::Vector2f(-WINDOW_WIDTH - rect.width, 0.0f);
+	for (unsigned int i = 0; i < this->_nPackedPoints; i++)
+	{
+		this->_packedPointsX[i] = this->_pointsNextFrame[i].x;
+		this->_packedPointsY[i] = this->_pointsNextFrame[i].y;
+	}
 
-	else if (rect.top + rect.height < 0.0f)
-		this->_position += sf::Vector2f(0.0f, WINDOW_HEIGHT + rect.height);
+	// pad with the first point
+	sf::Vector2f first = this->_nPackedPoints > 0 ? this->_pointsNextFrame[0] : sf::Vector2f();
+	for (unsigned int i = this->_nPackedPoints; i < PACKED_CAPACITY; i++)
+	{
+		this->_packedPointsX[i] = first.x;
+		this->_packedPointsY[i] = first.y;
+	}
+}
+
+/* void ShareShape
+ * Brief:
+ *	uses an outline shared between many sprites. The points, normals and bounds
+ *	are read from the shared shape rather than copied, the convex shape is left
+ *	with no points and only keeps the sprite's position and rotation, so the
+ *	sprite must override DrawShape. The shared shape must outlive the sprite.
+ * Params:
+ *	<const SharedShape&> shape	-	outline to use
+ */
+void WireframeSprite::ShareShape(const SharedShape& shape)
+{
+	this->_sharedShape = &shape;
 
-	else if (rect.top >= WINDOW_HEIGHT)
-		this->_position += sf::Vector2f(0.0f, -WINDOW_HEIGHT - rect.height);
+	// drop the points so the shape doesn't build its own geometry
+	this->_shape.setPointCount(0);
+
+	this->_pointsDirty = true;
+}
+
+/* void CacheLocalNormals
+ * Brief:
+ *	works out the unit normal of every edge of the shape in local space.
+ *	The shape is rigid so this only needs calling once the points are set,
+ *	the narrow phase rotates them into world space.
+ */
+void WireframeSprite::CacheLocalNormals()
+{
+	size_t pointCount = this->_shape.getPointCount();
+	this->_localNormals.resize(pointCount);
+
+	for (unsigned int a = 0; a < pointCount; a++)
+	{
+		unsigned int b = (a + 1) % pointCount;
+		sf::Vector2f edge = this->_shape.getPoint(b) - this->_shape.getPoint(a);
+
+		// same winding as the SAT test, (-dy, dx)
+		float length = std::sqrt(edge.x * edge.x + edge.y * edge.y);
+		this->_localNormals[a] = { -edge.y / length, edge.x / length };
+	}
 }
@@ -4,7 +4,52 @@
 // Pre-definitions of classes to keep the header file small
 struct Cell;
 class Game;
-class QuadTree;
+class EntityStore;
+
+/* enum CollisionCategory
+ * Brief:
+ *	compact type tag of a sprite, used to index the collision response table
+ *	and as the bit position in collision masks
+ */
+enum class CollisionCategory : unsigned char
+{
+	PLAYER,
+	ASTEROID,
+	BULLET,
+	COUNT
+};
+
+// Returns the mask bit of a collision category
+inline unsigned int CollisionCategoryBit(CollisionCategory category) { return 1u << static_cast<unsigned int>(category); }
+
+/* struct PointSpan
+ * Brief:
+ *	non-owning view of a sprite's points. Only valid until the sprite
+ *	next moves, so it shouldn't be kept between frames.
+ */
+struct PointSpan
+{
+	const sf::Vector2f* data;
+	unsigned int count;
+
+	unsigned int size() const { return this->count; }
+	const sf::Vector2f& operator[](unsigned int i) const { return this->data[i]; }
+	const sf::Vector2f* begin() const { return this->data; }
+	const sf::Vector2f* end() const { return this->data + this->count; }
+};
+
+/* struct SharedShape
+ * Brief:
+ *	immutable outline in local space shared by many sprites, along with what
+ *	would otherwise be worked out from each sprite's own points
+ */
+struct SharedShape
+{
+	std::vector<sf::Vector2f> points;		// outline points around the origin
+	std::vector<sf::Vector2f> normals;		// unit normal of the edge starting at each point
+	float boundingRadius = 0.0f;			// distance from the origin to the furthest point
+	sf::FloatRect localBounds;				// bounds of the points before any transform
+};
 
 
 /* Class WireframeSprite
@@ -17,6 +62,10 @@ class QuadTree;
 class WireframeSprite
 {
 public:
+	// Size of the packed point arrays, the widest SIMD block starting at the last edge must fit
+	static constexpr unsigned int PACKED_CAPACITY = 24;
+	static constexpr unsigned int MAX_PACKED_POINTS = 16;
+
 	// Needed for collision calculation
 	friend class CollisionHandler;
 
@@ -27,10 +76,14 @@ public:
 	 *	that the hitbox isn't updated or drawn unless it's flagged as
 	 *	active.
 	 * Params:
-	 *	<size_t> pointCount	-	Number of points the convex shape could contain
+	 *	<size_t>			pointCount		-	Number of points the convex shape could contain
+	 *	<CollisionCategory>	category		-	type tag of the sprite
+	 *	<unsigned int>		collisionMask	-	bits of the categories the sprite can collide with
 	 */
-	WireframeSprite(size_t pointCount);
-	~WireframeSprite();
+	WireframeSprite(size_t pointCount, CollisionCategory category, unsigned int collisionMask);
+
+	// Removes the sprite from the entity store it's in, if any
+	virtual ~WireframeSprite();
 
 	/* virtual void Update
 	 * Brief:
@@ -45,29 +98,85 @@ public:
 
 	/* virtual void Draw
 	 * Brief:
-	 * Draws the convex shape to the given window. Also draws the surrounding
-	 * hitbox shape if it's enabled
+	 * Draws the sprite to the given window through DrawShape, once where it is and
+	 * once for each edge it's over. Also draws the surrounding hitbox shape if it's enabled
 	 * Params:
 	 * <renderwindow*> window	-	window to draw the shapes to
 	 */
 	virtual void Draw(sf::RenderWindow* window);
 
+	/* void CopyAsGhost
+	 * Brief:
+	 *	Turns this sprite into a ghost of another, a copy of the owner's shape and
+	 *	collision points shifted by a whole window so a sprite straddling an edge
+	 *	can be found by the broad phase on the other side of the screen. The ghost
+	 *	keeps its own id and structure links, collisions with it are passed to the owner.
+	 * Params:
+	 *	<const WireframeSprite&>	owner	-	sprite to copy
+	 *	<const sf::Vector2f&>		offset	-	amount to shift the copy by
+	 */
+	void CopyAsGhost(const WireframeSprite& owner, const sf::Vector2f& offset);
+
+	/* static unsigned int GetWrapOffsets
+	 * Brief:
+	 *	Works out where the copies of a sprite with the given bounds appear on a
+	 *	wrapping screen. A sprite over one edge has one copy, over a corner three.
+	 * Params:
+	 *	<const sf::FloatRect&>	bounds	-	bounds of the sprite
+	 *	<sf::Vector2f*>			offsets	-	filled with the offset of each copy, room for 3
+	 * Returns:
+	 *	<unsigned int>	-	number of copies
+	 */
+	static unsigned int GetWrapOffsets(const sf::FloatRect& bounds, sf::Vector2f* offsets);
+
 // Getters
 
-	std::vector<sf::Vector2f> GetPoints() const { return this->_pointsNextFrame;  }			// gets the calculated next frame points
+	PointSpan GetPoints() const { this->EnsurePoints(); return { this->_pointsNextFrame.data(), static_cast<unsigned int>(this->_pointsNextFrame.size()) }; }	// gets the calculated next frame points (view, no copy)
 	sf::Vector2f GetPosition() const { return this->_position; }							// Getter for current position
 	sf::Vector2f GetVelocity() const { return this->_velocity; }							// Getter for the current velocity
 	float GetRotation() const { return this->_shape.getRotation(); }						// Getter for the current sprite rotation
 	Cell* GetOwnerCell() const { return this->_ownerCell; }									// Getter for the owner cell (uniformGrid)
 	int GetOwnerCellIndex() const {return this->_ownerCellIndex;}							// Getter for the index in the cell array(uniformGrid)
 																							// This is to eliminate the need to search the array
-	QuadTree* GetOwnerTree() const { return this->_ownerTree; }								// Getter for the owner quad tree
-	sf::FloatRect GetBoundingRectangle() const { return this->_shape.getGlobalBounds(); }	// Getter for the global bounds of the sprite shape
+	int GetOwnerTreeItem() const { return this->_ownerTreeItem; }							// Getter for the item holding this object in the quad tree
+	int GetTreeProxy() const { return this->_treeProxyId; }									// Getter for the leaf node id in the dynamic aabb tree
+	unsigned int GetQueryStamp() const { return this->_queryStamp; }						// Getter for the last uniform grid segment query that tested this object
+	EntityStore* GetStore() const { return this->_store; }									// Getter for the entity store holding the sprite's motion
+	int GetStoreIndex() const { return this->_storeIndex; }									// Getter for the index of the sprite's entry in the entity store
+	unsigned int GetId() const { return this->_id; }										// Getter for the unique id of the sprite
+	CollisionCategory GetCategory() const { return this->_category; }						// Getter for the type tag of the sprite
+	WireframeSprite* GetGhostOwner() const { return this->_ghostOwner; }					// Getter for the sprite this is a ghost of, null for real sprites
+	bool WrapsAround() const { return this->_wrapsAround; }									// Getter for if the sprite wraps around the screen
+	unsigned int GetCollisionMask() const { return this->_collisionMask; }					// Getter for the categories the sprite can collide with
+
+	// Returns true if both sprites' masks allow the pair to collide
+	bool CanCollideWith(const WireframeSprite& other) const
+	{
+		return (this->_collisionMask & CollisionCategoryBit(other._category)) && (other._collisionMask & CollisionCategoryBit(this->_category));
+	}
+	unsigned int GetPointCount() const { this->EnsurePoints(); return this->_nPackedPoints; }						// Getter for the number of points in the packed arrays
+	const float* GetPackedPointsX() const { this->EnsurePoints(); return this->_packedPointsX; }					// Getter for the x of the next frame points (structure of arrays)
+	const float* GetPackedPointsY() const { this->EnsurePoints(); return this->_packedPointsY; }					// Getter for the y of the next frame points (structure of arrays)
+	const std::vector<sf::Vector2f>& GetLocalNormals() const { return this->_sharedShape ? this->_sharedShape->normals : this->_localNormals; }	// Getter for the unit edge normals in local space
+	const SharedShape* GetSharedShape() const { return this->_sharedShape; }						// Getter for the shape shared with other sprites, null if the sprite has its own
+	float GetRotationSin() const { this->EnsurePoints(); return this->_rotationSin; }								// Getter for the sine of the rotation the points were built with
+	float GetRotationCos() const { this->EnsurePoints(); return this->_rotationCos; }								// Getter for the cosine of the rotation the points were built with
+	sf::FloatRect GetBoundingRectangle() const { return this->_sharedShape ? this->_shape.getTransform().transformRect(this->_sharedShape->localBounds) : this->_shape.getGlobalBounds(); }	// Getter for the global bounds of the sprite shape
 
 // Setters
-	void SetOwnerTree(QuadTree* tree) { this->_ownerTree = tree; }							// Setter to update the quad tree in which object is stored
+	void SetOwnerTreeItem(int item) { this->_ownerTreeItem = item; }						// Setter to update the item holding this object in the quad tree
 	void SetOwnerCell(Cell* cell) { this->_ownerCell = cell; }								// Setter to update the cell in which object is contained (UG)
 	void SetOwnerCellIndex(int index) { this->_ownerCellIndex = index; }					// Setter to update the index within the owner cell array
+	void SetTreeProxy(int proxyId) { this->_treeProxyId = proxyId; }						// Setter to update the leaf node id in the dynamic aabb tree
+	void SetQueryStamp(unsigned int stamp) { this->_queryStamp = stamp; }					// Setter to mark the object as tested by a uniform grid segment query
+	void SetStore(EntityStore* store, int index) { this->_store = store; this->_storeIndex = index; }	// Setter to update the entity store entry
+
+	// Builds the next frame points if the sprite has moved since they were last built
+	void EnsurePoints() const
+	{
+		if (this->_pointsDirty)
+			this->BuildPoints();
+	}
 
 // Protected methods
 protected:
@@ -79,21 +188,89 @@ protected:
 	 */
 	void RotateMesh(float RotationDegrees);
 
+	/* virtual void DrawShape
+	 * Brief:
+	 *	draws the convex shape moved by the given offset. Sprites with a shared
+	 *	shape override this to draw the shared outline with their own transform.
+	 * Params:
+	 *	<renderwindow*>				window	-	window to draw the shape to
+	 *	<const sf::Transform&>		offset	-	transform applied on top of the sprite's own
+	 */
+	virtual void DrawShape(sf::RenderWindow* window, const sf::Transform& offset);
+
+	/* void UpdateShape
+	 * Brief:
+	 *	moves the shape and hitbox to the position member and marks the next
+	 *	frame points as out of date. Used by Update once the position has moved
+	 *	and by SyncFromStore.
+	 */
+	void UpdateShape();
+
+	/* void BuildPoints
+	 * Brief:
+	 *	transforms the shape's points into world space for the next frame and
+	 *	packs them. Only called when the points are read after the sprite has
+	 *	moved, so sprites that never reach the narrow phase skip the work.
+	 */
+	void BuildPoints() const;
+
+	/* void SyncFromStore
+	 * Brief:
+	 *	copies the position, velocity and rotation integrated by the entity
+	 *	store back into the sprite then updates the shape. The store wraps the
+	 *	position so the sprite is treated as wrapping around the screen.
+	 */
+	void SyncFromStore();
+
+	// Gives the sprite a new unique id, used when a pooled sprite is reused
+	// so caches keyed on the old id can't match the new one
+	void RenewId() { this->_id = _nextId++; }
+
 	/* void WrapCoordinates
 	 * Brief:
-	 *	if called wraps the object to the screen.
+	 *	if called wraps the object to the screen. The screen is a torus, once the
+	 *	centre crosses an edge the object moves a whole window to the other side.
+	 *	While it straddles an edge it's drawn on both sides.
 	 */
 	void WrapCoordinates();
 
+	/* void PackPoints
+	 * Brief:
+	 *	copies the next frame points into the structure of arrays used by the
+	 *	SIMD narrow phase. The arrays are padded to PACKED_CAPACITY by repeating the
+	 *	first point, which closes the last edge and leaves the padding as zero
+	 *	length edges. Must be called whenever _pointsNextFrame changes.
+	 */
+	void PackPoints() const;
+
+	/* void CacheLocalNormals
+	 * Brief:
+	 *	works out the unit normal of every edge of the shape in local space.
+	 *	The shape is rigid so this only needs calling once the points are set,
+	 *	the narrow phase rotates them into world space.
+	 */
+	void CacheLocalNormals();
+
+	/* void ShareShape
+	 * Brief:
+	 *	uses an outline shared between many sprites. The points, normals and bounds
+	 *	are read from the shared shape rather than copied, the convex shape is left
+	 *	with no points and only keeps the sprite's position and rotation, so the
+	 *	sprite must override DrawShape. The shared shape must outlive the sprite.
+	 * Params:
+	 *	<const SharedShape&> shape	-	outline to use
+	 */
+	void ShareShape(const SharedShape& shape);
+
 // Protected members
 protected:
-	sf::ConvexShape _shape;								// Base shape of the object made from several points
+	sf::ConvexShape _shape;								// Base shape of the object made from several points, only the transform if shared
 	sf::RectangleShape hitboxShape;						// Hitbox shape that surrounds the object
 
 	sf::Vector2f _velocity;								// Velocity of the object
 	sf::Vector2f _position{ 0.0f, 0.0f };				// Current position of the object (shape position doesn't update
 														// Until after the update that frame)
-	std::vector<sf::Vector2f> _pointsNextFrame;			// Points of the convex shape next frame (used for predictive collision)
+	mutable std::vector<sf::Vector2f> _pointsNextFrame;	// Points of the convex shape next frame (used for predictive collision)
 
 // Private members
 private:
@@ -102,6 +279,27 @@ private:
 
 	int _ownerCellIndex = -1;							// Uniform grid owner cell index (array inside the cell)
 	Cell* _ownerCell = nullptr;							// Uniform grid cell that owns this object	
-	QuadTree* _ownerTree = nullptr;						// Quad tree that owns this object
+	int _ownerTreeItem = -1;							// Item linking this object into a quad tree node
+	int _treeProxyId = -1;								// Leaf node holding this object in the dynamic aabb tree
+	unsigned int _queryStamp = 0;						// Last uniform grid segment query that tested this object, 0 if none
+	EntityStore* _store = nullptr;						// Entity store integrating the object's motion, null if it moves itself
+	int _storeIndex = -1;								// Index of the object's entry in the entity store
+
+	unsigned int _id;									// Unique id of the sprite, never reused
+	CollisionCategory _category;						// Type tag of the sprite
+	unsigned int _collisionMask;						// Bits of the categories the sprite can collide with
+	static unsigned int _nextId;						// id given to the next sprite created
+	WireframeSprite* _ghostOwner = nullptr;				// Sprite this is a ghost of, null for real sprites
+	bool _wrapsAround = false;							// Set once the sprite wraps, it's then drawn on both sides of an edge
+
+	mutable unsigned int _nPackedPoints = 0;			// Number of real points in the packed arrays
+	mutable float _packedPointsX[PACKED_CAPACITY];		// x of the next frame points, padded with the first point
+	mutable float _packedPointsY[PACKED_CAPACITY];		// y of the next frame points, padded with the first point
+
+	std::vector<sf::Vector2f> _localNormals;			// Unit edge normals of the shape in local space
+	const SharedShape* _sharedShape = nullptr;			// Outline shared with other sprites, its normals are used instead of _localNormals if set
+	mutable float _rotationSin = 0.0f;					// Sine of the rotation used for the next frame points
+	mutable float _rotationCos = 1.0f;					// Cosine of the rotation used for the next frame points
+	mutable bool _pointsDirty = true;					// Set when the sprite moves, the points are rebuilt the next time they're read
 };
 
@@ -4,10 +4,7 @@
 #include "../../Global/ApplicationDefines.h"
 #include "../../GameControl/Backend/SpatialPartitioning/UniformGrid.h"
 #include <ctime>
-#include "../../GameControl/Common/ResourceManager.h"
-
-// Contains the different radius sizes
-std::map<Asteroid::Size, int> Asteroid::_radi = { { Asteroid::Size::LARGE, 55 }, { Asteroid::Size::MEDIUM, 32 }, { Asteroid::Size::SMALL, 20 } };
+#include "AsteroidMeshLibrary.h"
 
 
 /* Constructor
@@ -22,25 +19,15 @@ std::map<Asteroid::Size, int> Asteroid::_radi = { { Asteroid::Size::LARGE, 55 },
 */
 Asteroid::Asteroid(unsigned int arrayIndex, Size size, sf::Vector2f pos, sf::Vector2f velocity)
 	:
-	WireframeSprite(ASTEROID_VERTS),
+	WireframeSprite(ASTEROID_VERTS, CollisionCategory::ASTEROID,
+		CollisionCategoryBit(CollisionCategory::PLAYER) | CollisionCategoryBit(CollisionCategory::ASTEROID) | CollisionCategoryBit(CollisionCategory::BULLET)),
 	_size((Asteroid::Size)size),
 	_indexInGameObjectArray(arrayIndex)
 {
-	// if custom asteroid start size is given set it
-	if (ResourceManager::getInstance()._commandLineArgs.size() > 0)
-	{
-		std::map<Asteroid::Size, int>::iterator it = _radi.find(Asteroid::Size::LARGE);
-		if (it != _radi.end())
-			it->second = std::stoi(ResourceManager::getInstance()._commandLineArgs[1]);
-	}
-
-	// Setup basic properties
-	this->_shape.setFillColor(sf::Color::Transparent);
-	this->_shape.setOutlineColor(ASTEROID_COLOR);
-	this->_shape.setOutlineThickness(ASTEROID_THICKNESS);
+	// Setup basic properties, the outline's style is set by the mesh library
 	this->hitboxShape.setOutlineColor(sf::Color::Green);
 
-	// Generates random points around a circle to form asteroid
+	// Picks one of the shared meshes to form asteroid
 	this->BuildShape();
 
 	// Check if asteroid is a new spawn or a split
@@ -65,48 +52,60 @@ Asteroid::~Asteroid()
 /*void Update override
  * Brief:
  * Overrides WireframeSprite::Update(). Updates the asteroid's rotation and wraps the object
- * around the screen if needed.
+ * around the screen if needed. If the asteroid is in an entity store the store has
+ * already moved it, so its transform is read back from there.
 */
 void Asteroid::Update()
 {
-	// Update asteroid rotation
-	this->RotateMesh(ROTATION_SPEED);
+	if (this->GetStore())
+	{
+		// Store has integrated and wrapped the asteroid already
+		this->SyncFromStore();
+	}
+	else
+	{
+		// Update asteroid rotation
+		this->RotateMesh(ROTATION_SPEED);
 
-	// Call to base update for position update
-	WireframeSprite::Update();
+		// Call to base update for position update
+		WireframeSprite::Update();
 
-	// Wrap asteroids to screen
-	this->WrapCoordinates();
+		// Wrap asteroids to screen
+		this->WrapCoordinates();
+	}
 
 	// Reset colour, will be changed if they're colliding with other asteroids
-	this->_shape.setOutlineColor(ASTEROID_COLOR);
+	this->_color = ASTEROID_COLOR;
 }
 
-/* void BuildShape
+/* void DrawShape override
  * Brief:
- * Generates verticies around a circle given a selected radius. Angle between verticies have a minimum
- * and maximum value. After generation of verticies, convex shape is created.
+ * Overrides WireframeSprite::DrawShape(). Draws the mesh library's outline of the asteroid's
+ * mesh with the asteroid's transform and colour instead of a shape of its own.
+ * Params:
+ * <renderwindow*> window - window to draw the outline to
+ * <const sf::Transform&> offset - transform applied on top of the asteroid's own
 */
-void Asteroid::BuildShape()
+void Asteroid::DrawShape(sf::RenderWindow* window, const sf::Transform& offset)
 {
-	std::vector<float> points;
+	sf::ConvexShape& outline = AsteroidMeshLibrary::getInstance().GetOutline(this->_size, this->_meshIndex);
 
-	// Randomly generate points for the new asteroid's shape then sort
-	for (int i = 0; i < ASTEROID_VERTS; i++)
-	{
-		points.push_back(static_cast<float>((double)rand() * 2 * M_PI / ((double)RAND_MAX + 1)));
-	}
-	std::sort(points.begin(), points.end());
+	// the outline is shared, only rewrite its colour when it was last drawn in another
+	if (outline.getOutlineColor() != this->_color)
+		outline.setOutlineColor(this->_color);
 
-	// Generate the coordinates for the new asteroid's shape
-	for (int i = 0; i < ASTEROID_VERTS; i++)
-	{
-		sf::Vector2f point = { sf::Vector2f(_radi[_size] * sin(points.at(i)),
-			_radi[_size] * cos(points.at(i))) };
+	window->draw(outline, offset * this->_shape.getTransform());
+}
 
-		this->_shape.setPoint(i, point);
-		this->_pointsNextFrame.push_back(point);
-	}
+/* void BuildShape
+ * Brief:
+ * Picks a random mesh of the asteroid's size from the shared mesh library and keeps its index.
+ * The mesh's points, normals, bounds and outline are shared rather than copied.
+*/
+void Asteroid::BuildShape()
+{
+	this->_meshIndex = static_cast<unsigned int>(rand()) % AsteroidMeshLibrary::MESHES_PER_SIZE;
+	this->ShareShape(AsteroidMeshLibrary::getInstance().GetMesh(this->_size, this->_meshIndex));
 }
 
 /* void GenerateRandomVariables
@@ -10,6 +10,10 @@ public:
 		MEDIUM,
 		SMALL
 	};
+
+	static const int ASTEROID_VERTS = 11;				// Number of verticies on the asteroid
+	static constexpr float ROTATION_SPEED = 1.0f;		// Speed of asteroid spin
+	static constexpr float ASTEROID_THICKNESS = 1;		// Thickness of the asteroid outline
 public:
 	/* Constructor
 	 * Brief:
@@ -32,6 +36,8 @@ public:
 	void Update() override;
 
 	Size GetSize() const { return this->_size; } // Getter for the asteroid size
+	unsigned int GetMeshIndex() const { return this->_meshIndex; }	// Getter for the index of the asteroid's mesh in the mesh library
+	void SetColour(sf::Color color) { this->_color = color; }		// Setter for the outline colour, reset every update
 	unsigned int GetObjectContainerIndex() const { return this->_indexInGameObjectArray; }	// getter for object index
 	void UpdateObjectContainerIndex(unsigned int index) { this->_indexInGameObjectArray = index; }
 
@@ -40,11 +46,22 @@ public:
 	void MarkForSplitting() { this->_shouldBeSplitNextFrame = true; }
 
 
+protected:
+	/* void DrawShape override
+	 * Brief:
+	 * Overrides WireframeSprite::DrawShape(). Draws the mesh library's outline of the asteroid's
+	 * mesh with the asteroid's transform and colour instead of a shape of its own.
+	 * Params:
+	 * <renderwindow*> window - window to draw the outline to
+	 * <const sf::Transform&> offset - transform applied on top of the asteroid's own
+	*/
+	void DrawShape(sf::RenderWindow* window, const sf::Transform& offset) override;
+
 private:
 	/* void BuildShape
 	 * Brief:
-	 * Generates verticies around a circle given a selected radius. Angle between verticies have a minimum
-	 * and maximum value. After generation of verticies, convex shape is created.
+	 * Picks a random mesh of the asteroid's size from the shared mesh library and keeps its index.
+	 * The mesh's points, normals, bounds and outline are shared rather than copied.
 	*/
 	void BuildShape();
 
@@ -69,10 +86,7 @@ private:
 
 private:
 	// Constants
-	static constexpr float ROTATION_SPEED = 1.0f;		// Speed of asteroid spin
-	static const int ASTEROID_VERTS = 11;				// Number of verticies on the asteroid
 	sf::Color ASTEROID_COLOR = sf::Color::Red;			// color of the asteroid
-	static constexpr float ASTEROID_THICKNESS = 1;		// Thickness of the asteroid outline
 	static constexpr double MINIMUM_VERT_ANGLE = 0.1;	// Minimum angle between verticies (radians)
 	static constexpr float MAXIMUM_SPEED = 2.0f;		// Maximum spawn speed		// Minimum spawn speed
 
@@ -81,7 +95,8 @@ private:
 														// This is a performance enhancement to cut back searches
 
 	// Member Variables
-	static std::map<Size, int> _radi;					// Contains the different radius sizes
 	Size _size;											// Size of the asteroid
+	unsigned int _meshIndex = 0;						// Index of the asteroid's mesh among the meshes of its size
+	sf::Color _color = ASTEROID_COLOR;					// Colour the outline is drawn in this frame
 };
 
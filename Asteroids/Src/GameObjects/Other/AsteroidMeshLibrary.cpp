@@ -0,0 +1,84 @@
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <algorithm>
+#include "AsteroidMeshLibrary.h"
+#include "../../GameControl/Common/ResourceManager.h"
+
+/* Constructor
+ * Brief:
+ *	Generates every mesh of every size. The large radius can be overridden
+ *	on the command line.
+ */
+AsteroidMeshLibrary::AsteroidMeshLibrary()
+{
+	// if custom asteroid start size is given set it
+	if (ResourceManager::getInstance()._commandLineArgs.size() > 0)
+		this->_radii[static_cast<unsigned int>(Asteroid::Size::LARGE)] = static_cast<float>(std::stoi(ResourceManager::getInstance()._commandLineArgs[1]));
+
+	for (unsigned int size = 0; size < SIZE_COUNT; size++)
+	{
+		this->_meshes[size].resize(MESHES_PER_SIZE);
+		this->_outlines[size].resize(MESHES_PER_SIZE);
+		for (unsigned int i = 0; i < MESHES_PER_SIZE; i++)
+			this->BuildMesh(this->_radii[size], this->_meshes[size][i], this->_outlines[size][i]);
+	}
+}
+
+/* void BuildMesh
+ * Brief:
+ *	Generates verticies around a circle given a selected radius. Angle between verticies are
+ *	random, after generation the normals, bounds and outline are worked out.
+ * Params:
+ *	<float>				radius	-	radius of the circle the points are placed on
+ *	<SharedShape&>		mesh	-	mesh to fill
+ *	<sf::ConvexShape&>	outline	-	outline shape to build from the mesh
+ */
+void AsteroidMeshLibrary::BuildMesh(float radius, SharedShape& mesh, sf::ConvexShape& outline)
+{
+	std::vector<float> angles;
+
+	// Randomly generate angles for the points then sort
+	for (int i = 0; i < Asteroid::ASTEROID_VERTS; i++)
+	{
+		angles.push_back(static_cast<float>((double)rand() * 2 * M_PI / ((double)RAND_MAX + 1)));
+	}
+	std::sort(angles.begin(), angles.end());
+
+	// Generate the coordinates of the points
+	mesh.points.resize(Asteroid::ASTEROID_VERTS);
+	for (int i = 0; i < Asteroid::ASTEROID_VERTS; i++)
+		mesh.points[i] = sf::Vector2f(radius * sin(angles[i]), radius * cos(angles[i]));
+
+	// same winding and normal as WireframeSprite::CacheLocalNormals, (-dy, dx)
+	mesh.normals.resize(Asteroid::ASTEROID_VERTS);
+	for (unsigned int a = 0; a < mesh.points.size(); a++)
+	{
+		unsigned int b = (a + 1) % mesh.points.size();
+		sf::Vector2f edge = mesh.points[b] - mesh.points[a];
+
+		float length = std::sqrt(edge.x * edge.x + edge.y * edge.y);
+		mesh.normals[a] = { -edge.y / length, edge.x / length };
+	}
+
+	// bounds of the outline in local space
+	sf::Vector2f min = mesh.points[0];
+	sf::Vector2f max = mesh.points[0];
+	mesh.boundingRadius = 0.0f;
+	for (unsigned int i = 0; i < mesh.points.size(); i++)
+	{
+		const sf::Vector2f& point = mesh.points[i];
+		min.x = std::min(min.x, point.x);
+		min.y = std::min(min.y, point.y);
+		max.x = std::max(max.x, point.x);
+		max.y = std::max(max.y, point.y);
+		mesh.boundingRadius = std::max(mesh.boundingRadius, std::sqrt(point.x * point.x + point.y * point.y));
+	}
+	mesh.localBounds = sf::FloatRect(min, max - min);
+
+	// outline in local space, the asteroid's transform places it when drawn
+	outline.setPointCount(mesh.points.size());
+	for (unsigned int i = 0; i < mesh.points.size(); i++)
+		outline.setPoint(i, mesh.points[i]);
+	outline.setFillColor(sf::Color::Transparent);
+	outline.setOutlineThickness(Asteroid::ASTEROID_THICKNESS);
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include "SFML/Graphics.hpp"
+#include "Asteroid.h"
+
+/* Class AsteroidMeshLibrary
+*  (Singleton)
+ * Brief:
+ *	Generates a fixed set of random outlines for each asteroid size once, on first
+ *	use, so spawning an asteroid only has to pick one instead of building its own.
+ *	The meshes never change after they're generated so asteroids share theirs
+ *	through WireframeSprite::ShareShape rather than keeping a copy. Each mesh also
+ *	has one outline shape that every asteroid using it is drawn through.
+ */
+class AsteroidMeshLibrary
+{
+public:
+	// Method to get the static instance of the mesh library
+	// after first creation the same instance will always be returned.
+	static AsteroidMeshLibrary& getInstance()
+	{
+		static AsteroidMeshLibrary instance;	// Instantiated on first use.
+		return instance;
+	}
+
+	// delete copy constructor and assignment operator to prevent
+	// accidental instance creation
+	AsteroidMeshLibrary(AsteroidMeshLibrary const&) = delete;
+	void operator=(AsteroidMeshLibrary const&) = delete;
+
+	// Returns a mesh of the given size, the index wraps around the meshes of that size
+	const SharedShape& GetMesh(Asteroid::Size size, unsigned int index) const
+	{
+		return this->_meshes[static_cast<unsigned int>(size)][index % MESHES_PER_SIZE];
+	}
+
+	// Returns the drawable outline of a mesh, asteroids set its colour and pass their own transform when drawing it
+	sf::ConvexShape& GetOutline(Asteroid::Size size, unsigned int index)
+	{
+		return this->_outlines[static_cast<unsigned int>(size)][index % MESHES_PER_SIZE];
+	}
+
+	static constexpr unsigned int MESHES_PER_SIZE = 16;	// Number of outlines generated for each size
+
+private:
+	/* Constructor
+	 * Brief:
+	 *	Generates every mesh of every size. The large radius can be overridden
+	 *	on the command line.
+	 */
+	AsteroidMeshLibrary();
+
+	/* void BuildMesh
+	 * Brief:
+	 *	Generates verticies around a circle given a selected radius. Angle between verticies are
+	 *	random, after generation the normals, bounds and outline are worked out.
+	 * Params:
+	 *	<float>				radius	-	radius of the circle the points are placed on
+	 *	<SharedShape&>		mesh	-	mesh to fill
+	 *	<sf::ConvexShape&>	outline	-	outline shape to build from the mesh
+	 */
+	void BuildMesh(float radius, SharedShape& mesh, sf::ConvexShape& outline);
+
+private:
+	static constexpr unsigned int SIZE_COUNT = 3;		// Number of asteroid sizes
+
+	std::vector<SharedShape> _meshes[SIZE_COUNT];		// Meshes of each size, indexed by Asteroid::Size
+	std::vector<sf::ConvexShape> _outlines[SIZE_COUNT];	// Outline drawn for each mesh, indexed like _meshes
+	float _radii[SIZE_COUNT] = { 55.0f, 32.0f, 20.0f };	// Radius of each size, indexed by Asteroid::Size
+};
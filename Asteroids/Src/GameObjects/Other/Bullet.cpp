@@ -5,7 +5,7 @@
 
 Bullet::Bullet(sf::Vector2f playerPosition, float playerRotation)
 	:
-	WireframeSprite(3)
+	WireframeSprite(BULLET_VERTS, CollisionCategory::BULLET, CollisionCategoryBit(CollisionCategory::ASTEROID))
 {
 	this->_shape.setRotation(playerRotation);
 
@@ -27,6 +27,31 @@ Bullet::Bullet(sf::Vector2f playerPosition, float playerRotation)
 	this->_velocity.x = BULLET_SPEED * sin(playerRotation);
 }
 
+/* void Fire
+ * Brief:
+ *	Resets a pooled bullet as if it was newly created at the given position
+ *	and rotation. The bullet gets a new id so it's not mistaken for the old one.
+ * Params:
+ *	<Vector2f>	playerPosition	-	position to fire from
+ *	<float>		playerRotation	-	rotation in degrees to fire along
+ */
+void Bullet::Fire(sf::Vector2f playerPosition, float playerRotation)
+{
+	this->RenewId();
+	this->_isVisible = true;
+	this->_shape.setRotation(playerRotation);
+
+	// convert degrees to radians
+	playerRotation = static_cast<float>((playerRotation * M_PI) / 180);
+
+	this->_position = playerPosition;
+	this->_velocity.y = -BULLET_SPEED * cos(playerRotation);
+	this->_velocity.x = BULLET_SPEED * sin(playerRotation);
+
+	// move the shape now so the structures it's added to see it where it's fired from
+	this->UpdateShape();
+}
+
 Bullet::~Bullet()
 {
 
@@ -55,6 +80,8 @@ void Bullet::CalculateStartingVertecies()
 	this->_pointsNextFrame.push_back(pointOne);
 	this->_pointsNextFrame.push_back(pointTwo);
 	this->_pointsNextFrame.push_back(pointThree);
+	this->PackPoints();
+	this->CacheLocalNormals();
 }
 
 void Bullet::CleanupUnseenBullets()
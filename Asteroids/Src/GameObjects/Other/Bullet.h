@@ -7,12 +7,27 @@ public:
 	Bullet(sf::Vector2f playerPosition = {0, 0}, float playerRotation = 0.0f);
 	~Bullet();
 
+	static const int BULLET_VERTS = 3;					// Number of verticies on the bullet
+
 
 	bool IsVisible() const { return this->_isVisible; }
 
 	void Update() override;
 	void Disable() { this->_isVisible = false; }
 
+	unsigned int GetLiveIndex() const { return this->_liveIndex; }			// Getter for the index in the bullet pool's live list
+	void SetLiveIndex(unsigned int index) { this->_liveIndex = index; }		// Setter to update the index in the bullet pool's live list
+
+	/* void Fire
+	 * Brief:
+	 *	Resets a pooled bullet as if it was newly created at the given position
+	 *	and rotation. The bullet gets a new id so it's not mistaken for the old one.
+	 * Params:
+	 *	<Vector2f>	playerPosition	-	position to fire from
+	 *	<float>		playerRotation	-	rotation in degrees to fire along
+	 */
+	void Fire(sf::Vector2f playerPosition, float playerRotation);
+
 private:
 	void CalculateStartingVertecies();
 	void CleanupUnseenBullets();
@@ -20,6 +35,7 @@ private:
 private:
 
 	bool _isVisible = true;
+	unsigned int _liveIndex = 0;	// index in the bullet pool's live list, so releasing doesn't have to search it
 	static constexpr float BULLET_SPEED = 5.0f;
 	sf::Color BULLET_COLOR = sf::Color::Yellow;
 	static constexpr float TRIANGLE_SCALE = 10.0f;
@@ -0,0 +1,122 @@
+#include "BulletPool.h"
+#include <algorithm>
+
+/* Constructor
+ * Brief:
+ *	Creates every bullet the pool will ever hand out
+ * Params:
+ *	<unsigned int>	capacity	-	number of bullets, at most MAX_CAPACITY
+ */
+BulletPool::BulletPool(unsigned int capacity)
+{
+	if (capacity > MAX_CAPACITY)
+		throw std::exception("bullet pool capacity is too large for a handle!");
+
+	this->_bullets.resize(capacity);
+	this->_generations.assign(capacity, 1);
+	this->_live.reserve(capacity);
+	this->_dead.reserve(capacity);
+
+	// pushed in reverse so the first slots are handed out first
+	this->_freeSlots.reserve(capacity);
+	for (unsigned int i = capacity; i > 0; i--)
+		this->_freeSlots.push_back(i - 1);
+}
+
+BulletPool::~BulletPool(){}
+
+/* Bullet* Spawn
+ * Brief:
+ *	Takes a slot off the free list and fires its bullet
+ * Params:
+ *	<Vector2f>	position	-	position to fire from
+ *	<float>		rotation	-	rotation in degrees to fire along
+ * Returns:
+ *	<Bullet*>	-	the fired bullet, null if every bullet is in use
+ */
+Bullet* BulletPool::Spawn(sf::Vector2f position, float rotation)
+{
+	if (this->_freeSlots.empty())
+		return nullptr;
+
+	unsigned int slot = this->_freeSlots.back();
+	this->_freeSlots.pop_back();
+
+	Bullet* bullet = &this->_bullets[slot];
+	bullet->Fire(position, rotation);
+
+	bullet->SetLiveIndex(static_cast<unsigned int>(this->_live.size()));
+	this->_live.push_back(bullet);
+
+	return bullet;
+}
+
+/* const vector<WireframeSprite*>& CollectDead
+ * Brief:
+ *	Finds every live bullet that's no longer visible. The list is sorted by
+ *	address so the structures can remove the whole batch in one pass. The
+ *	bullets stay live until ReleaseDead is called.
+ * Returns:
+ *	<const vector<WireframeSprite*>&>	-	the dead bullets
+ */
+const std::vector<WireframeSprite*>& BulletPool::CollectDead()
+{
+	this->_dead.clear();
+
+	for (unsigned int i = 0; i < this->_live.size(); i++)
+	{
+		if (!this->_live[i]->IsVisible())
+			this->_dead.push_back(this->_live[i]);
+	}
+
+	std::sort(this->_dead.begin(), this->_dead.end());
+	return this->_dead;
+}
+
+/* void ReleaseDead
+ * Brief:
+ *	Swap removes the bullets found by the last CollectDead from the live list
+ *	and puts their slots back on the free list, invalidating their handles.
+ *	They must have been removed from every structure first.
+ */
+void BulletPool::ReleaseDead()
+{
+	for (unsigned int i = 0; i < this->_dead.size(); i++)
+	{
+		Bullet* bullet = static_cast<Bullet*>(this->_dead[i]);
+		unsigned int slot = this->SlotOf(bullet);
+		unsigned int index = bullet->GetLiveIndex();
+
+		// move the last live bullet into the gap
+		this->_live[index] = this->_live.back();
+		this->_live[index]->SetLiveIndex(index);
+		this->_live.pop_back();
+
+		// a generation of 0 would let the null handle resolve, skip it on wrap around
+		if (++this->_generations[slot] == 0)
+			this->_generations[slot] = 1;
+
+		this->_freeSlots.push_back(slot);
+	}
+
+	this->_dead.clear();
+}
+
+// Returns the handle of a live bullet
+BulletPool::Handle BulletPool::GetHandle(const Bullet* bullet) const
+{
+	unsigned int slot = this->SlotOf(bullet);
+	return (static_cast<Handle>(this->_generations[slot]) << SLOT_BITS) | slot;
+}
+
+// Returns the bullet a handle refers to, null if it has been released since
+Bullet* BulletPool::Get(Handle handle) const
+{
+	unsigned int slot = handle & MAX_CAPACITY;
+	uint16_t generation = static_cast<uint16_t>(handle >> SLOT_BITS);
+
+	if (slot >= this->_bullets.size() || this->_generations[slot] != generation)
+		return nullptr;
+
+	return const_cast<Bullet*>(&this->_bullets[slot]);
+}
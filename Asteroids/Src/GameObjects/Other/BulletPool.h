@@ -0,0 +1,87 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "Bullet.h"
+
+/* class BulletPool
+ *	Fixed number of bullets allocated once and reused, so firing and removing
+ *	bullets never touches the allocator. Free slots are kept on a free list.
+ *	Live bullets are also kept in a packed list that the game and the collision
+ *	handler iterate, dead ones are swap removed from it.
+ *	A bullet can be referred to by a 32 bit handle made of its slot and the
+ *	slot's generation. The generation changes every time the slot is freed, so
+ *	a handle to a bullet that's gone never resolves to the bullet reusing its slot.
+*/
+class BulletPool
+{
+public:
+	typedef uint32_t Handle;
+
+	static constexpr Handle NULL_HANDLE = 0;		// handle that never resolves to a bullet
+
+	// Public interface
+public:
+	/* Constructor
+	 * Brief:
+	 *	Creates every bullet the pool will ever hand out
+	 * Params:
+	 *	<unsigned int>	capacity	-	number of bullets, at most MAX_CAPACITY
+	 */
+	BulletPool(unsigned int capacity);
+	~BulletPool();
+
+	/* Bullet* Spawn
+	 * Brief:
+	 *	Takes a slot off the free list and fires its bullet
+	 * Params:
+	 *	<Vector2f>	position	-	position to fire from
+	 *	<float>		rotation	-	rotation in degrees to fire along
+	 * Returns:
+	 *	<Bullet*>	-	the fired bullet, null if every bullet is in use
+	 */
+	Bullet* Spawn(sf::Vector2f position, float rotation);
+
+	/* const vector<WireframeSprite*>& CollectDead
+	 * Brief:
+	 *	Finds every live bullet that's no longer visible. The list is sorted by
+	 *	address so the structures can remove the whole batch in one pass. The
+	 *	bullets stay live until ReleaseDead is called.
+	 * Returns:
+	 *	<const vector<WireframeSprite*>&>	-	the dead bullets
+	 */
+	const std::vector<WireframeSprite*>& CollectDead();
+
+	/* void ReleaseDead
+	 * Brief:
+	 *	Swap removes the bullets found by the last CollectDead from the live list
+	 *	and puts their slots back on the free list, invalidating their handles.
+	 *	They must have been removed from every structure first.
+	 */
+	void ReleaseDead();
+
+	// Returns the handle of a live bullet
+	Handle GetHandle(const Bullet* bullet) const;
+
+	// Returns the bullet a handle refers to, null if it has been released since
+	Bullet* Get(Handle handle) const;
+
+	std::vector<Bullet*>& GetLive() { return this->_live; }				// Getter for the packed list of live bullets
+	unsigned int GetCapacity() const { return static_cast<unsigned int>(this->_bullets.size()); }	// Getter for the number of bullets in the pool
+
+	// Private methods for internal use
+private:
+	// Returns the slot of a bullet from its address
+	unsigned int SlotOf(const Bullet* bullet) const { return static_cast<unsigned int>(bullet - this->_bullets.data()); }
+
+	// Members
+private:
+	std::vector<Bullet> _bullets;				// every bullet, never resized so addresses stay put
+	std::vector<uint16_t> _generations;			// generation of each slot, bumped when the slot is freed
+	std::vector<unsigned int> _freeSlots;		// slots not in use, used as a stack
+	std::vector<Bullet*> _live;					// bullets in use, packed
+	std::vector<WireframeSprite*> _dead;		// bullets found by the last CollectDead
+
+	// constants
+	static constexpr unsigned int SLOT_BITS = 16;			// low bits of a handle holding the slot
+	static constexpr unsigned int MAX_CAPACITY = 0xFFFF;	// most slots a handle can address
+};
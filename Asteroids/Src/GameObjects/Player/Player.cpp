@@ -6,7 +6,7 @@
 
 Player::Player()
 	:
-	WireframeSprite(3)
+	WireframeSprite(PLAYER_VERTS, CollisionCategory::PLAYER, CollisionCategoryBit(CollisionCategory::ASTEROID))
 {
 	this->CalculateStartingVertecies();
 	this->_shape.setFillColor(sf::Color::Transparent);
@@ -52,6 +52,8 @@ void Player::CalculateStartingVertecies()
 	this->_pointsNextFrame.push_back(pointOne);
 	this->_pointsNextFrame.push_back(pointTwo);
 	this->_pointsNextFrame.push_back(pointThree);
+	this->PackPoints();
+	this->CacheLocalNormals();
 }
 
 /*void HandleInput
@@ -10,6 +10,8 @@ public:
 	Player();
 	~Player();
 
+	static const int PLAYER_VERTS = 3;					// Number of verticies on the player
+
 	/*void Update override
 	 * Brief:
 	 * Overrides WireframeSprite::Update(). Updates the Players rotation and wraps the object